@@ -4,6 +4,14 @@
 #include "ABCTree.h"
 #include "Alembic/Abc/IObject.h"
 #include "zeno/ListObject.h"
+#include <condition_variable>
+#include <tuple>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <list>
+#include <map>
+#include <set>
 
 namespace zeno {
 class TimeAndSamplesMap {
@@ -38,7 +46,137 @@ extern void traverseABC(
     bool outOfRangeAsEmpty
 );
 
-extern Alembic::AbcGeom::IArchive readABC(std::string const &path);
+// numStreams > 1 lets that many threads read an Ogawa archive at once
+extern Alembic::AbcGeom::IArchive readABC(std::string const &path, size_t numStreams = 1);
+
+// walks the object hierarchy of an archive once when opened, then reads frames of it
+// without traversing it again: only objects whose paths pass the filter (and their
+// parents) make it into the tree, geometry is decoded in parallel on Ogawa archives,
+// and meshes of constant topology take their faces over from the last frame read
+class ABCReader {
+public:
+    explicit ABCReader(std::string const &path);
+
+    std::shared_ptr<ABCTree> read(int frameid, bool read_face_set, bool outOfRangeAsEmpty, std::string const &filter);
+
+    // Ogawa archives may be read by several readers at once, HDF5 ones only one at a time
+    bool isOgawa() const {
+        return m_parallel;
+    }
+
+    // first and last frame holding samples of uniform or cyclic time, equal if there are none
+    std::pair<int, int> frameRange() const {
+        return {m_startFrame, m_endFrame};
+    }
+
+private:
+    enum class Kind {
+        Other,
+        Mesh,
+        Xform,
+        Camera,
+        Points,
+        Curves,
+        SubD,
+    };
+
+    struct Node {
+        Alembic::AbcGeom::IObject obj;
+        std::string path;
+        Kind kind = Kind::Other;
+        bool hasVisible = false;
+        int parent = -1;
+        std::vector<int> children;
+        std::shared_ptr<PrimitiveObject> topology;  // faces of the mesh last read anew, without verts
+    };
+
+    struct Job {
+        int node;
+        ABCTree *tree;
+    };
+
+    Alembic::AbcGeom::IArchive m_archive;
+    TimeAndSamplesMap m_timeMap;
+    std::vector<Node> m_nodes;  // parents before their children, the top object first
+    int m_startFrame = 0;
+    int m_endFrame = 0;
+    bool m_parallel = false;
+    bool m_readDone = false;
+    bool m_readFaceSet = false;
+
+    std::string m_filter;
+    std::vector<char> m_matched;   // path or a parent path passes the filter
+    std::vector<char> m_included;  // matched, or parent of a matched object
+
+    void addNode(Alembic::AbcGeom::IObject obj, std::string const &parentPath, int parent);
+    void setFilter(std::string const &filter);
+    void walk(int i, ABCTree &tree, int frameid, ObjectVisibility parent_visible, std::vector<Job> &jobs);
+    void readPrim(Job const &job, int frameid, bool outOfRangeAsEmpty);
+};
+
+// decoded frames of one archive, shared by all nodes reading it: the frames last asked
+// for are kept within ZENO_ABC_CACHE_MB megabytes, and on Ogawa archives the next
+// ZENO_ABC_PREFETCH frames in playback direction are decoded after each read, on a thread
+// and with a reader of their own, so that a read of the current frame never waits behind them
+class ABCFrameCache {
+public:
+    struct Options {
+        bool read_face_set = false;
+        bool outOfRangeAsEmpty = false;
+        std::string filter;
+    };
+
+    // the cache of the archive, opened again when the file changed on disk
+    static std::shared_ptr<ABCFrameCache> get(std::string const &path);
+
+    explicit ABCFrameCache(std::string const &path);
+    ~ABCFrameCache();
+
+    // a tree of its own, free to be modified, sharing the attribute arrays with the cache
+    std::shared_ptr<ABCTree> read(int frameid, Options const &opts);
+
+private:
+    struct Key {
+        int frameid;
+        bool read_face_set;
+        bool outOfRangeAsEmpty;
+        std::string filter;
+
+        bool operator<(Key const &that) const {
+            return std::tie(frameid, read_face_set, outOfRangeAsEmpty, filter)
+                 < std::tie(that.frameid, that.read_face_set, that.outOfRangeAsEmpty, that.filter);
+        }
+    };
+
+    struct Frame {
+        std::shared_ptr<ABCTree const> tree;
+        size_t bytes = 0;
+        std::list<Key>::iterator lru;
+    };
+
+    std::string m_path;
+    std::mutex m_readerMtx;  // the reader decodes one frame at a time
+    ABCReader m_reader;
+    std::unique_ptr<ABCReader> m_prefetchReader;  // Ogawa only, used by prefetchMain, opened by the first one
+    std::pair<int, int> m_range;
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::map<Key, Frame> m_frames;
+    std::list<Key> m_lru;  // most recently used first
+    std::set<Key> m_decoding;
+    std::deque<Key> m_prefetch;
+    std::thread m_prefetchThread;
+    bool m_stopping = false;
+    size_t m_bytes = 0;
+    size_t m_maxBytes;
+    int m_numPrefetch;
+    int m_lastFrame = 0;
+
+    std::shared_ptr<ABCTree const> fetch(Key const &key);
+    void insert(Key const &key, std::shared_ptr<ABCTree const> tree, size_t bytes);
+    void prefetchMain();
+};
 
 extern std::shared_ptr<zeno::ListObject> get_xformed_prims(std::shared_ptr<zeno::ABCTree> abctree);
 
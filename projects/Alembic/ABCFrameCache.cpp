@@ -0,0 +1,203 @@
+#include "ABCCommon.h"
+#include <zeno/funcs/ObjectMemory.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/logger.h>
+#include <unordered_set>
+#include <filesystem>
+#include <algorithm>
+
+namespace zeno {
+
+namespace {
+
+struct CacheEntry {
+    std::weak_ptr<ABCFrameCache> cache;
+    std::filesystem::file_time_type mtime;
+};
+
+std::mutex g_cachesMtx;
+std::map<std::string, CacheEntry> g_caches;
+
+// the prims are copies of their own, sharing the attribute arrays until written to
+std::shared_ptr<ABCTree> copyTree(ABCTree const &tree) {
+    auto res = std::make_shared<ABCTree>(tree);
+    if (tree.prim) {
+        res->prim = std::make_shared<PrimitiveObject>(*tree.prim);
+    }
+    if (tree.camera_info) {
+        res->camera_info = std::make_shared<CameraInfo>(*tree.camera_info);
+    }
+    for (auto &child: res->children) {
+        child = copyTree(*child);
+    }
+    return res;
+}
+
+// faces shared with the neighbouring frames are counted in each of them, erring on the
+// side of evicting early
+size_t treeBytes(ABCTree const &tree) {
+    std::unordered_set<void const *> visited;
+    size_t bytes = 0;
+    tree.visitPrims([&] (auto const &p) {
+        bytes += objectMemoryBytes(p.get(), visited);
+    });
+    return bytes;
+}
+
+}
+
+std::shared_ptr<ABCFrameCache> ABCFrameCache::get(std::string const &path) {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(std::filesystem::u8path(path), ec);
+    std::lock_guard lck(g_cachesMtx);
+    for (auto it = g_caches.begin(); it != g_caches.end();) {
+        if (it->second.cache.expired() && it->first != path) {
+            it = g_caches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto &entry = g_caches[path];
+    auto cache = entry.cache.lock();
+    if (!cache || entry.mtime != mtime) {
+        if (cache) {
+            log_info("[alembic] {} changed on disk, reading it again", path);
+        }
+        cache = std::make_shared<ABCFrameCache>(path);
+        entry.cache = cache;
+        entry.mtime = mtime;
+    }
+    return cache;
+}
+
+ABCFrameCache::ABCFrameCache(std::string const &path)
+    : m_path(path)
+    , m_reader(path)
+    , m_range(m_reader.frameRange())
+    , m_maxBytes(size_t(std::max(envconfig::getInt("ABC_CACHE_MB", 1024), 0)) << 20)
+    , m_numPrefetch(std::max(envconfig::getInt("ABC_PREFETCH", 4), 0)) {
+    // nowhere to keep them, or HDF5, whose single reader a prefetch would hold while the
+    // frame being asked for waits
+    if (!m_maxBytes || !m_reader.isOgawa()) {
+        m_numPrefetch = 0;
+    }
+}
+
+ABCFrameCache::~ABCFrameCache() {
+    {
+        std::lock_guard lck(m_mtx);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    if (m_prefetchThread.joinable()) {
+        m_prefetchThread.join();  // after the frame being decoded, if any
+    }
+}
+
+std::shared_ptr<ABCTree> ABCFrameCache::read(int frameid, Options const &opts) {
+    Key key{frameid, opts.read_face_set, opts.outOfRangeAsEmpty, opts.filter};
+    auto tree = fetch(key);
+    {
+        std::lock_guard lck(m_mtx);
+        int step = frameid < m_lastFrame ? -1 : 1;
+        m_lastFrame = frameid;
+        // what was queued for the previous frame is behind us now, or still queued below
+        m_prefetch.clear();
+        for (int i = 1; i <= m_numPrefetch; i++) {
+            Key next = key;
+            next.frameid = frameid + step * i;
+            if (next.frameid < m_range.first || next.frameid > m_range.second) {
+                break;
+            }
+            if (!m_frames.count(next) && !m_decoding.count(next)) {
+                m_prefetch.push_back(std::move(next));
+            }
+        }
+        if (!m_prefetch.empty()) {
+            if (!m_prefetchThread.joinable()) {
+                m_prefetchThread = std::thread([this] { prefetchMain(); });
+            }
+            m_cv.notify_all();
+        }
+    }
+    return copyTree(*tree);
+}
+
+std::shared_ptr<ABCTree const> ABCFrameCache::fetch(Key const &key) {
+    std::unique_lock lck(m_mtx);
+    // rather wait for a prefetch already decoding this frame than decode it twice
+    m_cv.wait(lck, [&] { return !m_decoding.count(key); });
+    if (auto it = m_frames.find(key); it != m_frames.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        return it->second.tree;
+    }
+    m_decoding.insert(key);
+    lck.unlock();
+    std::shared_ptr<ABCTree const> tree;
+    try {
+        std::lock_guard readerLck(m_readerMtx);
+        tree = m_reader.read(key.frameid, key.read_face_set, key.outOfRangeAsEmpty, key.filter);
+    } catch (...) {
+        lck.lock();
+        m_decoding.erase(key);
+        m_cv.notify_all();
+        throw;
+    }
+    size_t bytes = treeBytes(*tree);
+    lck.lock();
+    m_decoding.erase(key);
+    insert(key, tree, bytes);
+    m_cv.notify_all();
+    return tree;
+}
+
+// caller holds m_mtx
+void ABCFrameCache::insert(Key const &key, std::shared_ptr<ABCTree const> tree, size_t bytes) {
+    m_lru.push_front(key);
+    m_frames[key] = Frame{std::move(tree), bytes, m_lru.begin()};
+    m_bytes += bytes;
+    // the frame just read stays, even alone above the budget
+    while (m_bytes > m_maxBytes && m_lru.size() > 1) {
+        auto it = m_frames.find(m_lru.back());
+        m_bytes -= it->second.bytes;
+        m_frames.erase(it);
+        m_lru.pop_back();
+    }
+}
+
+// on a thread of its own, not the thread pool, whose workers the graph is waiting for
+void ABCFrameCache::prefetchMain() {
+    std::unique_lock lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [&] { return m_stopping || !m_prefetch.empty(); });
+        if (m_stopping) {
+            return;
+        }
+        Key key = std::move(m_prefetch.front());
+        m_prefetch.pop_front();
+        if (m_frames.count(key) || m_decoding.count(key)) {
+            continue;
+        }
+        m_decoding.insert(key);
+        lck.unlock();
+        std::shared_ptr<ABCTree const> tree;
+        size_t bytes = 0;
+        try {
+            if (!m_prefetchReader) {
+                m_prefetchReader = std::make_unique<ABCReader>(m_path);
+            }
+            tree = m_prefetchReader->read(key.frameid, key.read_face_set, key.outOfRangeAsEmpty, key.filter);
+            bytes = treeBytes(*tree);
+        } catch (std::exception const &e) {
+            log_warn("[alembic] prefetching frame {} failed: {}", key.frameid, e.what());
+        }
+        lck.lock();
+        m_decoding.erase(key);
+        if (tree) {
+            insert(key, std::move(tree), bytes);
+        }
+        m_cv.notify_all();
+    }
+}
+
+}
@@ -21,7 +21,10 @@
 #include <filesystem>
 #include <zeno/utils/string.h>
 #include <zeno/utils/scope_exit.h>
+#include <zeno/extra/ThreadPool.h>
+#include <zeno/para/parallel_for.h>
 #include <numeric>
+#include <utility>
 
 #ifdef ZENO_WITH_PYTHON3
     #include <Python.h>
@@ -581,8 +584,13 @@ static std::shared_ptr<PrimitiveObject> foundABCMesh(
         , bool read_face_set
         , bool outOfRangeAsEmpty
         , std::string abc_name
+        , std::shared_ptr<PrimitiveObject> const &topology = nullptr
+        , bool *topology_reused = nullptr
 ) {
     auto prim = std::make_shared<PrimitiveObject>();
+    if (topology_reused) {
+        *topology_reused = false;
+    }
 
     std::shared_ptr<Alembic::AbcCoreAbstract::v12::TimeSampling> time = mesh.getTimeSampling();
     float time_per_cycle =  time->getTimeSamplingType().getTimePerCycle();
@@ -595,9 +603,32 @@ static std::shared_ptr<PrimitiveObject> foundABCMesh(
         return prim;
     }
     ISampleSelector iSS = Alembic::Abc::v12::ISampleSelector((Alembic::AbcCoreAbstract::index_t)sample_index);
-    Alembic::AbcGeom::IPolyMeshSchema::Sample mesamp = mesh.getValue(iSS);
 
-    if (auto marr = mesamp.getPositions()) {
+    // faces, uvs and face sets of an earlier frame of this mesh stay valid while the
+    // schema says its topology doesn't change, then only the per vertex data is read
+    bool reuse_topology = topology && !topology->polys.empty()
+        && mesh.getTopologyVariance() != kHeterogenousTopology
+        && (!mesh.getUVsParam() || mesh.getUVsParam().isConstant());
+    P3fArraySamplePtr positions;
+    V3fArraySamplePtr velocities;
+    Alembic::AbcGeom::IPolyMeshSchema::Sample mesamp;
+    if (reuse_topology) {
+        // the topology holds no verts, copying it shares its face arrays, they aren't read again
+        *prim = *topology;
+        if (topology_reused) {
+            *topology_reused = true;
+        }
+        positions = mesh.getPositionsProperty().getValue(iSS);
+        if (mesh.getVelocitiesProperty().valid()) {
+            velocities = mesh.getVelocitiesProperty().getValue(iSS);
+        }
+    } else {
+        mesamp = mesh.getValue(iSS);
+        positions = mesamp.getPositions();
+        velocities = mesamp.getVelocities();
+    }
+
+    if (auto marr = positions) {
         if (!read_done) {
             log_debug("[alembic] totally {} positions", marr->size());
         }
@@ -608,7 +639,7 @@ static std::shared_ptr<PrimitiveObject> foundABCMesh(
         }
     }
 
-    read_velocity(prim, mesamp.getVelocities(), read_done);
+    read_velocity(prim, velocities, read_done);
     if (auto nrm = mesh.getNormalsParam()) {
         auto nrmsamp =
                 nrm.getIndexedValue(Alembic::Abc::v12::ISampleSelector((Alembic::AbcCoreAbstract::index_t)sample_index));
@@ -623,83 +654,84 @@ static std::shared_ptr<PrimitiveObject> foundABCMesh(
         }
     }
 
-    if (auto marr = mesamp.getFaceIndices()) {
-        if (!read_done) {
-            log_debug("[alembic] totally {} face indices", marr->size());
-        }
-        auto &parr = prim->loops;
-        for (size_t i = 0; i < marr->size(); i++) {
-            int ind = (*marr)[i];
-            parr.push_back(ind);
+    bool is_point = !reuse_topology;
+    if (!reuse_topology) {
+        if (auto marr = mesamp.getFaceIndices()) {
+            if (!read_done) {
+                log_debug("[alembic] totally {} face indices", marr->size());
+            }
+            auto &parr = prim->loops;
+            for (size_t i = 0; i < marr->size(); i++) {
+                int ind = (*marr)[i];
+                parr.push_back(ind);
+            }
         }
-    }
-
-    bool is_point = true;
 
-    if (auto marr = mesamp.getFaceCounts()) {
-        if (!read_done) {
-            log_debug("[alembic] totally {} faces", marr->size());
-        }
-        auto &loops = prim->loops;
-        auto &parr = prim->polys;
-        int base = 0;
-        for (size_t i = 0; i < marr->size(); i++) {
-            int cnt = (*marr)[i];
-            parr.emplace_back(base, cnt);
-            base += cnt;
-            if (cnt != 1) {
-                is_point = false;
+        if (auto marr = mesamp.getFaceCounts()) {
+            if (!read_done) {
+                log_debug("[alembic] totally {} faces", marr->size());
+            }
+            auto &loops = prim->loops;
+            auto &parr = prim->polys;
+            int base = 0;
+            for (size_t i = 0; i < marr->size(); i++) {
+                int cnt = (*marr)[i];
+                parr.emplace_back(base, cnt);
+                base += cnt;
+                if (cnt != 1) {
+                    is_point = false;
+                }
             }
         }
-    }
-    if (auto uv = mesh.getUVsParam()) {
-        auto uvsamp =
-            uv.getIndexedValue(Alembic::Abc::v12::ISampleSelector((Alembic::AbcCoreAbstract::index_t)sample_index));
-        int value_size = (int)uvsamp.getVals()->size();
-        int index_size = (int)uvsamp.getIndices()->size();
-        if (!read_done) {
-            log_debug("[alembic] totally {} uv value", value_size);
-            log_debug("[alembic] totally {} uv indices", index_size);
+        if (auto uv = mesh.getUVsParam()) {
+            auto uvsamp =
+                uv.getIndexedValue(Alembic::Abc::v12::ISampleSelector((Alembic::AbcCoreAbstract::index_t)sample_index));
+            int value_size = (int)uvsamp.getVals()->size();
+            int index_size = (int)uvsamp.getIndices()->size();
+            if (!read_done) {
+                log_debug("[alembic] totally {} uv value", value_size);
+                log_debug("[alembic] totally {} uv indices", index_size);
+                if (prim->loops.size() == index_size) {
+                    log_debug("[alembic] uv per face");
+                } else if (prim->verts.size() == index_size) {
+                    log_debug("[alembic] uv per vertex");
+                } else {
+                    log_error("[alembic] error uv indices");
+                }
+            }
+            prim->uvs.resize(value_size);
+            {
+                auto marr = uvsamp.getVals();
+                for (size_t i = 0; i < marr->size(); i++) {
+                    auto const &val = (*marr)[i];
+                    prim->uvs[i] = {val[0], val[1]};
+                }
+            }
             if (prim->loops.size() == index_size) {
-                log_debug("[alembic] uv per face");
-            } else if (prim->verts.size() == index_size) {
-                log_debug("[alembic] uv per vertex");
-            } else {
-                log_error("[alembic] error uv indices");
+                prim->loops.add_attr<int>("uvs");
+                for (auto i = 0; i < prim->loops.size(); i++) {
+                    prim->loops.attr<int>("uvs")[i] = (*uvsamp.getIndices())[i];
+                }
             }
-        }
-        prim->uvs.resize(value_size);
-        {
-            auto marr = uvsamp.getVals();
-            for (size_t i = 0; i < marr->size(); i++) {
-                auto const &val = (*marr)[i];
-                prim->uvs[i] = {val[0], val[1]};
+            else if (prim->verts.size() == index_size) {
+                prim->loops.add_attr<int>("uvs");
+                for (auto i = 0; i < prim->loops.size(); i++) {
+                    prim->loops.attr<int>("uvs")[i] = prim->loops[i];
+                }
             }
         }
-        if (prim->loops.size() == index_size) {
-            prim->loops.add_attr<int>("uvs");
-            for (auto i = 0; i < prim->loops.size(); i++) {
-                prim->loops.attr<int>("uvs")[i] = (*uvsamp.getIndices())[i];
+        if (!prim->loops.has_attr("uvs")) {
+            if (!read_done) {
+                log_warn("[alembic] Not found uv, auto fill zero.");
             }
-        }
-        else if (prim->verts.size() == index_size) {
+            prim->uvs.resize(1);
+            prim->uvs[0] = zeno::vec2f(0, 0);
             prim->loops.add_attr<int>("uvs");
             for (auto i = 0; i < prim->loops.size(); i++) {
-                prim->loops.attr<int>("uvs")[i] = prim->loops[i];
+                prim->loops.attr<int>("uvs")[i] = 0;
             }
         }
     }
-    if (!prim->loops.has_attr("uvs")) {
-        if (!read_done) {
-            log_warn("[alembic] Not found uv, auto fill zero.");
-        }
-        prim->uvs.resize(1);
-        prim->uvs[0] = zeno::vec2f(0, 0);
-        prim->loops.add_attr<int>("uvs");
-        for (auto i = 0; i < prim->loops.size(); i++) {
-            prim->loops.attr<int>("uvs")[i] = 0;
-        }
-    }
     ICompoundProperty arbattrs = mesh.getArbGeomParams();
     read_attributes2(prim, arbattrs, iSS, read_done);
     ICompoundProperty usrData = mesh.getUserProperties();
@@ -711,7 +743,7 @@ static std::shared_ptr<PrimitiveObject> foundABCMesh(
         return prim;
     }
 
-    if (read_face_set) {
+    if (read_face_set && !reuse_topology) {
         auto &faceset = prim->polys.add_attr<int>("faceset");
         std::fill(faceset.begin(), faceset.end(), -1);
         auto &ud = prim->userData();
@@ -1121,34 +1153,282 @@ void traverseABC(
     }
 }
 
-Alembic::AbcGeom::IArchive readABC(std::string const &path) {
+static std::string read_abc_header(std::string const &native_path, std::string const &path) {
+    char buf[5];
+    std::memset(buf, 0, 5);
+    auto fp = std::fopen(native_path.c_str(), "rb");
+    if (!fp)
+        throw Exception("[alembic] cannot open file for read: " + path);
+    std::fread(buf, 4, 1, fp);
+    std::fclose(fp);
+    return buf;
+}
+
+Alembic::AbcGeom::IArchive readABC(std::string const &path, size_t numStreams) {
     std::string native_path = std::filesystem::u8path(path).string();
-    std::string hdr;
-    {
-        char buf[5];
-        std::memset(buf, 0, 5);
-        auto fp = std::fopen(native_path.c_str(), "rb");
-        if (!fp)
-            throw Exception("[alembic] cannot open file for read: " + path);
-        std::fread(buf, 4, 1, fp);
-        std::fclose(fp);
-        hdr = buf;
-    }
+    std::string hdr = read_abc_header(native_path, path);
     if (hdr == "\x89HDF") {
         log_info("[alembic] opening as HDF5 format");
         return {Alembic::AbcCoreHDF5::ReadArchive(), native_path};
     } else if (hdr == "Ogaw") {
         log_info("[alembic] opening as Ogawa format");
-        return {Alembic::AbcCoreOgawa::ReadArchive(), native_path};
+        return {Alembic::AbcCoreOgawa::ReadArchive(std::max<size_t>(numStreams, 1)), native_path};
     } else {
         throw Exception("[alembic] unrecognized ABC header: [" + hdr + "]");
     }
 }
 
+// '*' matches any run of characters including '/', '?' any single one
+static bool abc_path_glob(char const *pat, char const *str) {
+    char const *star = nullptr, *resume = nullptr;
+    while (*str) {
+        if (*pat == '?' || *pat == *str) {
+            pat++;
+            str++;
+        } else if (*pat == '*') {
+            star = pat++;
+            resume = str;
+        } else if (star) {
+            pat = star + 1;
+            str = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pat == '*')
+        pat++;
+    return !*pat;
+}
+
+ABCReader::ABCReader(std::string const &path) {
+    std::string native_path = std::filesystem::u8path(path).string();
+    // HDF5 archives must not be read from more than one thread
+    m_parallel = read_abc_header(native_path, path) == "Ogaw";
+    m_archive = readABC(path, m_parallel ? getThreadPool().numThreads() : 1);
+    Alembic::Util::uint32_t numSamplings = m_archive.getNumTimeSamplings();
+    bool hasRange = false;
+    for (Alembic::Util::uint32_t s = 0; s < numSamplings; ++s) {
+        auto time = m_archive.getTimeSampling(s);
+        auto numSamples = m_archive.getMaxNumSamplesForTimeSamplingIndex(s);
+        m_timeMap.add(time, numSamples);
+        // frames are counted the way the found* functions do, from the first stored time
+        if (time->getTimeSamplingType().isAcyclic() || time->getStoredTimes().empty()
+            || numSamples == 0 || numSamples == Alembic::AbcCoreAbstract::INDEX_UNKNOWN) {
+            continue;
+        }
+        double time_per_cycle = time->getTimeSamplingType().getTimePerCycle();
+        int start_frame = std::lround(time->getStoredTimes().front() / time_per_cycle);
+        int end_frame = start_frame + int(numSamples) - 1;
+        m_startFrame = hasRange ? std::min(m_startFrame, start_frame) : start_frame;
+        m_endFrame = hasRange ? std::max(m_endFrame, end_frame) : end_frame;
+        hasRange = true;
+    }
+    addNode(m_archive.getTop(), "", -1);
+    log_debug("[alembic] {} objects in [{}]", m_nodes.size(), path);
+}
+
+void ABCReader::addNode(Alembic::AbcGeom::IObject obj, std::string const &parentPath, int parent) {
+    int index = (int)m_nodes.size();
+    Node node;
+    auto const &md = obj.getMetaData();
+    if (Alembic::AbcGeom::IPolyMesh::matches(md)) {
+        node.kind = Kind::Mesh;
+    } else if (Alembic::AbcGeom::IXformSchema::matches(md)) {
+        node.kind = Kind::Xform;
+    } else if (Alembic::AbcGeom::ICameraSchema::matches(md)) {
+        node.kind = Kind::Camera;
+    } else if (Alembic::AbcGeom::IPointsSchema::matches(md)) {
+        node.kind = Kind::Points;
+    } else if (Alembic::AbcGeom::ICurvesSchema::matches(md)) {
+        node.kind = Kind::Curves;
+    } else if (Alembic::AbcGeom::ISubDSchema::matches(md)) {
+        node.kind = Kind::SubD;
+    }
+    node.path = zeno::format("{}/{}", parentPath, obj.getName());
+    node.hasVisible = obj.getProperties().getPropertyHeader("visible") != nullptr;
+    node.parent = parent;
+    node.obj = obj;
+    std::string path = node.path;
+    m_nodes.push_back(std::move(node));
+    if (parent >= 0) {
+        m_nodes[parent].children.push_back(index);
+    }
+    size_t nch = obj.getNumChildren();
+    for (size_t i = 0; i < nch; i++) {
+        addNode(Alembic::AbcGeom::IObject(obj, obj.getChildHeader(i).getName()), path, index);
+    }
+}
+
+void ABCReader::setFilter(std::string const &filter) {
+    if (!m_matched.empty() && filter == m_filter) {
+        return;
+    }
+    m_filter = filter;
+    auto patterns = split_str(filter, {' ', ',', ';', '\n'});
+    size_t n = m_nodes.size();
+    m_matched.assign(n, patterns.empty());
+    m_included.assign(n, patterns.empty());
+    if (patterns.empty()) {
+        return;
+    }
+    // parents come first, so a matched object passes the match on to everything below it
+    for (size_t i = 0; i < n; i++) {
+        auto const &node = m_nodes[i];
+        m_matched[i] = node.parent >= 0 && m_matched[node.parent];
+        for (auto const &pat: patterns) {
+            if (m_matched[i])
+                break;
+            m_matched[i] = abc_path_glob(pat.c_str(), node.path.c_str());
+        }
+    }
+    for (size_t i = n; i-- > 0;) {
+        if (m_matched[i] || m_included[i]) {
+            m_included[i] = true;
+            if (m_nodes[i].parent >= 0)
+                m_included[m_nodes[i].parent] = true;
+        }
+    }
+}
+
+void ABCReader::walk(int i, ABCTree &tree, int frameid, ObjectVisibility parent_visible, std::vector<Job> &jobs) {
+    auto &node = m_nodes[i];
+    auto &obj = node.obj;
+    tree.name = obj.getName();
+    tree.visible = parent_visible;
+    if (node.hasVisible) {
+        auto visible_prop = obj.getProperties().getPropertyHeader("visible");
+        size_t totalSamples = 0;
+        TimeSamplingPtr timePtr =
+                m_timeMap.get(visible_prop->getTimeSampling(), totalSamples);
+        float time_per_cycle = visible_prop->getTimeSampling()->getTimeSamplingType().getTimePerCycle();
+        double start = visible_prop->getTimeSampling()->getStoredTimes().front();
+        int start_frame = std::lround(start / time_per_cycle );
+
+        int sample_index = clamp(frameid - start_frame, 0, (int)totalSamples - 1);
+        ISampleSelector iSS = Alembic::Abc::v12::ISampleSelector((Alembic::AbcCoreAbstract::index_t)sample_index);
+        auto visible = read_visible_attr(obj.getProperties(), iSS);
+        if (visible != -1) {
+            tree.visible = visible;
+        }
+    }
+
+    switch (node.kind) {
+    case Kind::Xform: {
+        Alembic::AbcGeom::IXform xfm(obj);
+        auto &xfm_sch = xfm.getSchema();
+        tree.xform = foundABCXform(xfm_sch, frameid);
+        break;
+    }
+    case Kind::Camera:
+        if (m_matched[i]) {
+            Alembic::AbcGeom::ICamera cam(obj);
+            auto &cam_sch = cam.getSchema();
+            tree.camera_info = foundABCCamera(cam_sch, frameid);
+        }
+        break;
+    case Kind::Other:
+        break;
+    default:
+        if (m_matched[i]) {
+            jobs.push_back({i, &tree});
+        }
+        break;
+    }
+
+    for (int c: node.children) {
+        if (!m_included[c]) {
+            continue;
+        }
+        auto childTree = std::make_shared<ABCTree>();
+        walk(c, *childTree, frameid, tree.visible, jobs);
+        tree.children.push_back(std::move(childTree));
+    }
+}
+
+void ABCReader::readPrim(Job const &job, int frameid, bool outOfRangeAsEmpty) {
+    auto &node = m_nodes[job.node];
+    auto &tree = *job.tree;
+    bool topologyReused = false;
+    switch (node.kind) {
+    case Kind::Mesh: {
+        Alembic::AbcGeom::IPolyMesh meshy(node.obj);
+        auto &mesh = meshy.getSchema();
+        tree.prim = foundABCMesh(mesh, frameid, m_readDone, m_readFaceSet, outOfRangeAsEmpty, tree.name, node.topology, &topologyReused);
+        break;
+    }
+    case Kind::Points: {
+        Alembic::AbcGeom::IPoints points(node.obj);
+        auto &points_sch = points.getSchema();
+        tree.prim = foundABCPoints(points_sch, frameid, m_readDone, outOfRangeAsEmpty);
+        break;
+    }
+    case Kind::Curves: {
+        Alembic::AbcGeom::ICurves curves(node.obj);
+        auto &curves_sch = curves.getSchema();
+        tree.prim = foundABCCurves(curves_sch, frameid, m_readDone, outOfRangeAsEmpty);
+        break;
+    }
+    case Kind::SubD: {
+        Alembic::AbcGeom::ISubD subd(node.obj);
+        auto &subd_sch = subd.getSchema();
+        tree.prim = foundABCSubd(subd_sch, frameid, m_readDone, m_readFaceSet, outOfRangeAsEmpty);
+        break;
+    }
+    default:
+        return;
+    }
+    tree.prim->userData().set2("_abc_name", tree.name);
+    if (!topologyReused) {  // else the topology came with the path already
+        prim_set_abcpath(tree.prim.get(), node.path);
+    }
+    if (node.kind == Kind::Points || node.kind == Kind::Curves) {
+        tree.prim->userData().set2("faceset_count", 0);
+    }
+    if (node.kind == Kind::Mesh && !topologyReused) {
+        // the faces just read, sharing their arrays with the output until either is written to
+        auto topology = std::make_shared<PrimitiveObject>(*tree.prim);
+        topology->verts = AttrVector<vec3f>();
+        node.topology = std::move(topology);
+    }
+    tree.prim->userData().set2("vis", tree.visible);
+    if (tree.visible == 0) {
+        for (auto i = 0; i < tree.prim->verts.size(); i++) {
+            tree.prim->verts[i] = {};
+        }
+    }
+}
+
+std::shared_ptr<ABCTree> ABCReader::read(int frameid, bool read_face_set, bool outOfRangeAsEmpty, std::string const &filter) {
+    if (read_face_set != m_readFaceSet) {
+        for (auto &node: m_nodes) {
+            node.topology = nullptr;
+        }
+        m_readFaceSet = read_face_set;
+    }
+    setFilter(filter);
+
+    auto abctree = std::make_shared<ABCTree>();
+    std::vector<Job> jobs;
+    // the hierarchy, transforms and cameras are cheap, geometry is decoded afterwards
+    walk(0, *abctree, frameid, ObjectVisibility::kVisibilityDeferred, jobs);
+    if (!m_readDone) {
+        log_debug("[alembic] reading {} of {} objects", jobs.size(), m_nodes.size());
+    }
+    if (m_parallel) {
+        parallel_for(jobs.size(), [&] (size_t j) {
+            readPrim(jobs[j], frameid, outOfRangeAsEmpty);
+        });
+    } else {
+        for (auto const &job: jobs) {
+            readPrim(job, frameid, outOfRangeAsEmpty);
+        }
+    }
+    m_readDone = true;
+    return abctree;
+}
+
 struct ReadAlembic : INode {
-    Alembic::Abc::v12::IArchive archive;
-    std::string usedPath;
-    bool read_done = false;
+    std::shared_ptr<ABCFrameCache> cache;
     virtual void apply() override {
         int frameid;
         if (has_input("frameid")) {
@@ -1156,32 +1436,15 @@ struct ReadAlembic : INode {
         } else {
             frameid = getGlobalState()->frameid;
         }
-        auto abctree = std::make_shared<ABCTree>();
+        std::shared_ptr<ABCTree> abctree;
         {
             auto path = get_input<StringObject>("path")->get();
-            if (usedPath != path) {
-                read_done = false;
-            }
-            if (read_done == false) {
-                archive = readABC(path);
-            }
-            double start, _end;
-            GetArchiveStartAndEndTime(archive, start, _end);
-            // fmt::print("GetArchiveStartAndEndTime: {}\n", start);
-            // fmt::print("archive.getNumTimeSamplings: {}\n", archive.getNumTimeSamplings());
-            auto obj = archive.getTop();
-            bool read_face_set = get_input2<bool>("read_face_set");
-            bool outOfRangeAsEmpty = get_input2<bool>("outOfRangeAsEmpty");
-            Alembic::Util::uint32_t numSamplings = archive.getNumTimeSamplings();
-            TimeAndSamplesMap timeMap;
-            for (Alembic::Util::uint32_t s = 0; s < numSamplings; ++s)             {
-                timeMap.add(archive.getTimeSampling(s),
-                            archive.getMaxNumSamplesForTimeSamplingIndex(s));
-            }
-
-            traverseABC(obj, *abctree, frameid, read_done, read_face_set, "", timeMap, ObjectVisibility::kVisibilityDeferred, outOfRangeAsEmpty);
-            read_done = true;
-            usedPath = path;
+            cache = ABCFrameCache::get(path);
+            ABCFrameCache::Options opts;
+            opts.read_face_set = get_input2<bool>("read_face_set");
+            opts.outOfRangeAsEmpty = get_input2<bool>("outOfRangeAsEmpty");
+            opts.filter = get_input2<std::string>("path_filter");
+            abctree = cache->read(frameid, opts);
         }
         {
             auto namelist = std::make_shared<zeno::ListObject>();
@@ -1208,6 +1471,7 @@ ZENDEFNODE(ReadAlembic, {
         {"bool", "read_face_set", "1"},
         {"bool", "outOfRangeAsEmpty", "0"},
         {"frameid"},
+        {"string", "path_filter", ""},
     },
     {
         {"ABCTree", "abctree"},
@@ -1244,7 +1508,8 @@ std::shared_ptr<ListObject> abc_split_by_name(std::shared_ptr<PrimitiveObject> p
             }
             new_prim->polys.foreach_attr<AttrAcceptAll>([&](auto const &key, auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
-                auto &attr = prim->polys.attr<T>(key);
+                // only read, and shared with new_prim, mutable access would copy it
+                auto const &attr = std::as_const(prim->polys).attr<T>(key);
                 for (auto i = 0; i < arr.size(); i++) {
                     arr[i] = attr[faceset_map[f][i]];
                 }
@@ -1271,7 +1536,8 @@ std::shared_ptr<ListObject> abc_split_by_name(std::shared_ptr<PrimitiveObject> p
             }
             new_prim->tris.foreach_attr<AttrAcceptAll>([&](auto const &key, auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
-                auto &attr = prim->tris.attr<T>(key);
+                // only read, and shared with new_prim, mutable access would copy it
+                auto const &attr = std::as_const(prim->tris).attr<T>(key);
                 for (auto i = 0; i < arr.size(); i++) {
                     arr[i] = attr[faceset_map[f][i]];
                 }
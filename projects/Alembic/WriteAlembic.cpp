@@ -46,6 +46,16 @@ static void write_normal(std::shared_ptr<PrimitiveObject> prim, OPolyMeshSchema:
 struct WriteAlembic : INode {
     OArchive archive;
     OPolyMesh meshyObj;
+
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        meshyObj = OPolyMesh();
+        archive = OArchive();
+    }
+
     virtual void apply() override {
         bool flipFrontBack = get_param<int>("flipFrontBack");
         int frameid;
@@ -557,6 +567,14 @@ struct WriteAlembic2 : INode {
     std::map<int, vec3i> prim_size_per_frame;
     int real_frame_start = -1;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        usedPath.clear();  // the next frame starts a new archive
+    }
+
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
         bool flipFrontBack = get_input2<int>("flipFrontBack");
@@ -715,6 +733,14 @@ struct WriteAlembicPrims : INode {
     std::map<std::string, std::map<int, vec3i>> prim_size_per_frame;
     int real_frame_start = -1;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        usedPath.clear();  // the next frame starts a new archive
+    }
+
     virtual void apply() override {
         std::vector<std::shared_ptr<PrimitiveObject>> prims;
 
@@ -0,0 +1,151 @@
+// Reads every frame of an archive with ABCReader, which ReadAlembic goes through, and
+// with traverseABC, which walks the whole archive, and checks that the trees are the same.
+// The archive is the one given on the command line, or a sample written by WriteAlembic2.
+
+#include <zeno/zeno.h>
+#include <zeno/core/Graph.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/utils/string.h>
+#include "ABCCommon.h"
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+using namespace zeno;
+
+namespace {
+
+template <class T>
+bool sameElements(std::vector<T> const &a, std::vector<T> const &b) {
+    return a.size() == b.size() && (a.empty() || !std::memcmp(a.data(), b.data(), a.size() * sizeof(T)));
+}
+
+template <class T>
+void compareAttrs(AttrVector<T> const &a, AttrVector<T> const &b, std::string const &what, size_t &numDiffs) {
+    if (!sameElements(a.values.get(), b.values.get())) {
+        fprintf(stderr, "%s: %zu vs %zu elements, or other values\n", what.c_str(), a.size(), b.size());
+        numDiffs++;
+    }
+    auto keysA = a.template attr_keys<AttrAcceptAll>();
+    auto keysB = b.template attr_keys<AttrAcceptAll>();
+    std::sort(keysA.begin(), keysA.end());
+    std::sort(keysB.begin(), keysB.end());
+    if (keysA != keysB) {
+        fprintf(stderr, "%s: attributes [%s] vs [%s]\n", what.c_str(),
+                join_str(keysA, ", ").c_str(), join_str(keysB, ", ").c_str());
+        numDiffs++;
+        return;
+    }
+    for (auto const &key: keysA) {
+        bool same = std::visit([&] (auto const &arrA) {
+            using V = std::decay_t<decltype(arrA)>;
+            auto const &varB = b.attr(key);
+            return std::holds_alternative<V>(varB) && sameElements(arrA.get(), std::get<V>(varB).get());
+        }, a.attr(key));
+        if (!same) {
+            fprintf(stderr, "%s: attribute %s differs\n", what.c_str(), key.c_str());
+            numDiffs++;
+        }
+    }
+}
+
+// expected from traverseABC, actual from ABCReader
+void compareTrees(ABCTree const &expected, ABCTree const &actual, std::string const &parentPath, size_t &numDiffs) {
+    auto path = parentPath + "/" + expected.name;
+    if (expected.name != actual.name || expected.visible != actual.visible
+        || expected.xform != actual.xform || !expected.camera_info != !actual.camera_info
+        || !expected.prim != !actual.prim || expected.children.size() != actual.children.size()) {
+        fprintf(stderr, "%s: name, visibility, transform, camera, prim or number of children differs\n", path.c_str());
+        numDiffs++;
+        return;
+    }
+    if (auto const &a = expected.prim, &b = actual.prim; a) {
+        compareAttrs(a->verts, b->verts, path + " verts", numDiffs);
+        compareAttrs(a->points, b->points, path + " points", numDiffs);
+        compareAttrs(a->lines, b->lines, path + " lines", numDiffs);
+        compareAttrs(a->tris, b->tris, path + " tris", numDiffs);
+        compareAttrs(a->quads, b->quads, path + " quads", numDiffs);
+        compareAttrs(a->loops, b->loops, path + " loops", numDiffs);
+        compareAttrs(a->polys, b->polys, path + " polys", numDiffs);
+        compareAttrs(a->uvs, b->uvs, path + " uvs", numDiffs);
+    }
+    for (size_t i = 0; i < expected.children.size(); i++) {
+        compareTrees(*expected.children[i], *actual.children[i], path, numDiffs);
+    }
+}
+
+// a quad and a triangle moving along x, with a point and a face attribute
+std::shared_ptr<PrimitiveObject> samplePrim(int frame) {
+    auto prim = std::make_shared<PrimitiveObject>();
+    prim->verts.resize(5);
+    auto &pos = prim->verts.values.mut();
+    auto &clr = prim->verts.add_attr<vec3f>("clr");
+    for (int i = 0; i < 5; i++) {
+        pos[i] = vec3f(i % 3 + frame * 0.5f, i / 3, 0);
+        clr[i] = vec3f(i * 0.25f, frame, 1);
+    }
+    prim->loops.values.mut() = {0, 1, 4, 3, 1, 2, 4};
+    prim->polys.values.mut() = {{0, 4}, {4, 3}};
+    prim->polys.add_attr<float>("w") = {float(frame), 1.0f};
+    return prim;
+}
+
+std::string writeSample(int frameStart, int frameEnd) {
+    auto path = (std::filesystem::temp_directory_path() / "test_ABCReader.abc").string();
+    // the archive is written out as the graph, and the node with it, goes away
+    auto graph = getSession().createGraph();
+    graph->addNode("WriteAlembic2", "write");
+    graph->setNodeInput("write", "path", std::make_shared<StringObject>(path));
+    graph->setNodeInput("write", "frame_start", std::make_shared<NumericObject>(frameStart));
+    graph->setNodeInput("write", "frame_end", std::make_shared<NumericObject>(frameEnd));
+    graph->setNodeInput("write", "fps", std::make_shared<NumericObject>(25.0f));
+    graph->setNodeInput("write", "flipFrontBack", std::make_shared<NumericObject>(0));
+    graph->completeNode("write");
+    for (int frame = frameStart; frame <= frameEnd; frame++) {
+        graph->setNodeInput("write", "prim", samplePrim(frame));
+        graph->setNodeInput("write", "frameid", std::make_shared<NumericObject>(frame));
+        graph->applyNodes({"write"});
+    }
+    return path;
+}
+
+}
+
+int main(int argc, char **argv) {
+    std::string path = argc > 1 ? argv[1] : writeSample(0, 2);
+    ABCReader reader(path);
+    auto [frameStart, frameEnd] = reader.frameRange();
+
+    auto archive = readABC(path);
+    TimeAndSamplesMap timeMap;
+    Alembic::Util::uint32_t numSamplings = archive.getNumTimeSamplings();
+    for (Alembic::Util::uint32_t s = 0; s < numSamplings; ++s) {
+        timeMap.add(archive.getTimeSampling(s), archive.getMaxNumSamplesForTimeSamplingIndex(s));
+    }
+
+    size_t numDiffs = 0;
+    for (int frame = frameStart; frame <= frameEnd; frame++) {
+        for (bool read_face_set: {false, true}) {
+            auto actual = reader.read(frame, read_face_set, false, "");
+            auto obj = archive.getTop();
+            ABCTree expected;
+            traverseABC(obj, expected, frame, true, read_face_set, "", timeMap,
+                        ObjectVisibility::kVisibilityDeferred, false);
+            size_t frameDiffs = 0;
+            compareTrees(expected, *actual, "", frameDiffs);
+            if (frameDiffs) {
+                fprintf(stderr, "frame %d%s: %zu differences\n", frame, read_face_set ? " with face sets" : "", frameDiffs);
+            }
+            numDiffs += frameDiffs;
+        }
+    }
+    if (numDiffs) {
+        fprintf(stderr, "test_ABCReader: ABCReader differs from traverseABC in %zu places in [%s]\n", numDiffs, path.c_str());
+        return 1;
+    }
+    printf("test_ABCReader: ok, frames %d to %d of [%s]\n", frameStart, frameEnd, path.c_str());
+    return 0;
+}
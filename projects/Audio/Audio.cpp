@@ -167,6 +167,15 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
 
     struct AudioBeats : zeno::INode {
         std::deque<double> H;
+
+        virtual bool isFrameIndependent() const override {
+            return false;
+        }
+
+        virtual void resetFrameState() override {
+            H.clear();
+        }
+
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
             float threshold = get_input<NumericObject>("threshold")->get<float>();
@@ -258,6 +267,17 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
         double minE = std::numeric_limits<double>::max();
         double maxE = std::numeric_limits<double>::min();
         std::vector<double> init;
+
+        virtual bool isFrameIndependent() const override {
+            return false;
+        }
+
+        virtual void resetFrameState() override {
+            minE = std::numeric_limits<double>::max();
+            maxE = std::numeric_limits<double>::min();
+            init.clear();
+        }
+
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
             int duration_count = 1024;
@@ -74,6 +74,14 @@ namespace {
     struct AudioPowerVariation : zeno::INode {
         std::deque<float> hist;
 
+        virtual bool isFrameIndependent() const override {
+            return false;
+        }
+
+        virtual void resetFrameState() override {
+            hist.clear();
+        }
+
         virtual void apply() override {
             auto sumpower = get_input2<float>("sumpower");
             int maxhist = get_input2<int>("winwidth");
@@ -986,7 +986,7 @@ struct PrimitiveFuse : INode {
                                     auto &loopUV = loops.attr<int>("uvs");
                                     loopUV[loopI] = loopI;
                                     auto &uvs = prim->uvs.values;
-                                    const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
+                                    const auto &srcVertUV = std::get<CowVector<vec3f>>(vertArr);
                                     auto vertUV = srcVertUV[ptNo];
                                     uvs[loopI] = vec2f(vertUV[0], vertUV[1]);
                                 }
@@ -1251,7 +1251,7 @@ struct PrimitiveFuse2 : INode {
                                 // auto &lps = loops;
                                 if (k == "uv") {
                                     if (!uv_exist) {
-                                        const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
+                                        const auto &srcVertUV = std::get<CowVector<vec3f>>(vertArr);
                                         auto vertUV = srcVertUV[ptNo];
                                         uvs.values[uvNo] = vec2f(vertUV[0], vertUV[1]);
                                     } else {
@@ -1751,7 +1751,7 @@ struct PrimitiveFuse : INode {
                                         auto &loopUV = loops.attr<int>("uvs");
                                         loopUV[loopI] = loopI;
                                         auto &uvs = prim->uvs.values;
-                                        const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
+                                        const auto &srcVertUV = std::get<CowVector<vec3f>>(vertArr);
                                         auto vertUV = srcVertUV[ptNo];
                                         uvs[loopI] = vec2f(vertUV[0], vertUV[1]);
                                     }
@@ -1776,7 +1776,7 @@ struct PrimitiveFuse : INode {
                                     auto &loopUV = loops.attr<int>("uvs");
                                     loopUV[loopI] = loopI;
                                     auto &uvs = prim->uvs.values;
-                                    const auto &srcVertUV = std::get<std::vector<vec3f>>(vertArr);
+                                    const auto &srcVertUV = std::get<CowVector<vec3f>>(vertArr);
                                     auto vertUV = srcVertUV[ptNo];
                                     uvs[loopI] = vec2f(vertUV[0], vertUV[1]);
                                 }
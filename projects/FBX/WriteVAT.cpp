@@ -315,6 +315,15 @@ static vector<vector<vec3f>> read_vat(const std::string &path) {
 
 struct WriteCustomVAT : INode {
     std::vector<std::shared_ptr<PrimitiveObject>> prims;
+
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        prims.clear();
+    }
+
     virtual void apply() override {
         int frameid;
         if (has_input("frameid")) {
@@ -5,6 +5,7 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "../ZenoFX/LinearBvh.h"
+#include <utility>
 
 namespace zeno {
 
@@ -690,7 +691,8 @@ struct ExtractSurfaceMeshByTag : zeno::INode {
         primSurf->tris.clear();
         primSurf->quads.clear();
 
-        const auto& surf_tag = vprim->attr<float>("surface_tag");
+        // shared with primSurf, mutable access would copy it
+        const auto& surf_tag = std::as_const(*vprim).attr<float>("surface_tag");
 
         for(size_t t = 0;t < vprim->tris.size();++t){
             const auto tri = vprim->tris[t];
@@ -26,6 +26,8 @@ private:
     int numTets;
     int numSurfs;
 
+    bool firstTime = true;
+
     float tetVolume(zeno::AttrVector<zeno::vec3f> &pos,
                     const zeno::AttrVector<zeno::vec4i> &tet, int i)
     {
@@ -163,6 +165,14 @@ private:
 
 
 public:
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        firstTime = true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
 
@@ -178,7 +188,6 @@ public:
         auto &tet = prim->quads;
         auto &surf = prim->tris;
 
-        static bool firstTime = true;
         if(firstTime)
         {
             initGeo(prim.get());
@@ -454,6 +454,10 @@ class _MemSpanWrapper:
         _dtypeLut = {
             ctypes.c_float: np.float32,
             ctypes.c_int: np.int32,
+            ctypes.c_uint16: np.float16,
+            ctypes.c_uint8: np.uint8,
+            ctypes.c_int64: np.int64,
+            ctypes.c_double: np.float64,
         }
         dtype = _dtypeLut[self._type]
         arr = np.empty(myshape, dtype)
@@ -475,6 +479,10 @@ class _MemSpanWrapper:
         _dtypeLut = {
             ctypes.c_float: np.float32,
             ctypes.c_int: np.int32,
+            ctypes.c_uint16: np.float16,
+            ctypes.c_uint8: np.uint8,
+            ctypes.c_int64: np.int64,
+            ctypes.c_double: np.float64,
         }
         dtype = _dtypeLut[self._type]
         arr = np.ascontiguousarray(arr.astype(dtype))
@@ -526,9 +534,15 @@ class _AttrVectorWrapper:
         ctypes.c_int,
         ctypes.c_float,
         ctypes.c_int,
+        ctypes.c_uint16,  # half, as its bits, see to_numpy
+        ctypes.c_uint8,
+        ctypes.c_uint8,
+        ctypes.c_int64,
+        ctypes.c_double,
+        ctypes.c_double,
     ]
     _dimLut = [
-        3, 1, 3, 1, 2, 2, 4, 4,
+        3, 1, 3, 1, 2, 2, 4, 4, 1, 1, 4, 1, 1, 3,
     ]
     _typeUnlut: dict[tuple[type, int], int] = {
         (float, 3): 0,
@@ -10,16 +10,16 @@ namespace {
 template <class T>
 struct number_printer {
     void operator()(std::ostringstream &ss, T const &value) {
-        ss << value;
+        ss << +value;  // + so that uint8_t prints as a number
     }
 };
 
 template <size_t N, class T>
 struct number_printer<vec<N, T>> {
     void operator()(std::ostringstream &ss, vec<N, T> const &value) {
-        ss << value[0];
+        ss << +value[0];
         for (size_t i = 1; i < N; i++)
-            ss << ',' << value[i];
+            ss << ',' << +value[i];
     }
 };
 
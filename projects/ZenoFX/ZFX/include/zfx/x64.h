@@ -12,12 +12,15 @@ struct Executable {
     size_t memsize = 0;
     float consts[1024];
     void **functable = nullptr;
+    std::shared_ptr<void> pages;  // owns mem, shared with the clones
 
-    static constexpr size_t SimdWidth = 4;
+    // lanes per call: 4 for xmm code, 8 for ymm code on CPUs with AVX2
+    static constexpr size_t MaxSimdWidth = 8;
+    size_t SimdWidth = 4;
 
     struct Context {
         Executable *exec;
-        float locals[SimdWidth * 256];
+        float locals[MaxSimdWidth * 256];
 
         void execute() {
             auto entry = (void(*)(void *, void *, void *))exec->mem;
@@ -25,7 +28,7 @@ struct Executable {
         }
 
         float *channel(int chid) {
-            return locals + SimdWidth * chid;
+            return locals + exec->SimdWidth * chid;
         }
     };
 
@@ -41,9 +44,26 @@ struct Executable {
     Executable(Executable const &) = delete;
     ~Executable();
 
+    // the same code with a constant table of its own, to set parameters in while others
+    // may be running this one
+    std::unique_ptr<Executable> clone() const {
+        auto res = std::make_unique<Executable>();
+        res->mem = mem;
+        res->memsize = memsize;
+        std::memcpy(res->consts, consts, sizeof(consts));
+        res->functable = functable;
+        res->pages = pages;
+        res->SimdWidth = SimdWidth;
+        return res;
+    }
+
+    // simdWidth 0 picks the widest the running CPU supports
     static std::unique_ptr<Executable> assemble
         ( std::string const &lines
+        , size_t simdWidth = 0
         );
+
+    static size_t bestSimdWidth();
 };
 
 struct Assembler {
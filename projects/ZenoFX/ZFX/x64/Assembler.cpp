@@ -5,7 +5,12 @@
 #include <zfx/x64.h>
 #include <algorithm>
 #include <sstream>
+#include <cstdlib>
 #include <map>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
 
 namespace zfx::x64 {
 
@@ -21,6 +26,15 @@ struct ImplAssembler {
     std::unique_ptr<SIMDBuilder> builder = std::make_unique<SIMDBuilder>();
     std::unique_ptr<Executable> exec = std::make_unique<Executable>();
     static inline std::unique_ptr<FuncTable> functable;
+    static inline std::unique_ptr<FuncTable> functable_ymm;
+
+    explicit ImplAssembler(size_t simdWidth) {
+        if (simdWidth == 8)
+            simdkind = simdtype::ymmps;
+        else
+            ERROR_IF(simdWidth != 4);
+        exec->SimdWidth = simdWidth;
+    }
 
     int nconsts = 0;
     int nlocals = 0;
@@ -347,6 +361,8 @@ struct ImplAssembler {
             }
         }
 
+        if (simdkind == simdtype::ymmps)
+            builder->addVZeroUpper();  // avoid the AVX-SSE transition penalty in the caller
         builder->addReturn();
         auto const &insts = builder->getResult();
 
@@ -364,32 +380,54 @@ struct ImplAssembler {
         }
 #endif
 
-        if (!functable)
-            functable = std::make_unique<FuncTable>();
-        exec->functable = functable->funcptrs.data();
+        auto &table = simdkind == simdtype::ymmps ? functable_ymm : functable;
+        if (!table)
+            table = std::make_unique<FuncTable>(exec->SimdWidth);
+        exec->functable = table->funcptrs.data();
         exec->memsize = (insts.size() + 4095) / 4096 * 4096;
         exec->mem = (uint8_t *)exec_page_allocate(exec->memsize);
         for (int i = 0; i < insts.size(); i++) {
             exec->mem[i] = insts[i];
         }
         exec_page_mark_executable(exec->mem, exec->memsize);
+        exec->pages = std::shared_ptr<void>(exec->mem, [memsize = exec->memsize] (void *mem) {
+            exec_page_free(mem, memsize);
+        });
     }
 };
 
 std::unique_ptr<Executable> Executable::assemble
     ( std::string const &lines
+    , size_t simdWidth
     ) {
-    ImplAssembler a;
+    ImplAssembler a(simdWidth ? simdWidth : bestSimdWidth());
     a.parse(lines);
     return std::move(a.exec);
 }
 
-Executable::~Executable() {
-    if (mem) {
-        exec_page_free(mem, memsize);
-        mem = nullptr;
-        memsize = 0;
-    }
+size_t Executable::bestSimdWidth() {
+    static const size_t width = [] () -> size_t {
+        if (auto env = std::getenv("ZFX_SIMD_WIDTH"))
+            return std::atoi(env) == 8 ? 8 : 4;
+#if defined(__GNUC__)
+        return __builtin_cpu_supports("avx2") ? 8 : 4;
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return 4;
+        __cpuidex(info, 7, 0);
+        bool avx2 = info[1] & (1 << 5);
+        __cpuid(info, 1);
+        bool osxsave = info[2] & (1 << 27);
+        return avx2 && osxsave && (_xgetbv(0) & 6) == 6 ? 8 : 4;
+#else
+        return 4;
+#endif
+    }();
+    return width;
 }
 
+Executable::~Executable() = default;
+
 }
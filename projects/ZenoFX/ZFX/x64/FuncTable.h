@@ -32,6 +32,12 @@ static void func_fmod(float *a, float *b) { vcl::Vec4f x, y; x.load(a); y.load(b
 #undef DEF_FN1
 #undef DEF_FN2
 
+    // ymm code passes 8 lanes, done as two xmm halves
+    template <void (*F)(float *)>
+    static void func_wide(float *a) { F(a); F(a + 4); }
+    template <void (*F)(float *, float *)>
+    static void func_wide(float *a, float *b) { F(a, b); F(a + 4, b + 4); }
+
     static inline std::vector<std::string> funcnames = {
 #define DEF_FN1(name) #name,
 #define DEF_FN2(name) DEF_FN1(name)
@@ -57,11 +63,11 @@ DEF_FN2(fmod)
 
     std::vector<void *> funcptrs;
 
-    FuncTable() {
+    explicit FuncTable(size_t simdWidth = 4) {
         // we have to assign funcptrs at runtime to prevent dll relocation
         for (int i = 0; i < funcnames.size(); i++) {
-#define DEF_FN1(name) funcptrs.push_back((void *)func_##name);
-#define DEF_FN2(name) DEF_FN1(name)
+#define DEF_FN1(name) funcptrs.push_back(simdWidth == 8 ? (void *)(void (*)(float *))func_wide<func_##name> : (void *)func_##name);
+#define DEF_FN2(name) funcptrs.push_back(simdWidth == 8 ? (void *)(void (*)(float *, float *))func_wide<func_##name> : (void *)func_##name);
 DEF_FN1(sin)
 DEF_FN1(cos)
 DEF_FN1(tan)
@@ -268,7 +268,13 @@ struct SIMDBuilder {   // requires AVX2
     }
 
     void addAvxMoveOp(int type, int dst, int src) {
-        addAvxBinaryOp(opcode::loadu, opcode::mov, dst, opreg::mm0, src);
+        addAvxBinaryOp(type & 0x04, opcode::mov, dst, opreg::mm0, src);
+    }
+
+    void addVZeroUpper() {
+        res.push_back(0xc5);
+        res.push_back(0xf8);
+        res.push_back(0x77);
     }
 
     void addJumpOp(int off) {
@@ -0,0 +1,179 @@
+#include "kernelcache.h"
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/format.h>
+#include <zeno/utils/fnv1a.h>
+#include <zeno/utils/log.h>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <mutex>
+#include <list>
+
+namespace zeno {
+
+namespace {
+
+// what the cache keeps, never written after being inserted
+struct CompiledKernel {
+    std::shared_ptr<zfx::Program const> prog;
+    std::unique_ptr<zfx::x64::Executable> exec;
+};
+
+struct KernelCache {
+    using LRU = std::list<std::pair<std::string, std::shared_ptr<CompiledKernel const>>>;
+
+    LRU m_lru;  // most recently used first
+    std::unordered_map<std::string, LRU::iterator> m_lut;
+    std::mutex m_mtx;
+    std::size_t const m_maxSize = std::max(1, envconfig::getInt("ZFX_CACHE_SIZE", 256));
+    std::string const m_cacheDir = envconfig::getStr("ZFX_CACHE_DIR");
+
+    std::shared_ptr<CompiledKernel const> find(std::string const &key) {
+        std::lock_guard lck(m_mtx);
+        auto it = m_lut.find(key);
+        if (it == m_lut.end())
+            return nullptr;
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->second;
+    }
+
+    void insert(std::string const &key, std::shared_ptr<CompiledKernel const> kernel) {
+        std::lock_guard lck(m_mtx);
+        if (m_lut.count(key))
+            return;
+        m_lru.emplace_front(key, std::move(kernel));
+        m_lut.emplace(key, m_lru.begin());
+        while (m_lru.size() > m_maxSize) {
+            m_lut.erase(m_lru.back().first);
+            m_lru.pop_back();
+        }
+    }
+
+    std::filesystem::path diskPath(std::string const &key) const {
+        fnv1a h;
+        h.add(std::string_view(key));
+        return std::filesystem::u8path(m_cacheDir) / format("{:016x}.zfxprog", h.digest());
+    }
+
+    static void writeString(std::ostream &os, std::string const &s) {
+        std::size_t n = s.size();
+        os.write((char const *)&n, sizeof(n));
+        os.write(s.data(), n);
+    }
+
+    static bool readString(std::istream &is, std::string &s) {
+        std::size_t n = 0;
+        if (!is.read((char *)&n, sizeof(n)) || n > (1u << 30))
+            return false;
+        s.resize(n);
+        return (bool)is.read(s.data(), n);
+    }
+
+    template <class Pairs>
+    static void writePairs(std::ostream &os, Pairs const &pairs) {
+        std::size_t n = pairs.size();
+        os.write((char const *)&n, sizeof(n));
+        for (auto const &[name, i]: pairs) {
+            writeString(os, name);
+            int v = i;
+            os.write((char const *)&v, sizeof(v));
+        }
+    }
+
+    template <class Func>
+    static bool readPairs(std::istream &is, Func &&func) {
+        std::size_t n = 0;
+        if (!is.read((char *)&n, sizeof(n)))
+            return false;
+        for (std::size_t k = 0; k < n; k++) {
+            std::string name;
+            int v = 0;
+            if (!readString(is, name) || !is.read((char *)&v, sizeof(v)))
+                return false;
+            func(std::move(name), v);
+        }
+        return true;
+    }
+
+    // the key is stored as well, a hash collision is just a miss
+    bool load(std::string const &key, zfx::Program &prog) const {
+        std::ifstream ifs(diskPath(key), std::ios::binary);
+        if (!ifs)
+            return false;
+        std::string storedKey;
+        if (!readString(ifs, storedKey) || storedKey != key)
+            return false;
+        return readString(ifs, prog.assembly)
+            && readPairs(ifs, [&] (std::string name, int v) { prog.symbols.emplace_back(std::move(name), v); })
+            && readPairs(ifs, [&] (std::string name, int v) { prog.params.emplace_back(std::move(name), v); })
+            && readPairs(ifs, [&] (std::string name, int v) { prog.newsyms.emplace(std::move(name), v); });
+    }
+
+    void save(std::string const &key, zfx::Program const &prog) const {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::u8path(m_cacheDir), ec);
+        // written aside and renamed, so that concurrent sessions never read half a file
+        auto path = diskPath(key);
+        auto tmpPath = path;
+        tmpPath += format(".{}.tmp", std::random_device{}());
+        {
+            std::ofstream ofs(tmpPath, std::ios::binary);
+            writeString(ofs, key);
+            writeString(ofs, prog.assembly);
+            writePairs(ofs, prog.symbols);
+            writePairs(ofs, prog.params);
+            writePairs(ofs, prog.newsyms);
+            if (!ofs) {
+                log_warn("failed to write zfx cache {}", tmpPath);
+                return;
+            }
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+            std::filesystem::remove(tmpPath, ec);
+    }
+};
+
+KernelCache &kernelCache() {
+    static KernelCache cache;
+    return cache;
+}
+
+}
+
+std::unique_ptr<ZfxKernel> compileZfxKernel(std::string const &code, zfx::Options const &opts) {
+    std::ostringstream ss;
+    ss << code << "<EOF>";
+    opts.dump(ss);
+    auto key = ss.str();
+
+    auto &cache = kernelCache();
+    auto compiled = cache.find(key);
+    if (!compiled) {
+        // compiled outside the lock, two nodes racing on the same code merely compile it twice
+        auto prog = std::make_shared<zfx::Program>();
+        if (cache.m_cacheDir.empty() || !cache.load(key, *prog)) {
+            *prog = zfx::Program{};
+            auto [assembly, symbols, params, newsyms] = zfx::compile_to_assembly(code, opts);
+            prog->assembly = std::move(assembly);
+            prog->symbols = std::move(symbols);
+            prog->params = std::move(params);
+            prog->newsyms = std::move(newsyms);
+            if (!cache.m_cacheDir.empty())
+                cache.save(key, *prog);
+        }
+        auto kernel = std::make_shared<CompiledKernel>();
+        kernel->exec = zfx::x64::Executable::assemble(prog->assembly);
+        kernel->prog = std::move(prog);
+        compiled = kernel;
+        cache.insert(key, std::move(kernel));
+    }
+    auto res = std::make_unique<ZfxKernel>();
+    res->prog = compiled->prog;
+    res->exec = compiled->exec->clone();
+    return res;
+}
+
+}
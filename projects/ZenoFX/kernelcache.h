@@ -0,0 +1,23 @@
+#pragma once
+
+#include <zfx/zfx.h>
+#include <zfx/x64.h>
+#include <memory>
+#include <string>
+
+namespace zeno {
+
+// the program and the machine code are shared with every node running the same code and
+// only read; exec has a constant table of its own, for the parameters of this run
+struct ZfxKernel {
+    std::shared_ptr<zfx::Program const> prog;
+    std::unique_ptr<zfx::x64::Executable> exec;
+};
+
+// compiled and assembled wrangle code, shared by all the wrangle nodes of the process,
+// keyed by the code and the symbol / parameter layout in opts; keeps the last
+// ZENO_ZFX_CACHE_SIZE (default 256) kernels, and if ZENO_ZFX_CACHE_DIR is set
+// the compiled programs there, so that the next session only needs to assemble
+std::unique_ptr<ZfxKernel> compileZfxKernel(std::string const &code, zfx::Options const &opts);
+
+}
@@ -9,6 +9,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
 #include <cassert>
 #include <vector>
 #include <cctype>
@@ -18,8 +19,6 @@ namespace zeno {
     std::string preApplyRefs(const std::string& code, Graph* pGraph);
 
 namespace {
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
 
 static void numeric_eval (zfx::x64::Executable *exec,
                          std::vector<float> &chs) {
@@ -34,6 +33,14 @@ static void numeric_eval (zfx::x64::Executable *exec,
 
 }
 
+// the kernel of a formula, given back to the node whose input it is and passed in again as
+// "formula" next time, so that it is only compiled again when the code or the parameters change
+struct NumericFormula : IObjectClone<NumericFormula> {
+    std::string code;  // with refs applied
+    std::vector<std::pair<std::string, int>> parnames;
+    std::shared_ptr<ZfxKernel> kernel;
+};
+
     //
     // $F       current frame number (int, GetFrameNum)
     // $DT      delta-t of current graph (float, GetFrameTime)
@@ -44,9 +51,12 @@ struct NumericEval : zeno::INode {
         auto code = get_input2<std::string>("zfxCode");
         auto type = get_input2<std::string>("resType");
         if (type == "string") { // 转发给 se
-            auto res = getThisGraph()->callTempNode("StringEval",
-                    {{"zfxCode", objectFromLiterial(code)}}).at("result");
-            set_output("result", std::move(res));
+            std::map<std::string, zany> args{{"zfxCode", objectFromLiterial(code)}};
+            if (has_input("formula"))
+                args["formula"] = get_input("formula");
+            auto res = getThisGraph()->callTempNode("StringEval", std::move(args));
+            set_output("result", std::move(res.at("result")));
+            set_output("formula", std::move(res.at("formula")));
             return;
         }
         //auto code = get_params<>
@@ -129,8 +139,15 @@ struct NumericEval : zeno::INode {
         //开始编译
         if (code.find("@result") == std::string::npos)
             code = "@result = ( " + code + " )";
-        auto prog = compiler.compile(code, opts);
-        auto exec = assembler.assemble(prog->assembly);
+        auto formula = has_input("formula") ? std::dynamic_pointer_cast<NumericFormula>(get_input("formula")) : nullptr;
+        if (!formula || formula->code != code || formula->parnames != parnames) {
+            formula = std::make_shared<NumericFormula>();
+            formula->code = code;
+            formula->parnames = parnames;
+            formula->kernel = compileZfxKernel(code, opts);
+        }
+        auto prog = formula->kernel->prog.get();
+        auto exec = formula->kernel->exec.get();
 
         //计算输出结果
         auto result = std::make_shared<zeno::NumericObject>();
@@ -206,6 +223,7 @@ struct NumericEval : zeno::INode {
         throw makeError("invalid resType value: " + type);
     }
     set_output("result", std::move(result));
+    set_output("formula", std::move(formula));
     }
 };
 
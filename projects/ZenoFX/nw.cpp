@@ -6,6 +6,7 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 
@@ -16,8 +17,6 @@ namespace zeno {
 namespace {
     using namespace zeno;
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
 
 static void numeric_wrangle
     ( zfx::x64::Executable *exec
@@ -117,8 +116,9 @@ struct NumericWrangle : zeno::INode {
             // END 引用预解析
         }
 
-        auto prog = compiler.compile(code, opts);
-        auto exec = assembler.assemble(prog->assembly);
+        auto kernel = compileZfxKernel(code, opts);
+        auto prog = kernel->prog.get();
+        auto exec = kernel->exec.get();
 
         auto result = std::make_shared<zeno::DictObject>();
         for (auto const &[name, dim]: prog->newsyms) {
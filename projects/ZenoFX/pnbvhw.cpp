@@ -9,6 +9,8 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
+#include "stagedchannel.h"
 #include <cassert>
 #include "dbg_printf.h"
 #include <cmath>
@@ -20,9 +22,6 @@
 
 namespace zeno {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
-
 struct Buffer {
   float *base = nullptr;
   size_t count = 0;
@@ -761,29 +760,13 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
 
     zfx::Options opts(zfx::Options::for_x64);
     opts.detect_new_symbols = true;
-    prim->foreach_attr([&](auto const &key, auto const &attr) {
-      int dim = ([](auto const &v) {
-        using T = std::decay_t<decltype(v[0])>;
-        if constexpr (std::is_same_v<T, zeno::vec3f>)
-          return 3;
-        else if constexpr (std::is_same_v<T, float>)
-          return 1;
-        else
-          return 0;
-      })(attr);
+    prim->foreach_attr<AttrAcceptAll>([&](auto const &key, auto const &attr) {
+      int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
       dbg_printf("define symbol: @%s dim %d\n", key.c_str(), dim);
       opts.define_symbol('@' + key, dim);
     });
-    primNei->foreach_attr([&](auto const &key, auto const &attr) {
-      int dim = ([](auto const &v) {
-        using T = std::decay_t<decltype(v[0])>;
-        if constexpr (std::is_same_v<T, zeno::vec3f>)
-          return 3;
-        else if constexpr (std::is_same_v<T, float>)
-          return 1;
-        else
-          return 0;
-      })(attr);
+    primNei->foreach_attr<AttrAcceptAll>([&](auto const &key, auto const &attr) {
+      int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
       dbg_printf("define symbol: @@%s dim %d\n", key.c_str(), dim);
       opts.define_symbol("@@" + key, dim);
     });
@@ -861,8 +844,9 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
             
         }
 
-    auto prog = compiler.compile(code, opts);
-    auto exec = assembler.assemble(prog->assembly);
+    auto kernel = compileZfxKernel(code, opts);
+    auto prog = kernel->prog.get();
+    auto exec = kernel->exec.get();
 
     for (auto const &[name, dim] : prog->newsyms) {
       dbg_printf("auto-defined new attribute: %s with dim %d\n", name.c_str(),
@@ -894,6 +878,7 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
       exec->parameter(prog->param_id(name, dimid)) = value;
     }
 
+    StagedChannels staged;
     std::vector<Buffer> chs(prog->symbols.size());
     for (int i = 0; i < chs.size(); i++) {
       auto [name, dimid] = prog->symbols[i];
@@ -910,11 +895,7 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
         primPtr = prim.get();
         iob.which = 0;
       }
-      prim->attr_visit(name, [&, dimid_ = dimid](auto const &arr) {
-        iob.base = (float *)arr.data() + dimid_;
-        iob.count = arr.size();
-        iob.stride = sizeof(arr[0]) / sizeof(float);
-      });
+      bindWrangleChannel(iob, *prim, name, dimid, staged);
       chs[i] = iob;
     }
     std::vector<Buffer> chs2(prog->symbols.size());
@@ -933,11 +914,7 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
         primPtr = prim.get();
         iob.which = 0;
       }
-      primNei->attr_visit(name, [&, dimid_ = dimid](auto const &arr) {
-        iob.base = (float *)arr.data() + dimid_;
-        iob.count = arr.size();
-        iob.stride = sizeof(arr[0]) / sizeof(float);
-      });
+      bindWrangleChannel(iob, *primNei, name, dimid, staged);
       chs2[i] = iob;
     }
 
@@ -945,6 +922,9 @@ struct ParticlesNeighborBvhWrangle : zeno::INode {
                         primNei->attr<zeno::vec3f>("pos"), get_input2<bool>("is_box"),
                         lbvh.get()->thickness * lbvh.get()->thickness, lbvh.get());
 
+    for (auto &ch: staged)
+        ch.store();
+
     set_output("prim", std::move(prim));
   }
 };
@@ -987,29 +967,13 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
 
     zfx::Options opts(zfx::Options::for_x64);
     opts.detect_new_symbols = true;
-    prim->foreach_attr([&](auto const &key, auto const &attr) {
-      int dim = ([](auto const &v) {
-        using T = std::decay_t<decltype(v[0])>;
-        if constexpr (std::is_same_v<T, zeno::vec3f>)
-          return 3;
-        else if constexpr (std::is_same_v<T, float>)
-          return 1;
-        else
-          return 0;
-      })(attr);
+    prim->foreach_attr<AttrAcceptAll>([&](auto const &key, auto const &attr) {
+      int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
       dbg_printf("define symbol: @%s dim %d\n", key.c_str(), dim);
       opts.define_symbol('@' + key, dim);
     });
-    primNei->foreach_attr([&](auto const &key, auto const &attr) {
-      int dim = ([](auto const &v) {
-        using T = std::decay_t<decltype(v[0])>;
-        if constexpr (std::is_same_v<T, zeno::vec3f>)
-          return 3;
-        else if constexpr (std::is_same_v<T, float>)
-          return 1;
-        else
-          return 0;
-      })(attr);
+    primNei->foreach_attr<AttrAcceptAll>([&](auto const &key, auto const &attr) {
+      int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
       dbg_printf("define symbol: @@%s dim %d\n", key.c_str(), dim);
       opts.define_symbol("@@" + key, dim);
     });
@@ -1087,8 +1051,9 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
             
         }
 
-    auto prog = compiler.compile(code, opts);
-    auto exec = assembler.assemble(prog->assembly);
+    auto kernel = compileZfxKernel(code, opts);
+    auto prog = kernel->prog.get();
+    auto exec = kernel->exec.get();
 
     for (auto const &[name, dim] : prog->newsyms) {
       dbg_printf("auto-defined new attribute: %s with dim %d\n", name.c_str(),
@@ -1120,6 +1085,7 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
       exec->parameter(prog->param_id(name, dimid)) = value;
     }
 
+    StagedChannels staged;
     std::vector<Buffer> chs(prog->symbols.size());
     for (int i = 0; i < chs.size(); i++) {
       auto [name, dimid] = prog->symbols[i];
@@ -1136,11 +1102,7 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
         primPtr = prim.get();
         iob.which = 0;
       }
-      prim->attr_visit(name, [&, dimid_ = dimid](auto const &arr) {
-        iob.base = (float *)arr.data() + dimid_;
-        iob.count = arr.size();
-        iob.stride = sizeof(arr[0]) / sizeof(float);
-      });
+      bindWrangleChannel(iob, *prim, name, dimid, staged);
       chs[i] = iob;
     }
     std::vector<Buffer> chs2(prog->symbols.size());
@@ -1159,11 +1121,7 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
         primPtr = prim.get();
         iob.which = 0;
       }
-      primNei->attr_visit(name, [&, dimid_ = dimid](auto const &arr) {
-        iob.base = (float *)arr.data() + dimid_;
-        iob.count = arr.size();
-        iob.stride = sizeof(arr[0]) / sizeof(float);
-      });
+      bindWrangleChannel(iob, *primNei, name, dimid, staged);
       chs2[i] = iob;
     }
 
@@ -1171,6 +1129,9 @@ struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
                         primNei->attr<zeno::vec3f>("pos"), get_input2<bool>("is_box"),
                         lbvh.get()->thickness * lbvh.get()->thickness, get_input2<int>("limit"), lbvh.get());
 
+    for (auto &ch: staged)
+        ch.store();
+
     set_output("prim", std::move(prim));
   }
 };
@@ -1219,29 +1180,13 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
 
     zfx::Options opts(zfx::Options::for_x64);
     opts.detect_new_symbols = true;
-    prim->foreach_attr([&](auto const &key, auto const &attr) {
-      int dim = ([](auto const &v) {
-        using T = std::decay_t<decltype(v[0])>;
-        if constexpr (std::is_same_v<T, zeno::vec3f>)
-          return 3;
-        else if constexpr (std::is_same_v<T, float>)
-          return 1;
-        else
-          return 0;
-      })(attr);
+    prim->foreach_attr<AttrAcceptAll>([&](auto const &key, auto const &attr) {
+      int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
       dbg_printf("define symbol: @%s dim %d\n", key.c_str(), dim);
       opts.define_symbol('@' + key, dim);
     });
-    primNei->foreach_attr([&](auto const &key, auto const &attr) {
-      int dim = ([](auto const &v) {
-        using T = std::decay_t<decltype(v[0])>;
-        if constexpr (std::is_same_v<T, zeno::vec3f>)
-          return 3;
-        else if constexpr (std::is_same_v<T, float>)
-          return 1;
-        else
-          return 0;
-      })(attr);
+    primNei->foreach_attr<AttrAcceptAll>([&](auto const &key, auto const &attr) {
+      int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
       dbg_printf("define symbol: @@%s dim %d\n", key.c_str(), dim);
       opts.define_symbol("@@" + key, dim);
     });
@@ -1319,8 +1264,9 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
             
         }
 
-    auto prog = compiler.compile(code, opts);
-    auto exec = assembler.assemble(prog->assembly);
+    auto kernel = compileZfxKernel(code, opts);
+    auto prog = kernel->prog.get();
+    auto exec = kernel->exec.get();
 
     for (auto const &[name, dim] : prog->newsyms) {
       dbg_printf("auto-defined new attribute: %s with dim %d\n", name.c_str(),
@@ -1352,6 +1298,7 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
       exec->parameter(prog->param_id(name, dimid)) = value;
     }
 
+    StagedChannels staged;
     std::vector<Buffer> chs(prog->symbols.size());
     for (int i = 0; i < chs.size(); i++) {
       auto [name, dimid] = prog->symbols[i];
@@ -1368,11 +1315,7 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
         primPtr = prim.get();
         iob.which = 0;
       }
-      prim->attr_visit(name, [&, dimid_ = dimid](auto const &arr) {
-        iob.base = (float *)arr.data() + dimid_;
-        iob.count = arr.size();
-        iob.stride = sizeof(arr[0]) / sizeof(float);
-      });
+      bindWrangleChannel(iob, *prim, name, dimid, staged);
       chs[i] = iob;
     }
     std::vector<Buffer> chs2(prog->symbols.size());
@@ -1391,11 +1334,7 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
         primPtr = prim.get();
         iob.which = 0;
       }
-      primNei->attr_visit(name, [&, dimid_ = dimid](auto const &arr) {
-        iob.base = (float *)arr.data() + dimid_;
-        iob.count = arr.size();
-        iob.stride = sizeof(arr[0]) / sizeof(float);
-      });
+      bindWrangleChannel(iob, *primNei, name, dimid, staged);
       chs2[i] = iob;
     }
     std::string maskAttr = get_input2<std::string>("maskAttr");
@@ -1405,6 +1344,9 @@ struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
                         get_input2<bool>("is_box"),
                         lbvh.get()->thickness, lbvh.get());
 
+    for (auto &ch: staged)
+        ch.store();
+
     set_output("prim", std::move(prim));
   }
 };
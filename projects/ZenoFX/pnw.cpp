@@ -7,6 +7,8 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
+#include "stagedchannel.h"
 #include <cassert>
 #include "dbg_printf.h"
 #include <cmath>
@@ -20,9 +22,6 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
-
 struct Buffer {
     float *base = nullptr;
     size_t count = 0;
@@ -209,23 +208,13 @@ struct ParticlesNeighborWrangle : zeno::INode {
 
         zfx::Options opts(zfx::Options::for_x64);
         opts.detect_new_symbols = true;
-        prim->foreach_attr([&] (auto const &key, auto const &attr) {
-            int dim = ([] (auto const &v) {
-                using T = std::decay_t<decltype(v[0])>;
-                if constexpr (std::is_same_v<T, zeno::vec3f>) return 3;
-                else if constexpr (std::is_same_v<T, float>) return 1;
-                else return 0;
-            })(attr);
+        prim->foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
+            int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
             dbg_printf("define symbol: @%s dim %d\n", key.c_str(), dim);
             opts.define_symbol('@' + key, dim);
         });
-        primNei->foreach_attr([&] (auto const &key, auto const &attr) {
-            int dim = ([] (auto const &v) {
-                using T = std::decay_t<decltype(v[0])>;
-                if constexpr (std::is_same_v<T, zeno::vec3f>) return 3;
-                else if constexpr (std::is_same_v<T, float>) return 1;
-                else return 0;
-            })(attr);
+        primNei->foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
+            int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
             dbg_printf("define symbol: @@%s dim %d\n", key.c_str(), dim);
             opts.define_symbol("@@" + key, dim);
         });
@@ -310,8 +299,9 @@ struct ParticlesNeighborWrangle : zeno::INode {
             // END 引用预解析
         }
 
-        auto prog = compiler.compile(code, opts);
-        auto exec = assembler.assemble(prog->assembly);
+        auto kernel = compileZfxKernel(code, opts);
+        auto prog = kernel->prog.get();
+        auto exec = kernel->exec.get();
 
         for (auto const &[name, dim]: prog->newsyms) {
             dbg_printf("auto-defined new attribute: %s with dim %d\n",
@@ -343,6 +333,7 @@ struct ParticlesNeighborWrangle : zeno::INode {
             exec->parameter(prog->param_id(name, dimid)) = value;
         }
 
+        StagedChannels staged;
         std::vector<Buffer> chs(prog->symbols.size());
         for (int i = 0; i < chs.size(); i++) {
             auto [name, dimid] = prog->symbols[i];
@@ -359,11 +350,7 @@ struct ParticlesNeighborWrangle : zeno::INode {
                 primPtr = prim.get();
                 iob.which = 0;
             }
-            prim->attr_visit(name, [&, dimid_ = dimid] (auto const &arr) {
-                iob.base = (float *)arr.data() + dimid_;
-                iob.count = arr.size();
-                iob.stride = sizeof(arr[0]) / sizeof(float);
-            });
+            bindWrangleChannel(iob, *prim, name, dimid, staged);
             chs[i] = iob;
         }
         std::vector<Buffer> chs2(prog->symbols.size());
@@ -382,17 +369,16 @@ struct ParticlesNeighborWrangle : zeno::INode {
                 primPtr = prim.get();
                 iob.which = 0;
             }
-            primNei->attr_visit(name, [&, dimid_ = dimid] (auto const &arr) {
-                iob.base = (float *)arr.data() + dimid_;
-                iob.count = arr.size();
-                iob.stride = sizeof(arr[0]) / sizeof(float);
-            });
+            bindWrangleChannel(iob, *primNei, name, dimid, staged);
             chs2[i] = iob;
         }
 
         vectors_wrangle(exec, chs, chs2, prim->attr<zeno::vec3f>("pos"),
                 hashgrid.get());
 
+        for (auto &ch: staged)
+            ch.store();
+
         set_output("prim", std::move(prim));
     }
 };
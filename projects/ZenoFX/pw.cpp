@@ -7,7 +7,10 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
+#include "stagedchannel.h"
 #include <cassert>
+#include <cstring>
 #include "dbg_printf.h"
 
 namespace zeno {
@@ -15,9 +18,6 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
-
 struct Buffer {
     float *base = nullptr;
     size_t count = 0;
@@ -35,20 +35,34 @@ static void vectors_wrangle
         size = std::min(chs[i].count, size);
     }
 
-    #pragma omp parallel for
-    for (int i = 0; i < size - exec->SimdWidth + 1; i += exec->SimdWidth) {
+    // float attributes are contiguous and copied in one go, vec3f components are gathered
+    auto const width = exec->SimdWidth;
+    std::ptrdiff_t const nfull = size / width * width;
+    #pragma omp parallel
+    {
         auto ctx = exec->make_context();
-        for (int j = 0; j < chs.size(); j++) {
-            for (int k = 0; k < exec->SimdWidth; k++)
-                ctx.channel(j)[k] = chs[j].base[chs[j].stride * (i + k)];
-        }
-        ctx.execute();
-        for (int j = 0; j < chs.size(); j++) {
-            for (int k = 0; k < exec->SimdWidth; k++)
-                 chs[j].base[chs[j].stride * (i + k)] = ctx.channel(j)[k];
+        #pragma omp for
+        for (std::ptrdiff_t i = 0; i < nfull; i += width) {
+            for (int j = 0; j < chs.size(); j++) {
+                if (chs[j].stride == 1) {
+                    std::memcpy(ctx.channel(j), chs[j].base + i, width * sizeof(float));
+                } else {
+                    for (int k = 0; k < width; k++)
+                        ctx.channel(j)[k] = chs[j].base[chs[j].stride * (i + k)];
+                }
+            }
+            ctx.execute();
+            for (int j = 0; j < chs.size(); j++) {
+                if (chs[j].stride == 1) {
+                    std::memcpy(chs[j].base + i, ctx.channel(j), width * sizeof(float));
+                } else {
+                    for (int k = 0; k < width; k++)
+                        chs[j].base[chs[j].stride * (i + k)] = ctx.channel(j)[k];
+                }
+            }
         }
     }
-    for (int i = size / exec->SimdWidth * exec->SimdWidth; i < size; i++) {
+    for (std::size_t i = nfull; i < size; i++) {
         auto ctx = exec->make_context();
         for (int j = 0; j < chs.size(); j++) {
             ctx.channel(j)[0] = chs[j].base[chs[j].stride * i];
@@ -74,13 +88,8 @@ struct ParticlesWrangle : zeno::INode {
 
         zfx::Options opts(zfx::Options::for_x64);
         opts.detect_new_symbols = true;
-        prim->foreach_attr([&] (auto const &key, auto const &attr) {
-            int dim = ([] (auto const &v) {
-                using T = std::decay_t<decltype(v[0])>;
-                if constexpr (std::is_same_v<T, zeno::vec3f>) return 3;
-                else if constexpr (std::is_same_v<T, float>) return 1;
-                else return 0;
-            })(attr);
+        prim->foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
+            int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
             dbg_printf("define symbol: @%s dim %d\n", key.c_str(), dim);
             opts.define_symbol('@' + key, dim);
         });
@@ -167,8 +176,9 @@ struct ParticlesWrangle : zeno::INode {
             // END 引用预解析
         }
 
-        auto prog = compiler.compile(code, opts);
-        auto exec = assembler.assemble(prog->assembly);
+        auto kernel = compileZfxKernel(code, opts);
+        auto prog = kernel->prog.get();
+        auto exec = kernel->exec.get();
 
         for (auto const &[name, dim]: prog->newsyms) {
             dbg_printf("auto-defined new attribute: %s with dim %d\n",
@@ -197,20 +207,18 @@ struct ParticlesWrangle : zeno::INode {
         }
 
         std::vector<Buffer> chs(prog->symbols.size());
+        StagedChannels staged;
         for (int i = 0; i < chs.size(); i++) {
             auto [name, dimid] = prog->symbols[i];
             dbg_printf("channel %d: %s.%d\n", i, name.c_str(), dimid);
             assert(name[0] == '@');
             Buffer iob;
-            prim->attr_visit(name.substr(1),
-            [&, dimid_ = dimid] (auto const &arr) {
-                iob.base = (float *)arr.data() + dimid_;
-                iob.count = arr.size();
-                iob.stride = sizeof(arr[0]) / sizeof(float);
-            });
+            bindWrangleChannel(iob, *prim, name.substr(1), dimid, staged);
             chs[i] = iob;
         }
         vectors_wrangle(exec, chs);
+        for (auto &ch: staged)
+            ch.store();
 
         set_output("prim", std::move(prim));
     }
@@ -8,10 +8,18 @@
 #include <zeno/extra/TempNode.h>
 #include <sstream>
 #include <iomanip>
+#include <vector>
 
 namespace zeno {
 namespace {
 
+    // the compiled {} expressions of a string formula, in order, given back to the node whose
+    // input it is and passed in again as "formula" next time, see NumericFormula in ne.cpp
+    struct StringFormula : IObjectClone<StringFormula> {
+        std::string code;
+        std::vector<zany> exprs;
+    };
+
 
     //
     // $F       current frame number
@@ -34,7 +42,12 @@ namespace {
     struct StringEval : zeno::INode {
         virtual void apply() override {
             auto code = get_input2<std::string>("zfxCode");
-
+            auto formula = has_input("formula") ? std::dynamic_pointer_cast<StringFormula>(get_input("formula")) : nullptr;
+            if (!formula || formula->code != code) {
+                formula = std::make_shared<StringFormula>();
+                formula->code = code;
+            }
+            std::size_t nexprs = 0;
 
             std::size_t pos0 = 0;
             while (1) if (auto pos = code.find('{', pos0); pos != std::string::npos) {
@@ -47,10 +60,14 @@ namespace {
                     w = std::stoi(necode.substr(nepos + 1));
                     necode = necode.substr(0, nepos);
                 }
-                int val = std::rint(temp_node("NumericEval")
-                    .set2("zfxCode", necode)
-                    .set2("resType", "float")
-                    .get2<float>("result"));
+                auto ne = temp_node("NumericEval");
+                ne.set2("zfxCode", necode).set2("resType", "float");
+                if (nexprs < formula->exprs.size())
+                    ne.set("formula", formula->exprs[nexprs]);
+                else
+                    formula->exprs.emplace_back();
+                int val = std::rint(ne.get2<float>("result"));
+                formula->exprs[nexprs++] = ne.get("formula");
                 std::ostringstream oss;
                 if (w > 1) {
                     oss << std::setfill('0') << std::setw(w);
@@ -111,6 +128,7 @@ namespace {
                 //}
             //}
             set_output2("result", std::move(code));
+            set_output("formula", std::move(formula));
         }
     };
 
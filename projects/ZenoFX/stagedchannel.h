@@ -0,0 +1,74 @@
+#pragma once
+
+#include <zeno/types/AttrVector.h>
+#include <zeno/utils/vec.h>
+#include <type_traits>
+#include <functional>
+#include <variant>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace zeno {
+
+// the compact attribute types, which the kernel can't address directly: each channel is
+// converted into a float array before running, and stored back after
+using StagedAttrTypes = std::variant<half, uint8_t, vec4C, int64_t, double, vec3d>;
+
+// dimension of the @symbol an attribute of type T is bound as, 0 if it can't be bound
+template <class T>
+constexpr int wrangleSymbolDim() {
+    if constexpr (std::is_same_v<T, vec3f>) return 3;
+    else if constexpr (std::is_same_v<T, float>) return 1;
+    else if constexpr (variant_contains<T, StagedAttrTypes>::value) return (int)is_vec_n<T>;
+    else return 0;
+}
+
+struct StagedChannel {
+    std::vector<float> values;
+    std::function<void(std::vector<float> const &)> storeFn;
+
+    template <class T>
+    StagedChannel(std::vector<T> &arr, int comp) : values(arr.size()) {
+        #pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)arr.size(); i++)
+            values[i] = attr_get_float(arr[i], comp);
+        storeFn = [&arr, comp] (std::vector<float> const &values) {
+            // only what the code changed, so that reading a double doesn't round it to float
+            #pragma omp parallel for
+            for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)arr.size(); i++)
+                if (values[i] != attr_get_float(arr[i], comp))
+                    attr_set_float(arr[i], comp, values[i]);
+        };
+    }
+
+    void store() {
+        storeFn(values);
+    }
+};
+
+// a deque, as the buffers point into the channels already staged
+using StagedChannels = std::deque<StagedChannel>;
+
+// points iob (any wrangle Buffer with base, count and stride) at component comp of attribute
+// name of obj, a PrimitiveObject or an AttrVector, staging it first if the kernel can't
+// address its type; call store() on the staged channels after running the kernel
+template <class Buffer, class Obj>
+void bindWrangleChannel(Buffer &iob, Obj &obj, std::string const &name, int comp, StagedChannels &staged) {
+    obj.template attr_visit<AttrAcceptAll>(name, [&] (auto &arr) {
+        using T = std::decay_t<decltype(arr[0])>;
+        if constexpr (std::is_same_v<T, vec3f> || std::is_same_v<T, float>) {
+            iob.base = (float *)arr.data() + comp;
+            iob.count = arr.size();
+            iob.stride = sizeof(arr[0]) / sizeof(float);
+        } else if constexpr (variant_contains<T, StagedAttrTypes>::value) {
+            auto &ch = staged.emplace_back(arr, comp);
+            iob.base = ch.values.data();
+            iob.count = ch.values.size();
+            iob.stride = 1;
+        }
+    });
+}
+
+}
@@ -0,0 +1,64 @@
+// a formula reading ref(node/param) of a node inside a loop must see the value of each
+// iteration, not the one of the first iteration of the substep, see INode::get_formula
+
+#include <zeno/zeno.h>
+#include <zeno/core/Graph.h>
+#include <zeno/types/NumericObject.h>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+std::vector<float> recorded;
+
+struct TestRecordFloat : zeno::INode {
+    virtual void apply() override {
+        auto value = get_input2<float>("value");
+        recorded.push_back(value);
+        set_output("value", zeno::objectFromLiterial(value));
+    }
+};
+
+ZENDEFNODE(TestRecordFloat, {
+    {{"float", "value"}},
+    {{"float", "value"}},
+    {},
+    {"test"},
+});
+
+}
+
+int main() {
+    auto graph = zeno::getSession().createGraph();
+
+    graph->addNode("BeginFor", "loop");
+    graph->setNodeInput("loop", "count", zeno::objectFromLiterial(3));
+    graph->completeNode("loop");
+
+    // only referred to, by the formula below
+    graph->addNode("TestRecordFloat", "refsource");
+    graph->bindNodeInput("refsource", "value", "loop", "index");
+    graph->completeNode("refsource");
+
+    graph->addNode("TestRecordFloat", "record");
+    graph->setFormula("record", "value", zeno::objectFromLiterial(std::string("ref(refsource/value) * 10")));
+    graph->completeNode("record");
+
+    graph->addNode("EndFor", "endloop");
+    graph->bindNodeInput("endloop", "FOR", "loop", "FOR");
+    graph->bindNodeInput("endloop", "body", "record", "value");
+    graph->completeNode("endloop");
+
+    graph->applyNodes({"endloop"});
+
+    std::vector<float> expected{0, 10, 20};
+    if (recorded != expected) {
+        std::printf("test_formula_ref: expected 0 10 20, got");
+        for (auto v: recorded)
+            std::printf(" %g", v);
+        std::printf("\n");
+        return 1;
+    }
+    std::printf("test_formula_ref: ok\n");
+    return 0;
+}
@@ -8,7 +8,10 @@
 #include <zeno/core/Graph.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
+#include "stagedchannel.h"
 #include <cassert>
+#include <cstring>
 #include "dbg_printf.h"
 
 namespace zeno {
@@ -16,9 +19,6 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
-
 struct Buffer {
     float *base = nullptr;
     size_t count = 0;
@@ -36,20 +36,34 @@ static void vectors_wrangle
         size = std::min(chs[i].count, size);
     }
 
-    #pragma omp parallel for
-    for (int i = 0; i < size - exec->SimdWidth + 1; i += exec->SimdWidth) {
+    // float attributes are contiguous and copied in one go, vec3f components are gathered
+    auto const width = exec->SimdWidth;
+    std::ptrdiff_t const nfull = size / width * width;
+    #pragma omp parallel
+    {
         auto ctx = exec->make_context();
-        for (int j = 0; j < chs.size(); j++) {
-            for (int k = 0; k < exec->SimdWidth; k++)
-                ctx.channel(j)[k] = chs[j].base[chs[j].stride * (i + k)];
-        }
-        ctx.execute();
-        for (int j = 0; j < chs.size(); j++) {
-            for (int k = 0; k < exec->SimdWidth; k++)
-                 chs[j].base[chs[j].stride * (i + k)] = ctx.channel(j)[k];
+        #pragma omp for
+        for (std::ptrdiff_t i = 0; i < nfull; i += width) {
+            for (int j = 0; j < chs.size(); j++) {
+                if (chs[j].stride == 1) {
+                    std::memcpy(ctx.channel(j), chs[j].base + i, width * sizeof(float));
+                } else {
+                    for (int k = 0; k < width; k++)
+                        ctx.channel(j)[k] = chs[j].base[chs[j].stride * (i + k)];
+                }
+            }
+            ctx.execute();
+            for (int j = 0; j < chs.size(); j++) {
+                if (chs[j].stride == 1) {
+                    std::memcpy(chs[j].base + i, ctx.channel(j), width * sizeof(float));
+                } else {
+                    for (int k = 0; k < width; k++)
+                        chs[j].base[chs[j].stride * (i + k)] = ctx.channel(j)[k];
+                }
+            }
         }
     }
-    for (int i = size / exec->SimdWidth * exec->SimdWidth; i < size; i++) {
+    for (std::size_t i = nfull; i < size; i++) {
         auto ctx = exec->make_context();
         for (int j = 0; j < chs.size(); j++) {
             ctx.channel(j)[0] = chs[j].base[chs[j].stride * i];
@@ -103,13 +117,8 @@ struct TrianglesWrangle : zeno::INode {
         constexpr int npoly = is_vec_n<std::decay_t<decltype(tris[0])>>;
 	static_assert(npoly <= 9);
 	static_assert(std::is_same_v<decay_vec_t<std::decay_t<decltype(tris[0])>>, int>);
-        tris.foreach_attr([&] (auto const &key, auto const &attr) {
-            int dim = ([] (auto const &v) {
-                using T = std::decay_t<decltype(v[0])>;
-                if constexpr (std::is_same_v<T, zeno::vec3f>) return 3;
-                else if constexpr (std::is_same_v<T, float>) return 1;
-                else return 0;
-            })(attr);
+        tris.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
+            int dim = wrangleSymbolDim<std::decay_t<decltype(attr[0])>>();
             dbg_printf("define symbol: @%s dim %d\n", key.c_str(), dim);
             opts.define_symbol('@' + key, dim);
         });
@@ -209,8 +218,9 @@ struct TrianglesWrangle : zeno::INode {
             // END 引用预解析
         }
 
-        auto prog = compiler.compile(code, opts);
-        auto exec = assembler.assemble(prog->assembly);
+        auto kernel = compileZfxKernel(code, opts);
+        auto prog = kernel->prog.get();
+        auto exec = kernel->exec.get();
 
         for (auto const &[name, dim]: prog->newsyms) {
             dbg_printf("auto-defined new attribute: %s with dim %d\n",
@@ -242,6 +252,7 @@ struct TrianglesWrangle : zeno::INode {
         }
 
 	//std::map<std::string, std::array<std::vector<char>, npoly>> tmparrs;
+        StagedChannels staged;
         std::vector<Buffer> chs(prog->symbols.size());
         for (int i = 0; i < chs.size(); i++) {
             auto [name, dimid] = prog->symbols[i];
@@ -257,16 +268,13 @@ struct TrianglesWrangle : zeno::INode {
                     //iob.stride = sizeof(tmparr[0]) / sizeof(float);
 		//});
 		//} else {
-            tris.attr_visit(name.substr(1),
-            [&, dimid_ = dimid] (auto const &arr) {
-                iob.base = (float *)arr.data() + dimid_;
-                iob.count = arr.size();
-                iob.stride = sizeof(arr[0]) / sizeof(float);
-            });
+            bindWrangleChannel(iob, tris, name.substr(1), dimid, staged);
 		//}
             chs[i] = iob;
         }
         vectors_wrangle(exec, chs);
+        for (auto &ch: staged)
+            ch.store();
     }
 };
 
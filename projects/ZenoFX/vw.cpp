@@ -10,6 +10,7 @@
 #include <zeno/VDBGrid.h>
 #include <zfx/zfx.h>
 #include <zfx/x64.h>
+#include "kernelcache.h"
 #include <cassert>
 #include "dbg_printf.h"
 #include <zeno/StringObject.h>
@@ -20,9 +21,6 @@ namespace zeno {
 
 namespace {
 
-static zfx::Compiler compiler;
-static zfx::x64::Assembler assembler;
-
 template <class GridPtr>
 void vdb_wrangle(zfx::x64::Executable *exec, GridPtr &grid, bool modifyActive, bool changeBackground, bool hasPos) {
     //ZENO_P(grid->background());
@@ -212,8 +210,9 @@ struct VDBWrangle : zeno::INode {
             // END 引用预解析
         }
 
-        auto prog = compiler.compile(code, opts);
-        auto exec = assembler.assemble(prog->assembly);
+        auto kernel = compileZfxKernel(code, opts);
+        auto prog = kernel->prog.get();
+        auto exec = kernel->exec.get();
 
         std::vector<float> pars(prog->params.size());
         for (int i = 0; i < pars.size(); i++) {
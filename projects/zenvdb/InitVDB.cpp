@@ -1,14 +1,37 @@
 #include <openvdb/openvdb.h>
+#include <tbb/global_control.h>
 #include <zeno/utils/log.h>
 #include <zeno/core/Session.h>
 #include <zeno/extra/EventCallbacks.h>
+#include <zeno/extra/ThreadPool.h>
+#include <memory>
 
 namespace zeno {
 
+// OpenVDB, FastFLIP and friends run on TBB, keep its workers within the size of our pool.
+// Unlike OpenMP teams, which every pool worker starts on its own, TBB has one set of workers
+// for the whole process, and a pool worker calling into TBB joins them itself. Only while
+// the pool is busy with other nodes at the same time as TBB runs can there be up to twice
+// the pool size of threads; those TBB workers sleep as soon as their loops are done.
+static std::unique_ptr<tbb::global_control> tbbThreadLimit;
+
+static void limitTbbThreads() {
+    auto numThreads = getSession().threadPool->numThreads();
+    tbbThreadLimit = nullptr;
+    tbbThreadLimit = std::make_unique<tbb::global_control>(
+        tbb::global_control::max_allowed_parallelism, numThreads);
+    zeno::log_debug("TBB limited to {} threads", numThreads);
+}
+
 static int defOpenvdbInit = getSession().eventCallbacks->hookEvent("init", [] {
     zeno::log_debug("Initializing OpenVDB...");
+    limitTbbThreads();
     openvdb::initialize();
     zeno::log_debug("Initialized OpenVDB successfully!");
 });
 
+static int defTbbThreads = getSession().eventCallbacks->hookEvent("threadsConfigured", [] {
+    limitTbbThreads();
+});
+
 }
@@ -49,6 +49,14 @@ static std::shared_ptr<VDBGrid> readGenericVDBGrid(const std::string &fn) {
 struct CacheVDBGrid : zeno::INode {
     int m_framecounter = 0;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        m_framecounter = 0;
+    }
+
     virtual void preApply() override {
         if (get_param<bool>("mute")) {
             requireInput("inGrid");
@@ -82,6 +90,10 @@ struct CacheVDBGrid : zeno::INode {
         }
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
     }
 };
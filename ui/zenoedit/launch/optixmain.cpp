@@ -2,7 +2,6 @@
 #include <cstring>
 #include <iostream>
 #include <zeno/utils/log.h>
-#include <zeno/utils/Timer.h>
 #include <zeno/core/Graph.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
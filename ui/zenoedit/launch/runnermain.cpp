@@ -3,18 +3,33 @@
 #include <cstring>
 #include <iostream>
 #include <filesystem>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 #include <zeno/utils/log.h>
-#include <zeno/utils/Timer.h>
+#include <zeno/utils/Profiler.h>
 #include <zeno/core/Graph.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
+#include <zeno/extra/MemoryReport.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/extra/EventCallbacks.h>
 #include <zeno/extra/assetDir.h>
 #include <zeno/funcs/ObjectCodec.h>
+#include <zeno/utils/SharedSegment.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/Error.h>
 #include <zeno/zeno.h>
 #include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <set>
+#include <map>
+#include <QProcess>
+#include <QEventLoop>
+#include <QCoreApplication>
 #ifdef ZENO_IPC_USE_TCP
 #include <QTcpServer>
 #include <QtWidgets>
@@ -34,10 +49,9 @@ namespace {
 
 #ifdef ZENO_IPC_USE_TCP
 static std::unique_ptr<QTcpSocket> clientSocket;
-#else
-static FILE *ourfp;
-static char ourbuf[1 << 20]; // 1MB
 #endif
+static FILE *ourfp;  // pipe mode, also how batch workers talk to the runner that started them
+static char ourbuf[1 << 20]; // 1MB
 
 struct Header { // sync with viewdecode.cpp
     size_t total_size;
@@ -52,6 +66,7 @@ struct Header { // sync with viewdecode.cpp
 };
 
 static void send_packet(std::string_view info, const char *buf, size_t len) {
+    ZENO_PROFILE_SCOPE("ipc", "send_packet");
     Header header;
     header.total_size = info.size() + len;
     header.info_size = info.size();
@@ -67,25 +82,214 @@ static void send_packet(std::string_view info, const char *buf, size_t len) {
 
     zeno::log_debug("runner tx head-buffer {} data-buffer {}", headbuffer.size(), len);
 #ifdef ZENO_IPC_USE_TCP
-    for (char c: headbuffer) {
-        clientSocket->write(&c, 1);
+    if (clientSocket) {
+        clientSocket->write(headbuffer.data(), headbuffer.size());
+        if (len)
+            clientSocket->write(buf, len);
+        while (clientSocket->bytesToWrite() > 0) {
+            clientSocket->waitForBytesWritten();
+        }
+        return;
     }
-    clientSocket->write(buf, len);
-    while (clientSocket->bytesToWrite() > 0) {
-        clientSocket->waitForBytesWritten();
+#endif
+    // the log goes to the same pipe, keep its lines out of the packet
+    auto lck = zeno::lock_log_stream();
+    fwrite(headbuffer.data(), 1, headbuffer.size(), ourfp);
+    if (len)
+        fwrite(buf, 1, len, ourfp);
+    fflush(ourfp);
+}
+
+// which frames a runner computes: all of them, or every step-th one for a batch worker
+struct FrameSlice {
+    int offset = 0;
+    int step = 1;
+};
+
+// Frames of a graph without frame state (see Graph::hasFrameState) don't depend on each
+// other, so they are computed by worker runners started from here, worker k taking every
+// numWorkers-th frame from k. They write the frame cache as usual and report to us through
+// their stdout, the editor gets finishFrame from here in frame order as soon as the frames
+// before are done, like from a single runner.
+static int runner_batch(std::string const &progJson, const LAUNCH_PARAM& param, int beginFrame, int endFrame, int numWorkers) {
+    zeno::log_info("computing frames {} to {} in {} worker runners", beginFrame, endFrame, numWorkers);
+
+    // workers read one program from stdin and talk through stdout; a warm runner has
+    // its cache dir of this run sent along with the program rather than in argv
+    QStringList args = QCoreApplication::arguments().mid(1);
+    for (auto opt : {"--port", "--warm", "--cachedir"}) {
+        if (int i = args.indexOf(opt); i >= 0)
+            args.erase(args.begin() + i, args.begin() + std::min(i + 2, (int)args.size()));
     }
-#else
-    for (char c : headbuffer) {
-        fputc(c, ourfp);
+    args << "--cachedir" << param.cacheDir;
+    auto env = QProcessEnvironment::systemEnvironment();
+    int threads = std::max(1, (int)std::thread::hardware_concurrency() / numWorkers);
+    env.insert("ZENO_THREADS", QString::number(threads));
+    env.insert("OMP_NUM_THREADS", QString::number(threads));
+
+    std::vector<std::unique_ptr<QProcess>> workers;
+    zeno::scope_exit killWorkers([&] {
+        for (auto &proc : workers) {
+            if (proc->state() != QProcess::NotRunning) {
+                proc->kill();
+                proc->waitForFinished();
+            }
+        }
+    });
+    for (int k = 0; k < numWorkers; k++) {
+        auto proc = std::make_unique<QProcess>();
+        proc->setProcessEnvironment(env);
+        proc->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        proc->start(QCoreApplication::applicationFilePath(),
+                    args + QStringList{"--frames", QString::number(k) + ":" + QString::number(numWorkers)});
+        if (!proc->waitForStarted(-1)) {
+            zeno::log_error("batch worker runner failed to start");
+            return 1;
+        }
+        proc->write(progJson.data(), progJson.size());
+        proc->closeWriteChannel();
+        workers.push_back(std::move(proc));
     }
-    for (size_t i = 0; i < len; i++) {
-        fputc(buf[i], ourfp);
+
+    // sleeps until any of the workers writes or exits, rather than polling them in turn
+    QEventLoop loop;
+    for (auto &proc : workers) {
+        QObject::connect(proc.get(), &QProcess::readyReadStandardOutput, &loop, &QEventLoop::quit);
+        QObject::connect(proc.get(), QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), &loop, &QEventLoop::quit);
+    }
+
+    std::vector<std::string> received(numWorkers);
+    std::set<int> doneFrames;
+    int nextFrame = beginFrame;
+    while (nextFrame <= endFrame) {
+        bool anyRunning = false, anyOutput = false;
+        for (auto &proc : workers) {
+            anyRunning |= proc->state() != QProcess::NotRunning;
+            anyOutput |= proc->bytesAvailable() > 0;
+        }
+        if (anyRunning && !anyOutput)
+            loop.exec();
+        for (int k = 0; k < numWorkers; k++) {
+            auto &proc = workers[k];
+            auto &buf = received[k];
+            auto bytes = proc->readAllStandardOutput();
+            buf.append(bytes.constData(), bytes.size());
+
+            // log text is passed on, packets are looked into
+            size_t pos = 0;
+            while (pos < buf.size()) {
+                size_t mark = buf.find("\a\b\r\t", pos);
+                if (mark == std::string::npos) {
+                    // the end may be the start of a marker
+                    mark = buf.size();
+                    for (size_t n = 3; n > 0; n--) {
+                        if (buf.size() - pos >= n && buf.compare(buf.size() - n, n, "\a\b\r\t", n) == 0) {
+                            mark = buf.size() - n;
+                            break;
+                        }
+                    }
+                    if (mark == pos)
+                        break;
+                }
+                if (mark != pos) {
+                    std::cout.write(buf.data() + pos, mark - pos);
+                    pos = mark;
+                    continue;
+                }
+                Header header;
+                if (buf.size() - pos < 4 + sizeof(Header))
+                    break;
+                std::memcpy(&header, buf.data() + pos + 4, sizeof(Header));
+                size_t packetSize = 4 + sizeof(Header) + header.total_size;
+                if (buf.size() - pos < packetSize)
+                    break;
+                std::string_view info(buf.data() + pos + 4 + sizeof(Header), header.info_size);
+                rapidjson::Document doc;
+                doc.Parse(info.data(), info.size());
+                std::string action;
+                if (doc.IsObject() && doc.HasMember("action") && doc["action"].IsString())
+                    action = doc["action"].GetString();
+                if (action == "finishFrame" && doc.HasMember("key") && doc["key"].IsString()) {
+                    doneFrames.insert(std::stoi(doc["key"].GetString()));
+                } else if (action == "frameProfile" || action == "memoryReport") {
+                    send_packet(info, info.data() + info.size(), header.total_size - header.info_size);
+                } else if (action == "reportStatus") {
+                    send_packet(info, info.data() + info.size(), header.total_size - header.info_size);
+                    return 1;
+                }
+                pos += packetSize;
+            }
+            buf.erase(0, pos);
+        }
+        std::cout.flush();
+
+        while (doneFrames.count(nextFrame)) {
+            send_packet("{\"action\":\"newFrame\",\"key\":\"" + std::to_string(nextFrame) +"\"}", "", 0);
+            send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(nextFrame) + "\"}", "", 0);
+            doneFrames.erase(nextFrame++);
+        }
+        if (!anyRunning && nextFrame <= endFrame) {
+            zeno::log_error("batch worker runners exited before frame {} was done", nextFrame);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// the time per node of a frame, when profiling, see zeno::Profiler
+static void send_frame_profile(int frame, std::int64_t frameBegin) {
+    auto &status = *zeno::getSession().globalStatus;
+    status.frameProfile.clear();
+    for (auto const &stat : zeno::Profiler::summarize(frameBegin, "node"))
+        status.frameProfile.emplace_back(stat.name, stat.totalNs * 1e-6);
+    auto json = status.frameProfileToJson();
+    send_packet("{\"action\":\"frameProfile\",\"key\":\"" + std::to_string(frame) + "\"}", json.data(), json.size());
+}
+
+// bytes held by the node outputs and the frames in memory, see zeno::MemoryReport; also
+// written into the zencache dir, so that it's there even if the runner goes out of memory
+static void send_memory_report(int frame, zeno::Graph const *graph, const LAUNCH_PARAM& param, FrameSlice slice) {
+    zeno::MemoryReport report;
+    report.collect(graph, *zeno::getSession().globalComm);
+    auto json = report.toJson();
+    send_packet("{\"action\":\"memoryReport\",\"key\":\"" + std::to_string(frame) + "\"}", json.data(), json.size());
+    if (param.enableCache) {
+        std::string dir = param.cacheDir.toStdString() + "/" + zeno::GlobalComm::memoryReportDir;
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::u8path(dir), ec);
+        std::string path = dir + "/memory";
+        if (slice.step > 1)
+            path += "." + std::to_string(slice.offset);
+        report.save(path + ".json");
+    }
+}
+
+// big objects go through shared memory, only a small packet naming the segment is sent,
+// the editor decodes straight from there; segments are named after the editor's pid (our
+// parent) so that it can sweep those it never got to read
+static void send_view_object(std::string const &key, std::vector<char> const &buffer) {
+#ifndef _WIN32
+    static const size_t shmThreshold = zeno::envconfig::getInt("IPC_SHM_THRESHOLD", 1 << 16);
+    static size_t shmCount = 0;
+    if (zeno::SharedSegment::supported() && shmThreshold && buffer.size() >= shmThreshold) {
+        std::string name = "/zeno-view-" + std::to_string(getppid()) + "-" + std::to_string(getpid())
+                         + "-" + std::to_string(shmCount++);
+        zeno::SharedSegment segment(name, buffer.size(), true);
+        if (segment) {
+            std::memcpy(segment.data(), buffer.data(), buffer.size());
+            send_packet("{\"action\":\"viewObjectShm\",\"key\":\"" + key + "\",\"shm\":\"" + name
+                        + "\",\"size\":" + std::to_string(buffer.size()) + "}", "", 0);
+            return;
+        }
     }
-    fflush(ourfp);
 #endif
+    send_packet("{\"action\":\"viewObject\",\"key\":\"" + key + "\"}",
+        buffer.data(), buffer.size());
 }
 
-static int runner_start(std::string const &progJson, int sessionid, const LAUNCH_PARAM& param) {
+// warmGraph is kept by a warm runner between runs, see runner_main
+static int runner_start(std::string const &progJson, int sessionid, const LAUNCH_PARAM& param, FrameSlice slice,
+                        std::shared_ptr<zeno::Graph> warmGraph = nullptr) {
     zeno::log_trace("runner got program JSON: {}", progJson);
     //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
     zeno::scope_exit sp([=]() { std::cout.flush(); });
@@ -96,7 +300,7 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     session->globalState->clearState();
     session->globalComm->clearState();
     session->globalStatus->clearState();
-    auto graph = session->createGraph();
+    auto graph = warmGraph ? warmGraph : session->createGraph();
 
     //$ZSG value
     zeno::setConfigVariable("ZSG", param.zsgPath.toStdString());
@@ -115,14 +319,44 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
         zeno::getSession().globalComm->frameCache("", 0);
     }
 
+    // the frame cache is written in the background, finishFrame is only sent once it's on disk,
+    // from this thread though, as the socket belongs to it; a frame whose cache couldn't be
+    // written fails the run instead, the editor would otherwise load a missing or broken file
+    std::mutex writtenMtx;
+    std::vector<std::pair<int, bool>> writtenFrames;
+    std::map<int, std::unique_ptr<QLockFile>> cacheLocks;
+    auto reportWrittenFrames = [&] (bool waitAll) {
+        if (waitAll)
+            session->globalComm->waitFrameCacheWritten();
+        std::vector<std::pair<int, bool>> frames;
+        {
+            std::lock_guard lck(writtenMtx);
+            frames.swap(writtenFrames);
+        }
+        for (auto [frame, ok] : frames) {
+            cacheLocks.erase(frame);
+            if (ok) {
+                send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
+            } else if (!session->globalStatus->failed()) {
+                session->globalStatus->nodeName = "frame cache";
+                session->globalStatus->error = std::make_shared<zeno::Error>(
+                    "failed to write the cache of frame " + std::to_string(frame) + " to " + param.cacheDir.toStdString());
+            }
+        }
+    };
+
     auto onfail = [&] {
+        reportWrittenFrames(true);
         auto statJson = session->globalStatus->toJson();
         send_packet("{\"action\":\"reportStatus\"}", statJson.data(), statJson.size());
         return 1;
     };
 
     zeno::GraphException::catched([&] {
-        graph->loadGraph(progJson.c_str());
+        if (warmGraph)
+            graph->updateGraph(progJson.c_str());
+        else
+            graph->loadGraph(progJson.c_str());
     }, *session->globalStatus);
     if (session->globalStatus->failed())
         return onfail();
@@ -213,10 +447,29 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
         return onfail();
     }
 
+    if (slice.step == 1 && param.enableCache) {
+        int numWorkers = zeno::envconfig::getInt("RUNNER_WORKERS", 1);
+        int numFrames = graph->endFrameNumber - graph->beginFrameNumber + 1;
+        if (numWorkers > 1 && numFrames > 1) {
+            if (!graph->hasFrameState())
+                return runner_batch(progJson, param, graph->beginFrameNumber, graph->endFrameNumber, std::min(numWorkers, numFrames));
+            zeno::log_info("graph keeps state across frames, computing them in order");
+        }
+    }
+
     for (int frame = graph->beginFrameNumber; frame <= graph->endFrameNumber; frame++)
     {
+        if ((frame - graph->beginFrameNumber) % slice.step != slice.offset) {
+            // another worker's frame, GlobalComm still counts it to keep the frame indices right
+            session->globalComm->newFrame();
+            session->globalComm->finishFrame();
+            continue;
+        }
         zeno::scope_exit sp([=]() { std::cout.flush(); });
         zeno::log_debug("begin frame {}", frame);
+        std::string frameName = "frame " + std::to_string(frame);
+        ZENO_PROFILE_SCOPE("frame", frameName);
+        auto frameBegin = zeno::Profiler::now();
 
         session->globalState->frameid = frame;
         session->globalComm->newFrame();
@@ -224,14 +477,23 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
 
         while (session->globalState->substepBegin())
         {
+            reportWrittenFrames(false);
+            if (session->globalStatus->failed())
+                return onfail();
             zeno::GraphException::catched([&] {
                 graph->applyNodesToExec();
             }, *session->globalStatus);
             session->globalState->substepEnd();
+            if (zeno::MemoryReport::enabled())
+                zeno::MemoryReport::samplePeak(graph.get(), *session->globalComm);
             if (session->globalStatus->failed())
                 return onfail();
         }
         session->globalComm->finishFrame();
+        if (zeno::Profiler::enabled())
+            send_frame_profile(frame, frameBegin);
+        if (zeno::MemoryReport::enabled())
+            send_memory_report(frame, graph.get(), param, slice);
 
         zeno::log_debug("end frame {}", frame);
 
@@ -240,26 +502,33 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
         if (param.enableCache) {
             //construct cache lock.
             std::string sLockFile = param.cacheDir.toStdString() + "/" + zeno::iotags::sZencache_lockfile_prefix + std::to_string(frame) + ".lock";
-            QLockFile lckFile(QString::fromStdString(sLockFile));
-            bool ret = lckFile.tryLock();
-            //dump cache to disk.
-            session->globalComm->dumpFrameCache(frame, param.applyLightAndCameraOnly, param.applyMaterialOnly);
+            auto lckFile = std::make_unique<QLockFile>(QString::fromStdString(sLockFile));
+            bool ret = lckFile->tryLock();
+            cacheLocks.emplace(frame, std::move(lckFile));
+            //dump cache to disk, keep on with the next frame meanwhile.
+            session->globalComm->dumpFrameCache(frame, param.applyLightAndCameraOnly, param.applyMaterialOnly,
+                [&] (int frameid, bool ok) {
+                    std::lock_guard lck(writtenMtx);
+                    writtenFrames.emplace_back(frameid, ok);
+                });
+            reportWrittenFrames(false);
         } else {
             auto const& viewObjs = session->globalComm->getViewObjects();
             zeno::log_debug("runner got {} view objects", viewObjs.size());
             for (auto const& [key, obj] : viewObjs) {
                 if (zeno::encodeObject(obj.get(), buffer))
-                    send_packet("{\"action\":\"viewObject\",\"key\":\"" + key + "\"}",
-                        buffer.data(), buffer.size());
+                    send_view_object(key, buffer);
                 buffer.clear();
             }
+            send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
         }
 
-        send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
-
         if (session->globalStatus->failed())
             return onfail();
     }
+    reportWrittenFrames(true);
+    if (session->globalStatus->failed())
+        return onfail();
     return 0;
 }
 
@@ -291,6 +560,8 @@ int runner_main(const QCoreApplication& app) {
         {"projectFps", "current project fps", "fps"},
         {"objcachedir", "objcachedir", "obj temp cache dir"},
         {"generator", "generator", "the node ident which trigger generate command"},
+        {"frames", "frames", "batch worker: compute every <step>th frame from <offset>, as offset:step"},
+        {"warm", "warm", "keep running, read one program after another from stdin"},
         });
     cmdParser.process(app);
     if (cmdParser.isSet("sessionid"))
@@ -317,21 +588,37 @@ int runner_main(const QCoreApplication& app) {
         param.projectFps = cmdParser.value("projectFps").toInt();
     if (cmdParser.isSet("generator"))
         param.generator = cmdParser.value("generator");
+    bool warm = cmdParser.isSet("warm") && cmdParser.value("warm").toInt();
+    FrameSlice slice;
+    if (cmdParser.isSet("frames")) {
+        auto parts = cmdParser.value("frames").split(':');
+        if (parts.size() == 2 && parts[1].toInt() > 0) {
+            slice.offset = parts[0].toInt();
+            slice.step = parts[1].toInt();
+        }
+    }
 
     std::cerr.rdbuf(std::cout.rdbuf());
     std::clog.rdbuf(std::cout.rdbuf());
 
     zeno::set_log_stream(std::clog);
+    // node threads shouldn't wait on the pipe to log
+    zeno::set_log_async(true);
 
 #ifdef ZENO_IPC_USE_TCP
-    zeno::log_debug("connecting to port {}", port);
-    clientSocket = std::make_unique<QTcpSocket>();
-    clientSocket->connectToHost(QHostAddress::LocalHost, port);
-    if (!clientSocket->waitForConnected(10000)) {
-        zeno::log_error("tcp client connection fail");
-        return 0;
+    if (slice.step > 1) {
+        zeno::log_debug("started as batch worker");
+        ourfp = stdout;
     } else {
-        zeno::log_info("tcp connection succeed");
+        zeno::log_debug("connecting to port {}", port);
+        clientSocket = std::make_unique<QTcpSocket>();
+        clientSocket->connectToHost(QHostAddress::LocalHost, port);
+        if (!clientSocket->waitForConnected(10000)) {
+            zeno::log_error("tcp client connection fail");
+            return 0;
+        } else {
+            zeno::log_info("tcp connection succeed");
+        }
     }
 #else
     zeno::log_debug("started IPC in pipe mode");
@@ -340,12 +627,6 @@ int runner_main(const QCoreApplication& app) {
 
     zeno::log_debug("runner started on sessionid={}", sessionid);
 
-    std::string progJson;
-    std::istreambuf_iterator<char> iit(std::cin.rdbuf()), eiit;
-    std::back_insert_iterator<std::string> sit(progJson);
-    std::copy(iit, eiit, sit);
-
-
 #ifdef ZENO_IPC_USE_TCP
     // Notify this is runner process
     static int calledOnce = ([]{
@@ -353,6 +634,34 @@ int runner_main(const QCoreApplication& app) {
     }(), 0);
 #endif
 
-    return runner_start(progJson, sessionid, param);
+    if (warm) {
+        // The session, node classes and graph live on between runs, so nodes whose commands
+        // didn't change are kept with what they cache (see Graph::updateGraph). Each program
+        // comes as its size in bytes on a line, the cache dir of this run on the next,
+        // then the JSON; runFinished tells the editor we are ready for the next one.
+        auto graph = zeno::getSession().createGraph();
+        std::string line, cachedir;
+        while (std::getline(std::cin, line) && std::getline(std::cin, cachedir)) {
+            size_t size = std::strtoull(line.c_str(), nullptr, 10);
+            std::string progJson(size, '\0');
+            if (!std::cin.read(progJson.data(), size))
+                break;
+            LAUNCH_PARAM runParam = param;
+            runParam.cacheDir = QString::fromStdString(cachedir);
+            runner_start(progJson, sessionid, runParam, slice, graph);
+            send_packet("{\"action\":\"runFinished\"}", "", 0);
+        }
+        return 0;
+    }
+
+    std::string progJson;
+    {
+        // read stdin in blocks, one character at a time is slow for large graphs
+        std::vector<char> buf(1 << 16);
+        while (std::cin.read(buf.data(), buf.size()) || std::cin.gcount())
+            progJson.append(buf.data(), std::cin.gcount());
+    }
+
+    return runner_start(progJson, sessionid, param, slice);
 }
 #endif
@@ -9,7 +9,9 @@
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
+#include <zeno/extra/MemoryReport.h>
 #include <zeno/funcs/ObjectCodec.h>
+#include <zeno/utils/SharedSegment.h>
 #ifdef ZENO_WITH_UnrealBridge
 #include "unrealhook.h"
 #endif
@@ -19,6 +21,9 @@
 #include <cassert>
 #include <vector>
 #include <string>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 #include "launch/corelaunch.h"
 #include "settings/zsettings.h"
 #include "launch/ztcpserver.h"
@@ -53,10 +58,18 @@ struct PacketProc {
     }
 
     void onFinish() {
+        removeSharedSegments();
         clearGlobalIfNeeded();
         zeno::getSession().globalState->working = false;
     }
 
+    // those of a runner that crashed or was killed before we read them
+    void removeSharedSegments() {
+#ifndef _WIN32
+        zeno::SharedSegment::removeAll("/zeno-view-" + std::to_string(getpid()) + "-");
+#endif
+    }
+
     void clearGlobalIfNeeded() {
         if (globalCommNeedClean) {
             //zeno::log_debug("PacketProc::clearGlobalStateIfNeeded: globalStateNeedClean");
@@ -178,6 +191,27 @@ struct PacketProc {
                 }
             }
 
+        } else if (action == "frameProfile") {
+            auto &stat = *zeno::getSession().globalStatus;
+            stat.frameProfileFromJson({buf, len});
+            std::string top;
+            for (size_t i = 0; i < stat.frameProfile.size() && i < 5; i++)
+                top += zeno::format(" {} {:.2f}ms", stat.frameProfile[i].first, stat.frameProfile[i].second);
+            zeno::log_info("frame {} slowest nodes:{}", objKey, top);
+
+        } else if (action == "memoryReport") {
+            zeno::MemoryReport report;
+            report.fromJson({buf, len});
+            std::string top;
+            for (size_t i = 0; i < report.nodes.size() && i < 5; i++)
+                top += zeno::format(" {} {:.1f}MB", report.nodes[i].first, report.nodes[i].second / 1048576.0);
+            zeno::log_info("frame {} resident {:.1f}MB, largest nodes:{}", objKey, report.residentBytes / 1048576.0, top);
+
+        } else if (action == "runFinished") {
+            // a warm runner is done and waits for the next program, finish outside of the decoding
+            if (auto tcpServer = zenoApp->getServer())
+                QMetaObject::invokeMethod(tcpServer, "onRunnerIdle", Qt::QueuedConnection);
+
         } else if (action == "reportStatus") {
             std::string statJson{buf, len};
             zeno::getSession().globalStatus->fromJson(statJson);
@@ -232,6 +266,19 @@ struct PacketProc {
 
         zeno::log_debug("decoder got action=[{}] key=[{}] size={}", action, objKey, size);
 
+        if (action == "viewObjectShm") {
+            auto itName = root.FindMember("shm"), itSize = root.FindMember("size");
+            if (itName == root.MemberEnd() || !itName->value.IsString()
+                || itSize == root.MemberEnd() || !itSize->value.IsUint64()) {
+                zeno::log_warn("viewObjectShm without segment");
+                return false;
+            }
+            // decoded right from the runner's pages, unmapped (and freed) once done
+            zeno::SharedSegment segment(itName->value.GetString(), itSize->value.GetUint64(), false);
+            if (!segment)
+                return false;
+            return processPacket("viewObject", objKey, segment.data(), segment.size());
+        }
         return processPacket(action, objKey, data, size);
     }
 
@@ -5,6 +5,7 @@
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/utils/log.h>
+#include <zeno/utils/envconfig.h>
 #include <QMessageBox>
 #include <zeno/zeno.h>
 #include "launch/viewdecode.h"
@@ -69,7 +70,9 @@ void ZTcpServer::init(const QHostAddress& address)
 void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
 {
     ZASSERT_EXIT(m_tcpServer);
-    if (m_proc && m_proc->isOpen())
+    // a warm runner stays alive after a run and takes the next program, see runner_main
+    bool warm = zeno::envconfig::getBool("WARM_RUNNER");
+    if (m_proc && m_proc->isOpen() && (!warm || m_runnerBusy))
     {
         zeno::log_info("background process already running");
         return;
@@ -78,10 +81,6 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
     zeno::log_info("launching program...");
     zeno::log_debug("program JSON: {}", progJson);
 
-    m_proc = std::make_unique<QProcess>();
-    m_proc->setInputChannelMode(QProcess::InputChannelMode::ManagedInputChannel);
-    m_proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
-    m_proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
     int sessionid = zeno::getSession().globalState->sessionid;
 
     QString cachedir;
@@ -130,9 +129,52 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
         "--zsg", param.zsgPath,
         "--projectFps", QString::number(param.projectFps),
         "--objcachedir", zenoApp->cacheMgr()->objCachePath(),
-        "--generator", param.generator
+        "--generator", param.generator,
+        "--warm", QString::number(warm),
     };
 
+    // the cache dir is a new temp dir on every run, a warm runner gets it along with each
+    // program instead, so it doesn't count as a different setting
+    auto settingsOf = [] (QStringList args) {
+        int i = args.indexOf("--cachedir");
+        if (i >= 0)
+            args.erase(args.begin() + i, args.begin() + i + 2);
+        return args;
+    };
+
+    auto sendProgram = [&] {
+        QByteArray head = QByteArray::number((qulonglong)progJson.size()) + '\n' + cachedir.toUtf8() + '\n';
+        m_proc->write(head);
+        m_proc->write(progJson.data(), progJson.size());
+        m_runnerBusy = true;
+    };
+
+    if (warm && m_proc && m_proc->isOpen())
+    {
+        if (settingsOf(args) == m_procArgs)
+        {
+            zeno::log_info("reusing warm runner");
+            viewDecodeClear();
+            sendProgram();
+            if (ZenoMainWindow* mainwin = zenoApp->getMainWindow())
+                emit zenoApp->getMainWindow()->runStarted();
+#ifdef ZENO_OPTIX_PROC
+            sendCacheRenderInfoToOptix(cachedir, param.cacheNum, param.applyLightAndCameraOnly, param.applyMaterialOnly);
+#endif
+            return;
+        }
+        // started with other settings
+        disconnect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
+        disconnect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
+        m_proc->kill();
+        m_proc->waitForFinished(-1);
+    }
+
+    m_proc = std::make_unique<QProcess>();
+    m_proc->setInputChannelMode(QProcess::InputChannelMode::ManagedInputChannel);
+    m_proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
+    m_proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
+    m_procArgs = settingsOf(args);
     m_proc->start(QCoreApplication::applicationFilePath(), args);
 
     if (!m_proc->waitForStarted(-1)) {
@@ -140,8 +182,12 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
         return;
     }
 
-    m_proc->write(progJson.data(), progJson.size());
-    m_proc->closeWriteChannel();
+    if (warm) {
+        sendProgram();
+    } else {
+        m_proc->write(progJson.data(), progJson.size());
+        m_proc->closeWriteChannel();
+    }
 
     connect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
     connect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
@@ -348,6 +394,7 @@ void ZTcpServer::killProc()
         m_proc->kill();
         m_proc = nullptr;
     }
+    m_runnerBusy = false;
 }
 
 void ZTcpServer::onNewConnection()
@@ -418,8 +465,21 @@ void ZTcpServer::onDisconnect()
     viewDecodeFinish();
 }
 
+void ZTcpServer::onRunnerIdle()
+{
+    m_runnerBusy = false;
+    viewDecodeFinish();
+
+    auto mainWin = zenoApp->getMainWindow();
+    if (mainWin)
+        emit mainWin->runFinished();
+    else
+        emit runFinished();
+}
+
 void ZTcpServer::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    m_runnerBusy = false;
     if (exitStatus == QProcess::NormalExit)
     {
         if (m_proc)
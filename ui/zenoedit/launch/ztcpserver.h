@@ -36,6 +36,7 @@ private slots:
     void onProcPipeReady();
     void onDisconnect();
     void onProcFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onRunnerIdle();
 
 private:
     void sendCacheRenderInfoToOptix(const QString& finalCachePath, int cacheNum, bool applyLightAndCameraOnly, bool applyMaterialOnly);
@@ -47,6 +48,8 @@ private:
     QLocalServer* m_optixServer;
     QVector<QLocalSocket*> m_optixSockets;
     std::unique_ptr<QProcess> m_proc;
+    QStringList m_procArgs;
+    bool m_runnerBusy = false;  // a warm runner is computing, see ZENO_WARM_RUNNER
 
     std::vector<std::unique_ptr<QProcess>> m_optixProcs;
     int m_port;
@@ -295,6 +295,26 @@ QVariant attrData(const zeno::AttrVector<T> &attr, const QModelIndex& modelIndex
             return v[index.elementIndex];
         }
     }
+    else if (attr.template attr_is<zeno::half>(attr_name)) {
+        return float(attr.template attr<zeno::half>(attr_name).at(row));
+    }
+    else if (attr.template attr_is<uint8_t>(attr_name)) {
+        return int(attr.template attr<uint8_t>(attr_name).at(row));
+    }
+    else if (attr.template attr_is<zeno::vec4C>(attr_name)) {
+        auto v = attr.template attr<zeno::vec4C>(attr_name).at(row);
+        return int(v[index.elementIndex]);
+    }
+    else if (attr.template attr_is<int64_t>(attr_name)) {
+        return qlonglong(attr.template attr<int64_t>(attr_name).at(row));
+    }
+    else if (attr.template attr_is<double>(attr_name)) {
+        return attr.template attr<double>(attr_name).at(row);
+    }
+    else if (attr.template attr_is<zeno::vec3d>(attr_name)) {
+        auto v = attr.template attr<zeno::vec3d>(attr_name).at(row);
+        return v[index.elementIndex];
+    }
     else {
         return QVariant();
     }
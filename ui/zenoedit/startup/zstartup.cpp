@@ -145,9 +145,6 @@ void verifyVersion()
 #endif
 #if defined(ZENO_ENABLE_BACKWARD)
                    "+bt"
-#endif
-#if defined(ZENO_BENCHMARKING)
-                   "+tm"
 #endif
                    ;
     // TODO: luzh, may check the internet latest version and compare, if not latest hint the user to update..
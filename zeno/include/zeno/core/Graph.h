@@ -8,6 +8,7 @@
 #include <variant>
 #include <memory>
 #include <string>
+#include <vector>
 #include <set>
 #include <any>
 #include <map>
@@ -17,13 +18,33 @@ namespace zeno {
 struct Session;
 struct SubgraphNode;
 struct DirtyChecker;
+struct EvalCache;
+struct GraphScheduler;
 struct INode;
 
 struct Context {
-    std::set<std::string> visited;
+    std::vector<bool> visited;  // by INode::nodeIndex, cheap to copy for each loop iteration
+
+    inline bool isVisited(int index) const {
+        return index < (int)visited.size() && visited[index];
+    }
+
+    // returns false if it was visited already
+    inline bool markVisited(int index) {
+        if (index >= (int)visited.size())
+            visited.resize(index + 1);
+        if (visited[index])
+            return false;
+        visited[index] = true;
+        return true;
+    }
 
     inline void mergeVisited(Context const &other) {
-        visited.insert(other.visited.begin(), other.visited.end());
+        if (visited.size() < other.visited.size())
+            visited.resize(other.visited.size());
+        for (size_t i = 0; i < other.visited.size(); i++)
+            if (other.visited[i])
+                visited[i] = true;
     }
 
     ZENO_API Context();
@@ -36,6 +57,9 @@ struct Graph : std::enable_shared_from_this<Graph> {
     SubgraphNode *subgraphNode = nullptr;
 
     std::map<std::string, std::unique_ptr<INode>> nodes;
+    std::vector<INode *> nodeList;  // by INode::nodeIndex
+    std::vector<int> freeNodeIndices;  // null slots in nodeList, reused by addNode
+    bool linksChanged = true;  // INode::inputLinks are out of date, see compileLinks
     std::set<std::string> nodesToExec;
     int beginFrameNumber = 0, endFrameNumber = 0;  // only use by runnermain.cpp
 
@@ -43,9 +67,14 @@ struct Graph : std::enable_shared_from_this<Graph> {
     std::map<std::string, zany> portals;
     std::map<std::string, std::string> subInputNodes;
     std::map<std::string, std::string> subOutputNodes;
+    std::map<std::string, std::string> loadedSources;  // the commands each node was loaded by, see updateGraph
 
     std::unique_ptr<Context> ctx;
     std::unique_ptr<DirtyChecker> dirtyChecker;
+    std::unique_ptr<EvalCache> evalCache;  // reuses outputs of unchanged pure nodes, null if disabled
+
+    bool parallelApply = false;  // evaluate applyNodes as a DAG on Session::threadPool
+    GraphScheduler *scheduler = nullptr;  // only valid during a parallel applyNodes
 
     ZENO_API Graph();
     ZENO_API ~Graph();
@@ -60,9 +89,12 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API void applyNodesToExec();
     ZENO_API void applyNodes(std::set<std::string> const &ids);
     ZENO_API void addNode(std::string const &cls, std::string const &id);
+    ZENO_API void removeNode(std::string const &id);
     ZENO_API Graph *addSubnetNode(std::string const &id);
     ZENO_API Graph *getSubnetGraph(std::string const &id) const;
     ZENO_API bool applyNode(std::string const &id);
+    ZENO_API bool applyNode(INode *node);
+    ZENO_API void compileLinks();
     ZENO_API void completeNode(std::string const &id);
     ZENO_API void bindNodeInput(std::string const &dn, std::string const &ds,
         std::string const &sn, std::string const &ss);
@@ -74,6 +106,10 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API zany const &getNodeOutput(std::string const &sn, std::string const &ss) const;
     ZENO_API zany getNodeInput(std::string const &sn, std::string const &ss) const;
     ZENO_API void loadGraph(const char *json);
+    // loads a program into a graph that already ran an earlier one, keeping the nodes whose
+    // commands didn't change (with whatever they cache, see INode::resetFrameState) and
+    // loading the others anew
+    ZENO_API void updateGraph(const char *json);
     ZENO_API void setNodeParam(std::string const &id, std::string const &par,
         std::variant<int, float, std::string, zany> const &val);  /* to be deprecated */
     ZENO_API std::map<std::string, zany> callSubnetNode(std::string const &id,
@@ -82,6 +118,12 @@ struct Graph : std::enable_shared_from_this<Graph> {
             std::map<std::string, zany> inputs) const;
     ZENO_API void setTempCache(std::string const& id);
     ZENO_API INode* getNode(std::string const& id);
+    // whether a frame may depend on the previous ones, unless every node is INode::isFrameIndependent;
+    // otherwise frames can be computed in any order
+    ZENO_API bool hasFrameState() const;
+
+private:
+    int allocNodeIndex();
 };
 
 }
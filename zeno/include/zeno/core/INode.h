@@ -7,6 +7,7 @@
 #include <variant>
 #include <memory>
 #include <string>
+#include <vector>
 #include <set>
 #include <map>
 #include <zeno/types/CurveObject.h>
@@ -27,7 +28,17 @@ public:
     INodeClass *nodeClass = nullptr;
 
     std::string myname;
+    int nodeIndex = -1;  // in Graph::nodeList, -1 if not added to a graph
     std::map<std::string, std::pair<std::string, std::string>> inputBounds;
+
+    // inputBounds in the same order with the source nodes looked up, see Graph::compileLinks
+    struct InputLink {
+        std::string const *socket;
+        std::pair<std::string, std::string> const *bound;
+        INode *source;  // null if there is no such node
+    };
+    std::vector<InputLink> inputLinks;
+
     std::map<std::string, zany> inputs;
     std::map<std::string, zany> outputs;
     std::set<std::string> kframes;
@@ -55,11 +66,24 @@ protected:
     ZENO_API virtual void complete();
     ZENO_API virtual void apply() = 0;
 
+    bool requireLink(InputLink const &link);
+
 public:
     ZENO_API bool requireInput(std::string const &ds);
 
     ZENO_API virtual void preApply();
 
+    // scheduling hints for parallel Graph::applyNodes, see GraphScheduler
+    ZENO_API virtual bool hasLazyInputs() const;  // preApply may skip or repeat requireInput
+    ZENO_API virtual bool isThreadSafe() const;   // apply may run concurrently with other nodes
+
+    // memoization hint, see EvalCache
+    ZENO_API virtual bool isPure() const;  // outputs depend only on inputs, apply has no side effects
+
+    // batch hint, see Graph::hasFrameState; nodes keeping state across frames (caches, solvers) return false
+    ZENO_API virtual bool isFrameIndependent() const;  // outputs don't depend on the frames computed before
+    ZENO_API virtual void resetFrameState();  // forget the frames computed before, as a kept graph runs again, see Graph::updateGraph
+
     ZENO_API Graph *getThisGraph() const;
     ZENO_API Session *getThisSession() const;
     ZENO_API GlobalState *getGlobalState() const;
@@ -74,9 +98,24 @@ public:
     ZENO_API bool has_formula(std::string const &id) const;
     ZENO_API zany get_formula(std::string const &id) const;
 
+    // keyframes and formulas only depend on time, so each is evaluated once per substep;
+    // formulas with ref() are evaluated every time, only their compiled code is kept
+    struct EvaluatedInput {
+        zany source;  // the curve or formula string the value came from
+        int frameid = 0;
+        int substepid = 0;
+        float frame_time_elapsed = 0;
+        zany value;
+        zany formula;  // compiled by the eval node from the formula text, passed to it again next time
+    };
+    mutable std::map<std::string, EvaluatedInput> evaluatedInputs;
+
+    // the error messages are only formatted on failure, these are called a lot
     template <class T>
     std::shared_ptr<T> get_input(std::string const &id) const {
         auto obj = get_input(id);
+        if (auto p = std::dynamic_pointer_cast<T>(obj))
+            return p;
         return safe_dynamic_cast<T>(std::move(obj), "input socket `" + id + "` of node `" + myname + "`");
     }
 
@@ -95,7 +134,10 @@ public:
 
     template <class T>
     auto get_input2(std::string const &id) const {
-        return objectToLiterial<T>(get_input(id), "input socket `" + id + "` of node `" + myname + "`");
+        auto obj = get_input(id);
+        if (!objectIsLiterial<T>(obj))
+            return objectToLiterial<T>(obj, "input socket `" + id + "` of node `" + myname + "`");
+        return objectToLiterial<T>(obj);
     }
 
     template <class T>
@@ -26,6 +26,7 @@ struct GlobalState;
 struct GlobalComm;
 struct GlobalStatus;
 struct EventCallbacks;
+struct ThreadPool;
 struct UserData;
 
 struct Session {
@@ -36,6 +37,7 @@ struct Session {
     std::unique_ptr<GlobalStatus> const globalStatus;
     std::unique_ptr<EventCallbacks> const eventCallbacks;
     std::unique_ptr<UserData> const m_userData;
+    std::unique_ptr<ThreadPool> const threadPool;
 
     ZENO_API Session();
     ZENO_API ~Session();
@@ -46,6 +48,9 @@ struct Session {
     Session &operator=(Session &&) = delete;
 
     ZENO_API UserData &userData() const;
+    // sizes the thread pool that nodes, zeno/para and OpenMP share, 0 for all cores,
+    // libraries with their own pool (TBB) follow through the threadsConfigured event
+    ZENO_API void setThreads(std::size_t numThreads, bool pinThreads = false);
     ZENO_API std::shared_ptr<Graph> createGraph();
     ZENO_API std::string dumpDescriptors() const;
     ZENO_API std::string dumpDescriptorsJSON() const;
@@ -57,6 +57,12 @@ enum Zeno_PrimDataType {
     Zeno_PrimDataType_vec2i,
     Zeno_PrimDataType_vec4f,
     Zeno_PrimDataType_vec4i,
+    Zeno_PrimDataType_half,
+    Zeno_PrimDataType_uint8,
+    Zeno_PrimDataType_vec4u8,
+    Zeno_PrimDataType_int64,
+    Zeno_PrimDataType_double,
+    Zeno_PrimDataType_vec3d,
 };
 
 ZENO_CAPI Zeno_Error Zeno_GetLastError(const char **msgRet_) ZENO_CAPI_NOEXCEPT;
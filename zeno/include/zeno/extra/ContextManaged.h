@@ -12,6 +12,11 @@ struct ContextManagedNode : INode {
     std::unique_ptr<Context> m_ctx = nullptr;
     bool bNewContext = false;
 
+    // swaps graph->ctx and re-pulls its upstream, never schedule ahead of it
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     void push_context() {
         assert(!m_ctx);
         m_ctx = std::move(graph->ctx);
@@ -5,19 +5,23 @@
 #include <zeno/utils/safe_dynamic_cast.h>
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/types/UserData.h>
-#include <set>
 #include <string>
+#include <mutex>
+#include <set>
 
 namespace zeno {
 
 struct DirtyChecker {
     std::set<std::string> dirts;
+    mutable std::mutex mtx;  // nodes may taint concurrently under parallel applyNodes
 
     void taintThisNode(std::string ident) {
+        std::lock_guard lck(mtx);
         dirts.insert(std::move(ident));
     }
 
     bool amIDirty(std::string const &ident) const {
+        std::lock_guard lck(mtx);
         return dirts.find(ident) != dirts.end();
     }
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/core/IObject.h>
+#include <optional>
+#include <cstdint>
+#include <string>
+#include <mutex>
+#include <map>
+
+namespace zeno {
+
+struct Graph;
+struct INode;
+
+/* content-addressed memoization of node outputs:
+ *
+ * the hash of a node covers its class, its literal inputs (keyframes and
+ * formulas evaluated at the current frame) and the hashes of its upstream
+ * nodes; a pure node (see INode::isPure) whose hash didn't change since it
+ * was last applied gets its previous outputs back instead of being applied
+ * again, no matter which frame or which applyNodes it was in; the outputs are
+ * kept as they are, and copied for each node taking them as input.
+ *
+ * nodes that are not pure, or have inputs we can't hash, are not content
+ * addressable, neither is anything downstream of them.
+ */
+struct EvalCache {
+    struct Entry {
+        uint64_t hash = 0;
+        std::map<std::string, zany> outputs;
+    };
+
+private:
+    Graph *m_graph;
+
+    std::mutex m_mtx;
+    std::map<std::string, Entry> m_entries;
+    std::map<std::string, std::optional<uint64_t>> m_hashes;  // valid during one applyNodes
+
+    std::optional<uint64_t> computeHash(INode *node);
+
+public:
+    ZENO_API explicit EvalCache(Graph *graph);
+    ZENO_API ~EvalCache();
+
+    EvalCache(EvalCache const &) = delete;
+    EvalCache &operator=(EvalCache const &) = delete;
+
+    // forget per-run hashes, inputs and frame may have changed since last applyNodes
+    ZENO_API void beginApply();
+    ZENO_API void clear();
+    ZENO_API void forget(std::string const &id);  // the node was removed
+
+    // nullopt if the node is not content addressable
+    ZENO_API std::optional<uint64_t> nodeHash(std::string const &id);
+
+    ZENO_API bool tryRestore(INode *node);
+    ZENO_API void store(INode *node);
+
+    // obj is an output of node id kept here, so whoever takes it as input must get a
+    // copy of it (cheap, the arrays are copy-on-write) and leave it as it is
+    ZENO_API bool isCachedOutput(std::string const &id, IObject const *obj);
+};
+
+}
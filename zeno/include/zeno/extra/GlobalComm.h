@@ -5,7 +5,10 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <condition_variable>
+#include <unordered_set>
 #include <mutex>
+#include <list>
 #include <map>
 #include <set>
 #include <functional>
@@ -14,6 +17,8 @@ namespace zeno {
 
 struct GlobalComm {
     using ViewObjects = PolymorphicMap<std::map<std::string, std::shared_ptr<IObject>>>;
+    using KeyFilter = std::function<bool(std::string const &key)>;
+    using CacheWrittenCallback = std::function<void(int frameid, bool ok)>;
 
     enum FRAME_STATE {
         FRAME_UNFINISH,
@@ -24,23 +29,40 @@ struct GlobalComm {
     struct FrameData {
         ViewObjects view_objects;
         FRAME_STATE frame_state = FRAME_UNFINISH;
+        size_t memoryBytes = 0;      // of view_objects, as of when they were last in memory
+        size_t peakMemoryBytes = 0;  // see updatePeakMemory
     };
     std::vector<FrameData> m_frames;
     int m_maxPlayFrame = 0;
     std::set<int> m_inCacheFrames;
+    std::list<int> m_lruFrames;  // the m_inCacheFrames, most recently viewed first
+    std::set<int> m_writingFrames;
     mutable std::mutex m_mtx;
 
     int beginFrameNumber = 0;
     int endFrameNumber = 0;
     int maxCachedFrames = 1;
+    // frames loaded back from the cache are evicted by bytes rather than by maxCachedFrames
+    // if set, from ZENO_FRAME_CACHE_MB by default
+    size_t maxCachedBytes = 0;
+    // frames read ahead of playback, kept on top of maxCachedFrames, from ZENO_FRAME_PREFETCH (default 2)
+    int maxPrefetchFrames = 2;
     std::string cacheFramePath;
     std::string objTmpCachePath;
+    // subdirectory of cacheFramePath the runners write their memory reports to, see
+    // MemoryReport; removed with the last frame by removeCache
+    static constexpr const char *memoryReportDir = "memory";
+
+    ZENO_API GlobalComm();
+    ZENO_API ~GlobalComm();
 
     ZENO_API void frameCache(std::string const &path, int gcmax);
     ZENO_API void initFrameRange(int beg, int end);
     ZENO_API void newFrame();
     ZENO_API void finishFrame();
-    ZENO_API void dumpFrameCache(int frameid, bool cacheLightCameraOnly = false, bool cacheMaterialOnly = false);
+    // encoded and written in the background, onWritten is called from the writer thread in frame order
+    ZENO_API void dumpFrameCache(int frameid, bool cacheLightCameraOnly = false, bool cacheMaterialOnly = false, CacheWrittenCallback onWritten = {});
+    ZENO_API void waitFrameCacheWritten();
     ZENO_API void addViewObject(std::string const &key, std::shared_ptr<IObject> object);
     ZENO_API int maxPlayFrames();
     ZENO_API int numOfFinishedFrame();
@@ -53,17 +75,43 @@ struct GlobalComm {
     ZENO_API bool load_objects(const int frameid, 
                 const std::function<bool(std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs)>& cb,
                 bool& isFrameValid);
+    // the objects not accepted by filter are passed as nullptr
+    ZENO_API bool load_objects(const int frameid, KeyFilter const &filter,
+                const std::function<bool(std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs)>& cb,
+                bool& isFrameValid);
     ZENO_API bool isFrameCompleted(int frameid) const;
     ZENO_API FRAME_STATE getFrameState(int frameid) const;
     ZENO_API bool isFrameBroken(int frameid) const;
     ZENO_API int maxCachedFramesNum();
     ZENO_API std::string cachePath();
     ZENO_API bool removeCache(int frame);
+    // bytes of the view objects of the frames in memory, not counting the objects already
+    // in visited (node outputs, usually), see objectMemoryBytes
+    ZENO_API size_t residentMemoryBytes(std::unordered_set<void const *> &visited) const;
+    ZENO_API size_t frameMemoryBytes(int frameid) const;
+    // keeps the largest bytes as the high-water mark of the frame being computed
+    ZENO_API void updatePeakMemory(size_t bytes);
     ZENO_API void removeCachePath();
     static void toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName = "");
-    static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, std::string fileName = "");
+    static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, std::string fileName = "", KeyFilter const &filter = {});
 private:
-    ViewObjects const *_getViewObjects(const int frameid);
+    struct CacheWriter;
+    struct FramePrefetcher;
+
+    std::set<int> m_loadingFrames;
+    std::condition_variable m_loadedCv;
+    size_t m_cachedBytes = 0;  // of the m_lruFrames
+    unsigned m_generation = 0;  // frames loaded before a clear are dropped
+    int m_lastViewedFrame = 0;
+
+    std::unique_ptr<CacheWriter> m_cacheWriter;
+    std::unique_ptr<FramePrefetcher> m_prefetcher;
+
+    ViewObjects const *_getViewObjects(std::unique_lock<std::mutex> &lck, const int frameid);
+    bool _loadFrame(std::unique_lock<std::mutex> &lck, int frameid, bool prefetch);
+    void _evictFrames();
+    void _prefetchAhead(int frameid);
+    void _clearCachedFrames();
 };
 
 }
@@ -4,6 +4,8 @@
 #include <string_view>
 #include <string>
 #include <memory>
+#include <vector>
+#include <utility>
 
 namespace zeno {
 
@@ -12,6 +14,8 @@ struct INode;
 struct GlobalStatus {
     std::string nodeName;
     std::shared_ptr<Error> error;
+    // time spent in each node during the last frame, slowest first, only when profiling, see Profiler
+    std::vector<std::pair<std::string, double>> frameProfile;  // node name, milliseconds
 
     bool failed() const {
         return !nodeName.empty();
@@ -20,6 +24,8 @@ struct GlobalStatus {
     ZENO_API void clearState();
     ZENO_API std::string toJson() const;
     ZENO_API void fromJson(std::string_view json);
+    ZENO_API std::string frameProfileToJson() const;
+    ZENO_API void frameProfileFromJson(std::string_view json);
 };
 
 }
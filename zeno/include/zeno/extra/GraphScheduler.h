@@ -0,0 +1,84 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <condition_variable>
+#include <exception>
+#include <optional>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <set>
+
+namespace zeno {
+
+struct Graph;
+struct INode;
+struct ThreadPool;
+
+/* evaluates Graph::applyNodes as a dependency DAG on a thread pool:
+ *
+ * - nodes with lazy inputs (control flow, caches, see INode::hasLazyInputs)
+ *   and everything upstream of them are kept out of the DAG, the outermost
+ *   of them are applied by the legacy recursive pull on the calling thread;
+ * - nodes that are not thread-safe (see INode::isThreadSafe) are applied on
+ *   the calling thread only while no worker is busy, in node name order;
+ * - all other nodes are applied on the pool as soon as their inputs are ready.
+ */
+struct GraphScheduler {
+    enum class Kind {
+        Parallel,
+        Serial,
+        Frontier,
+    };
+
+    enum State : int {
+        Pending,
+        Running,
+        Done,
+        Failed,
+    };
+
+    struct Task {
+        INode *node = nullptr;
+        Kind kind = Kind::Parallel;
+        int numDeps = 0;
+        std::vector<int> dependents;
+    };
+
+private:
+    Graph *m_graph;
+    ThreadPool *m_pool;
+
+    std::vector<Task> m_tasks;
+    std::vector<std::atomic<int>> m_states;
+    std::vector<int> m_lut;  // by INode::nodeIndex, -1 if not managed by us
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::set<int> m_serialReady;
+    std::exception_ptr m_error;
+    int m_inflight = 0;
+
+    void makeReady(int i);
+    void finish(int i);
+    bool execute(int i);
+    void runTask(int i);
+    bool isDirty(INode *node) const;
+
+public:
+    ZENO_API GraphScheduler(Graph *graph, ThreadPool *pool);
+    ZENO_API ~GraphScheduler();
+
+    GraphScheduler(GraphScheduler const &) = delete;
+    GraphScheduler &operator=(GraphScheduler const &) = delete;
+
+    // returns false when the graph has cycles and can't be scheduled
+    ZENO_API bool plan(std::set<std::string> const &ids);
+    ZENO_API void run();
+
+    // called by Graph::applyNode, nullopt if the node is not managed by us
+    ZENO_API std::optional<bool> applyPlannedNode(INode *node);
+};
+
+}
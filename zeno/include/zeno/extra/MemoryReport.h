@@ -0,0 +1,41 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <string_view>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace zeno {
+
+struct Graph;
+struct GlobalComm;
+
+// resident bytes of the node outputs and of the frames kept by GlobalComm, see
+// objectMemoryBytes; enabled by ZENO_MEMORY_REPORT, the runner then sends one after
+// each frame and writes it beside the zencache as memory.json
+struct MemoryReport {
+    struct Frame {
+        int frameid = 0;
+        size_t bytes = 0;      // view objects, as of when the frame was last in memory
+        size_t peakBytes = 0;  // high-water mark of node outputs and frames in memory while computing it
+        bool inMemory = false;
+        bool inCache = false;  // loaded back from the zencache, in GlobalComm::m_inCacheFrames
+    };
+
+    std::vector<std::pair<std::string, size_t>> nodes;  // node ident, bytes of its outputs, largest first
+    std::vector<Frame> frames;
+    size_t nodeBytes = 0;
+    size_t residentBytes = 0;  // node outputs and frames in memory, shared objects counted once
+
+    ZENO_API static bool enabled();
+    // to be called at the end of each substep, updates the high-water mark of the current frame
+    ZENO_API static void samplePeak(Graph const *graph, GlobalComm &comm);
+
+    ZENO_API void collect(Graph const *graph, GlobalComm &comm);
+    ZENO_API std::string toJson() const;
+    ZENO_API void fromJson(std::string_view json);
+    ZENO_API bool save(std::string const &path) const;
+};
+
+}
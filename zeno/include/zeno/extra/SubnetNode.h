@@ -27,6 +27,8 @@ struct SubnetNode : INode {
     //}
 
     ZENO_API virtual void apply() override;
+    ZENO_API virtual bool isFrameIndependent() const override;  // if all the nodes inside are
+    ZENO_API virtual void resetFrameState() override;
 };
 
 struct ImplSubnetNodeClass : INodeClass {
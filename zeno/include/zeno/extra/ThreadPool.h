@@ -0,0 +1,63 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+namespace zeno {
+
+struct ThreadPool {
+    struct WorkQueue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mtx;
+    };
+
+private:
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::atomic<std::ptrdiff_t> m_numPending{0};
+    std::atomic<std::size_t> m_nextQueue{0};
+    std::mutex m_sleepMtx;
+    std::condition_variable m_sleepCv;
+    std::mutex m_startMtx;
+    std::atomic<bool> m_started{false};
+    std::size_t m_numThreads = 0;
+    bool m_pinThreads = false;
+    bool m_stopping = false;
+
+    void start();
+    void stop();
+    void workerMain(std::size_t index);
+    bool popTask(std::size_t index, std::function<void()> &task);
+
+public:
+    // numThreads == 0 means ZENO_THREADS or std::thread::hardware_concurrency
+    ZENO_API explicit ThreadPool(std::size_t numThreads = 0);
+    ZENO_API ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    ZENO_API void submit(std::function<void()> task);
+    ZENO_API std::size_t numThreads() const;
+    ZENO_API static bool inWorkerThread();
+
+    // calls body(0) .. body(numTasks - 1) on the workers and the calling thread, returns
+    // when all are done and rethrows the first exception; nested calls only queue tasks
+    ZENO_API void parallelRun(std::size_t numTasks, std::function<void(std::size_t)> const &body);
+
+    // only while idle: stops the workers, they are started again with the new settings
+    // by the next submit; pinThreads binds worker i to cpu i
+    ZENO_API void configure(std::size_t numThreads, bool pinThreads = false);
+};
+
+// the pool of the session, zeno/para runs on it
+ZENO_API ThreadPool &getThreadPool();
+
+}
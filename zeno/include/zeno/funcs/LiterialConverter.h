@@ -24,7 +24,7 @@ inline bool objectIsLiterial(std::shared_ptr<IObject> const &ptr) {
 }
 
 template <class T>
-inline auto objectToLiterial(std::shared_ptr<IObject> const &ptr, std::string const &msg = "objectToLiterial") {
+inline auto objectToLiterial(std::shared_ptr<IObject> const &ptr, std::string_view msg = "objectToLiterial") {
     if constexpr (std::is_base_of_v<IObject, T>) {
         return safe_dynamic_cast<T>(ptr, msg);
     } else if constexpr (std::is_same_v<std::string, T>) {
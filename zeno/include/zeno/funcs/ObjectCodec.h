@@ -1,13 +1,84 @@
 #pragma once
 
 #include <zeno/core/IObject.h>
+#include <functional>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <memory>
+#include <tuple>
 
 namespace zeno {
 
+// receives the encoded bytes in order, big arrays straight from the object's memory
+using EncodeSink = std::function<void(const char *data, size_t size)>;
+
 ZENO_API std::shared_ptr<IObject> decodeObject(const char *buf, size_t len);
 ZENO_API bool encodeObject(IObject const *object, std::vector<char> &buf);
+// streams to a file or socket without building the whole buffer first
+ZENO_API bool encodeObject(IObject const *object, EncodeSink const &sink);
+// exact number of bytes encodeObject produces, 0 if the object can't be encoded
+ZENO_API size_t encodedObjectSize(IObject const *object);
+
+namespace _implObjectCodec {
+
+// what the per-type encoders write to: nowhere (only counting bytes, for sizing
+// the output up front), a preallocated buffer, or a sink
+struct ObjectWriter {
+    static constexpr size_t kBulkSize = 1 << 16;
+
+    char *m_dst = nullptr;
+    EncodeSink const *m_sink = nullptr;
+    size_t m_offset = 0;
+    std::vector<std::tuple<char *, char const *, size_t>> m_bulkCopies;
+
+    ObjectWriter() = default;
+    explicit ObjectWriter(char *dst) : m_dst(dst) {}
+    explicit ObjectWriter(EncodeSink const *sink) : m_sink(sink) {}
+
+    bool measuring() const {
+        return !m_dst && !m_sink;
+    }
+
+    size_t offset() const {
+        return m_offset;
+    }
+
+    void write(void const *data, size_t size) {
+        if (m_dst)
+            std::memcpy(m_dst + m_offset, data, size);
+        else if (m_sink && size)
+            (*m_sink)(static_cast<char const *>(data), size);
+        m_offset += size;
+    }
+
+    template <class T>
+    void writeValue(T const &val) {
+        write(&val, sizeof(val));
+    }
+
+    // for attribute arrays, when writing to memory they are copied in parallel by flush()
+    void writeBulk(void const *data, size_t size) {
+        if (m_dst && size >= kBulkSize) {
+            m_bulkCopies.emplace_back(m_dst + m_offset, static_cast<char const *>(data), size);
+            m_offset += size;
+        } else {
+            write(data, size);
+        }
+    }
+
+    // size bytes to fill in place, nullptr when measuring; not for sinks
+    char *claim(size_t size) {
+        char *p = m_dst ? m_dst + m_offset : nullptr;
+        m_offset += size;
+        return p;
+    }
+
+    ZENO_API void flush();
+};
+
+ZENO_API bool encodeObjectTo(IObject const *object, ObjectWriter &writer);
+
+}
 
 }
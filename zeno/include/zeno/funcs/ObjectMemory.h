@@ -0,0 +1,24 @@
+#pragma once
+
+#include <zeno/core/IObject.h>
+#include <unordered_set>
+#include <utility>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+struct Graph;
+
+// resident bytes of an object: attribute arrays, list and dict children, user data;
+// objects and buffers already in visited count only once, so that objects shared
+// between several outputs, lists or frames are not counted twice
+ZENO_API size_t objectMemoryBytes(IObject const *object);
+ZENO_API size_t objectMemoryBytes(IObject const *object, std::unordered_set<void const *> &visited);
+
+// bytes held by the node outputs of the graph, subnets included, with the bytes of
+// each node appended to perNode (node ident, bytes) if given
+ZENO_API size_t graphMemoryBytes(Graph const *graph, std::unordered_set<void const *> &visited,
+                                 std::vector<std::pair<std::string, size_t>> *perNode = nullptr);
+
+}
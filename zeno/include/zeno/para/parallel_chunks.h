@@ -0,0 +1,69 @@
+#pragma once
+
+#include <zeno/extra/ThreadPool.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace zeno {
+
+// iterations [first, last) handed out in blocks of at least grain iterations
+template <class Index>
+struct blocked_range {
+    Index first;
+    Index last;
+    std::size_t grain = 1;
+
+    blocked_range(Index first, Index last, std::size_t grain = 1)
+        : first(first), last(last), grain(grain) {}
+};
+
+// leaves of reductions and scans are this long no matter how many threads there are,
+// so floating point results come out the same on every machine
+inline constexpr std::size_t parallel_leaf_size = 2048;
+
+// a few chunks per worker, so that the ones done early can take over the rest
+inline std::size_t parallel_num_chunks(std::size_t count, std::size_t grain = 1) {
+    grain = std::max<std::size_t>(grain, 1);
+    return std::min((count + grain - 1) / grain, getThreadPool().numThreads() * 4);
+}
+
+// calls func(chunk, chunkFirst, chunkLast) for numChunks consecutive non-empty pieces of [first, last)
+template <class Index, class Func>
+void parallel_chunks(Index first, Index last, std::size_t numChunks, Func const &func) {
+    if (!(first < last))
+        return;
+    std::size_t count = static_cast<std::size_t>(last - first);
+    numChunks = std::clamp<std::size_t>(numChunks, 1, count);
+    if (numChunks == 1) {
+        func(std::size_t{0}, first, last);
+        return;
+    }
+    getThreadPool().parallelRun(numChunks, [&] (std::size_t chunk) {
+        Index chunkFirst = first + static_cast<Index>(count * chunk / numChunks);
+        Index chunkLast = first + static_cast<Index>(count * (chunk + 1) / numChunks);
+        func(chunk, chunkFirst, chunkLast);
+    });
+}
+
+inline std::size_t parallel_num_leaves(std::size_t count, std::size_t leafSize) {
+    leafSize = std::max<std::size_t>(leafSize, 1);
+    return (count + leafSize - 1) / leafSize;
+}
+
+// calls func(leaf, leafFirst, leafLast) for [first, last) cut every leafSize iterations
+template <class Index, class Func>
+void parallel_leaves(Index first, Index last, std::size_t leafSize, Func const &func) {
+    if (!(first < last))
+        return;
+    leafSize = std::max<std::size_t>(leafSize, 1);
+    std::size_t numLeaves = parallel_num_leaves(static_cast<std::size_t>(last - first), leafSize);
+    parallel_chunks(std::size_t{0}, numLeaves, parallel_num_chunks(numLeaves), [&] (std::size_t, std::size_t b, std::size_t e) {
+        for (std::size_t leaf = b; leaf < e; leaf++) {
+            Index leafFirst = first + static_cast<Index>(leaf * leafSize);
+            Index leafLast = leaf + 1 == numLeaves ? last : leafFirst + static_cast<Index>(leafSize);
+            func(leaf, leafFirst, leafLast);
+        }
+    });
+}
+
+}
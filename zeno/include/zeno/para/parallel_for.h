@@ -1,24 +1,49 @@
 #pragma once
 
+#include <zeno/para/parallel_chunks.h>
 #include <zeno/para/execution.h>
 #include <zeno/para/counter_iterator.h>
-#include <algorithm>
+#include <iterator>
 
 namespace zeno {
 
+template <class Index, class Func>
+void parallel_for(Index first, Index last, std::size_t grain, Func func) {
+    if (!(first < last))
+        return;
+    parallel_chunks(first, last, parallel_num_chunks(last - first, grain), [&] (std::size_t, Index b, Index e) {
+        for (Index i = b; i < e; ++i)
+            func(i);
+    });
+}
+
 template <class Index, class Func>
 void parallel_for(Index first, Index last, Func func) {
-    std::for_each(ZENO_PAR counter_iterator<Index>(first), counter_iterator<Index>(last), func);
+    parallel_for(first, last, 1, std::move(func));
 }
 
 template <class Index, class Func>
 void parallel_for(Index count, Func func) {
-    std::for_each(ZENO_PAR counter_iterator<Index>(Index{}), counter_iterator<Index>(count), func);
+    parallel_for(Index{}, count, 1, std::move(func));
+}
+
+// func(blockFirst, blockLast) for blocks of at least range.grain iterations
+template <class Index, class Func>
+void parallel_for(blocked_range<Index> const &range, Func func) {
+    if (!(range.first < range.last))
+        return;
+    parallel_chunks(range.first, range.last, parallel_num_chunks(range.last - range.first, range.grain),
+                    [&] (std::size_t, Index b, Index e) {
+        func(b, e);
+    });
 }
 
 template <class It, class Func>
 void parallel_for_each(It first, It last, Func func) {
-    std::for_each(ZENO_PAR_UNSEQ first, last, func);
+    auto count = std::distance(first, last);
+    parallel_chunks(decltype(count){}, count, parallel_num_chunks(count), [&] (std::size_t, auto b, auto e) {
+        std::for_each(std::next(first, b), std::next(first, e), func);
+    });
 }
 
 }
@@ -1,8 +1,7 @@
 #pragma once
 
-#include <zeno/para/execution.h>
+#include <zeno/extra/ThreadPool.h>
 #include <functional>
-#include <algorithm>
 #include <array>
 
 namespace zeno {
@@ -10,7 +9,7 @@ namespace zeno {
 template <class ...Tasks>
 void parallel_invoke(Tasks &&...tasks) {
     std::array<std::function<void()>, sizeof...(Tasks)> tmp{std::forward<Tasks>(tasks)...};
-    std::for_each(ZENO_PAR tmp.begin(), tmp.end(), [] (auto &&f) { std::move(f)(); });
+    getThreadPool().parallelRun(tmp.size(), [&] (std::size_t i) { std::move(tmp[i])(); });
 }
 
 //inline void parallel_invoke(std::initializer_list<std::function<void()> tasks) {
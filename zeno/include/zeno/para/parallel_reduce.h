@@ -1,25 +1,60 @@
 #pragma once
 
+#include <zeno/para/parallel_chunks.h>
+#include <zeno/para/parallel_for.h>
 #include <zeno/para/execution.h>
 #include <zeno/para/counter_iterator.h>
 #include <zeno/utils/type_traits.h>
 #include <zeno/utils/vec.h>
-#include <numeric>
-#include <limits>
-#include <tuple>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 namespace zeno {
 
+// leaves of range.grain iterations are reduced in order, then combined pairwise as a tree,
+// which keeps floating point sums reproducible and loses less precision than a running sum
+template <class Index, class Value, class Reduce, class Transform>
+Value parallel_reduce(blocked_range<Index> const &range, Value initVal, Reduce reduceFn, Transform transformFn) {
+    if (!(range.first < range.last))
+        return initVal;
+    std::vector<Value> partials(parallel_num_leaves(range.last - range.first, range.grain), initVal);
+    parallel_leaves(range.first, range.last, range.grain, [&] (std::size_t leaf, Index b, Index e) {
+        Value acc = transformFn(b);
+        for (Index i = b + 1; i < e; ++i)
+            acc = reduceFn(acc, transformFn(i));
+        partials[leaf] = std::move(acc);
+    });
+    while (partials.size() > 1) {
+        std::size_t n = partials.size();
+        std::vector<Value> level((n + 1) / 2, initVal);
+        parallel_for(std::size_t{0}, n / 2, parallel_leaf_size, [&] (std::size_t i) {
+            level[i] = reduceFn(partials[2 * i], partials[2 * i + 1]);
+        });
+        if (n % 2)
+            level.back() = std::move(partials.back());
+        partials = std::move(level);
+    }
+    return reduceFn(initVal, partials[0]);
+}
+
 template <class Index, class Value, class Reduce, class Transform>
 Value parallel_reduce(Index first, Index last, Value initVal, Reduce reduceFn, Transform transformFn) {
-    return std::transform_reduce(ZENO_PAR counter_iterator<Index>(first), counter_iterator<Index>(last),
-            initVal, reduceFn, transformFn);
+    return parallel_reduce(blocked_range<Index>(first, last, parallel_leaf_size), std::move(initVal), reduceFn, transformFn);
+}
+
+template <class It, class Value, class Reduce, class Transform>
+Value parallel_transform_reduce(It first, It last, Value initVal, Reduce reduceFn, Transform transformFn) {
+    auto count = std::distance(first, last);
+    return parallel_reduce(decltype(count){}, count, std::move(initVal), reduceFn, [&] (auto i) {
+        return transformFn(*std::next(first, i));
+    });
 }
 
 template <class It, class Transform = identity>
 auto parallel_reduce_min(It first, It last, Transform transformFn = {}) {
     if (first == last) return std::decay_t<decltype(*first)>();
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, *first, [] (auto &&x, auto &&y) {
+    return parallel_transform_reduce(first, last, *first, [] (auto &&x, auto &&y) {
         return zeno::min(x, y);
     }, transformFn);
 }
@@ -27,7 +62,7 @@ auto parallel_reduce_min(It first, It last, Transform transformFn = {}) {
 template <class It, class Transform = identity>
 auto parallel_reduce_max(It first, It last, Transform transformFn = {}) {
     if (first == last) return std::decay_t<decltype(*first)>();
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, *first, [] (auto &&x, auto &&y) {
+    return parallel_transform_reduce(first, last, *first, [] (auto &&x, auto &&y) {
         return zeno::max(x, y);
     }, transformFn);
 }
@@ -35,7 +70,7 @@ auto parallel_reduce_max(It first, It last, Transform transformFn = {}) {
 template <class It, class Transform = identity>
 auto parallel_reduce_minmax(It first, It last, Transform transformFn = {}) {
     if (first == last) return std::make_pair(std::decay_t<decltype(*first)>(), std::decay_t<decltype(*first)>());
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, std::make_pair(*first, *first), [] (auto &&x, auto &&y) {
+    return parallel_transform_reduce(first, last, std::make_pair(*first, *first), [] (auto &&x, auto &&y) {
         return std::make_pair(zeno::min(x.first, y.first), zeno::max(x.second, y.second));
     }, [transformFn] (auto const &val) {
         return std::make_pair(val, val);
@@ -44,7 +79,7 @@ auto parallel_reduce_minmax(It first, It last, Transform transformFn = {}) {
 
 template <class It, class Transform = identity>
 auto parallel_reduce_sum(It first, It last, Transform transformFn = {}) {
-    return std::transform_reduce(ZENO_PAR_UNSEQ first, last, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
+    return parallel_transform_reduce(first, last, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
         return x + y;
     }, transformFn);
 }
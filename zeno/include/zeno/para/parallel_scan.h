@@ -1,51 +1,139 @@
 #pragma once
 
+#include <zeno/para/parallel_chunks.h>
 #include <zeno/para/execution.h>
 #include <zeno/para/counter_iterator.h>
 #include <zeno/utils/type_traits.h>
 #include <zeno/utils/vec.h>
-#include <numeric>
-#include <limits>
-#include <tuple>
+#include <iterator>
+#include <vector>
 
 namespace zeno {
 
+namespace _parallel_scan_details {
+
+// first pass: the total of each leaf; second pass: a leaf scans on top of the totals before it,
+// leaves have a fixed size so that the result does not depend on the number of threads
+template <bool Inclusive, class Index, class OutputIt, class Value, class Reduce, class Transform>
+Value scan(Index first, Index last, OutputIt dest, Value initVal, Reduce &reduceFn, Transform &transformFn) {
+    if (!(first < last))
+        return initVal;
+    std::size_t numLeaves = parallel_num_leaves(last - first, parallel_leaf_size);
+    std::vector<Value> offsets(numLeaves + 1, initVal);
+    if (numLeaves > 1) {
+        parallel_leaves(first, last, parallel_leaf_size, [&] (std::size_t leaf, Index b, Index e) {
+            Value acc = transformFn(b);
+            for (Index i = b + 1; i < e; ++i)
+                acc = reduceFn(acc, transformFn(i));
+            offsets[leaf + 1] = std::move(acc);
+        });
+        for (std::size_t l = 1; l < numLeaves; l++)
+            offsets[l] = reduceFn(offsets[l - 1], offsets[l]);
+    }
+    parallel_leaves(first, last, parallel_leaf_size, [&] (std::size_t leaf, Index b, Index e) {
+        Value acc = offsets[leaf];
+        auto out = std::next(dest, b - first);
+        for (Index i = b; i < e; ++i, ++out) {
+            if constexpr (Inclusive) {
+                acc = reduceFn(acc, transformFn(i));
+                *out = acc;
+            } else {
+                *out = acc;
+                acc = reduceFn(acc, transformFn(i));
+            }
+        }
+        if (leaf == numLeaves - 1)
+            offsets[numLeaves] = std::move(acc);
+    });
+    return offsets[numLeaves];
+}
+
+}
+
 template <class Index, class OutputIt, class Value, class Reduce, class Transform>
 OutputIt parallel_inclusive_scan(Index first, Index last, OutputIt dest,
                     Value initVal, Reduce reduceFn, Transform transformFn) {
-    return std::transform_inclusive_scan(ZENO_PAR
-            counter_iterator<Index>(first), counter_iterator<Index>(last),
-            dest, reduceFn, transformFn, initVal);
+    _parallel_scan_details::scan<true>(first, last, dest, std::move(initVal), reduceFn, transformFn);
+    return first < last ? std::next(dest, last - first) : dest;
 }
 
 template <class It, class OutputIt, class Transform = identity>
 OutputIt parallel_inclusive_scan_sum(It first, It last, OutputIt dest, Transform transformFn = {}) {
-    return std::transform_inclusive_scan(ZENO_PAR_UNSEQ first, last, dest, [] (auto &&x, auto &&y) {
+    auto count = std::distance(first, last);
+    return parallel_inclusive_scan(decltype(count){}, count, dest, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
         return x + y;
-    }, transformFn, std::decay_t<decltype(transformFn(*first))>());
+    }, [&] (auto i) {
+        return transformFn(*std::next(first, i));
+    });
 }
 
 template <class Index, class OutputIt, class Value, class Reduce, class Transform>
 Value parallel_exclusive_scan(Index first, Index last, OutputIt dest,
                     Value initVal, Reduce reduceFn, Transform transformFn) {
-    auto endp = std::transform_exclusive_scan(ZENO_PAR
-            counter_iterator<Index>(first), counter_iterator<Index>(last),
-            dest, initVal, reduceFn, transformFn);
-    if (first != last)
-        return reduceFn(*std::prev(endp), transformFn(*std::prev(last)));
-    else
-        return initVal;
+    return _parallel_scan_details::scan<false>(first, last, dest, std::move(initVal), reduceFn, transformFn);
 }
 
 template <class It, class OutputIt, class Transform = identity>
 auto parallel_exclusive_scan_sum(It first, It last, OutputIt dest, Transform transformFn = {}) {
-    auto endp = std::transform_exclusive_scan(ZENO_PAR_UNSEQ first, last, dest, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
+    auto count = std::distance(first, last);
+    return parallel_exclusive_scan(decltype(count){}, count, dest, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
+        return x + y;
+    }, [&] (auto i) {
+        return transformFn(*std::next(first, i));
+    });
+}
+
+// scans restart from initVal at every index where isHead(i) is true, e.g. one cdf per
+// primitive group; returns the end of dest
+template <class Index, class OutputIt, class Value, class Reduce, class Transform, class IsHead>
+OutputIt parallel_segmented_inclusive_scan(Index first, Index last, OutputIt dest,
+                    Value initVal, Reduce reduceFn, Transform transformFn, IsHead isHead) {
+    if (!(first < last))
+        return dest;
+    std::size_t numLeaves = parallel_num_leaves(last - first, parallel_leaf_size);
+    // what flows out of each leaf: its last segment, or its sum when there is no head in it
+    std::vector<Value> tails(numLeaves, initVal);
+    std::vector<char> hasHead(numLeaves);
+    parallel_leaves(first, last, parallel_leaf_size, [&] (std::size_t leaf, Index b, Index e) {
+        Value acc = initVal;
+        bool head = false;
+        for (Index i = b; i < e; ++i) {
+            if (isHead(i)) {
+                acc = reduceFn(initVal, transformFn(i));
+                head = true;
+            } else if (i == b) {
+                acc = transformFn(i);
+            } else {
+                acc = reduceFn(acc, transformFn(i));
+            }
+        }
+        tails[leaf] = std::move(acc);
+        hasHead[leaf] = head;
+    });
+    std::vector<Value> carries(numLeaves, initVal);
+    for (std::size_t l = 1; l < numLeaves; l++)
+        carries[l] = hasHead[l - 1] ? tails[l - 1] : reduceFn(carries[l - 1], tails[l - 1]);
+    parallel_leaves(first, last, parallel_leaf_size, [&] (std::size_t leaf, Index b, Index e) {
+        Value acc = carries[leaf];
+        auto out = std::next(dest, b - first);
+        for (Index i = b; i < e; ++i, ++out) {
+            acc = reduceFn(isHead(i) ? initVal : acc, transformFn(i));
+            *out = acc;
+        }
+    });
+    return std::next(dest, last - first);
+}
+
+template <class It, class HeadIt, class OutputIt, class Transform = identity>
+OutputIt parallel_segmented_inclusive_scan_sum(It first, It last, HeadIt heads, OutputIt dest, Transform transformFn = {}) {
+    auto count = std::distance(first, last);
+    return parallel_segmented_inclusive_scan(decltype(count){}, count, dest, std::decay_t<decltype(transformFn(*first))>(), [] (auto &&x, auto &&y) {
         return x + y;
-    }, transformFn);
-    if (first != last)
-        return *std::prev(endp) + transformFn(*std::prev(last));
-    else
-        return std::decay_t<decltype(transformFn(*first))>();
+    }, [&] (auto i) {
+        return transformFn(*std::next(first, i));
+    }, [&] (auto i) -> bool {
+        return *std::next(heads, i);
+    });
 }
 
 }
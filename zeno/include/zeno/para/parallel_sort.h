@@ -1,19 +1,132 @@
 #pragma once
 
+#include <zeno/para/parallel_chunks.h>
+#include <zeno/para/parallel_for.h>
 #include <zeno/para/execution.h>
 #include <zeno/para/counter_iterator.h>
+#include <functional>
 #include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 namespace zeno {
 
+namespace _parallel_sort_details {
+
+// sorts chunks of at least grain elements on their own, then merges neighbouring runs
+// pairwise, splitting large merges at binary searched points so all workers keep busy
+template <bool Stable, class It, class Compare>
+void merge_sort(It first, It last, Compare &comp, std::size_t grain) {
+    using T = typename std::iterator_traits<It>::value_type;
+    std::size_t count = std::distance(first, last);
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t numChunks = parallel_num_chunks(count, grain);
+    if (numChunks <= 1) {
+        if constexpr (Stable)
+            std::stable_sort(first, last, comp);
+        else
+            std::sort(first, last, comp);
+        return;
+    }
+    std::vector<std::size_t> bounds(numChunks + 1);
+    for (std::size_t c = 0; c <= numChunks; c++)
+        bounds[c] = count * c / numChunks;
+    parallel_chunks(std::size_t{0}, numChunks, numChunks, [&] (std::size_t, std::size_t c, std::size_t) {
+        if constexpr (Stable)
+            std::stable_sort(std::next(first, bounds[c]), std::next(first, bounds[c + 1]), comp);
+        else
+            std::sort(std::next(first, bounds[c]), std::next(first, bounds[c + 1]), comp);
+    });
+
+    std::vector<T> buf(std::make_move_iterator(first), std::make_move_iterator(last));
+    std::size_t numThreads = getThreadPool().numThreads();
+    auto mergeRuns = [&] (auto src, auto dst) {
+        struct Piece {
+            std::size_t a0, a1, b0, b1, out;
+        };
+        std::vector<Piece> pieces;
+        std::vector<std::size_t> next;
+        std::size_t numRuns = bounds.size() - 1;
+        std::size_t piecesPerMerge = std::max<std::size_t>(1, numThreads * 2 / (numRuns / 2));
+        for (std::size_t r = 0; r < numRuns; r += 2) {
+            next.push_back(bounds[r]);
+            if (r + 1 == numRuns) {
+                pieces.push_back({bounds[r], bounds[r + 1], bounds[r + 1], bounds[r + 1], bounds[r]});
+                continue;
+            }
+            std::size_t a0 = bounds[r], a1 = bounds[r + 1], b1 = bounds[r + 2];
+            std::size_t numPieces = std::min({piecesPerMerge, a1 - a0, std::max<std::size_t>(1, (b1 - a0) / grain)});
+            std::size_t pb = a1;
+            for (std::size_t p = 0; p < numPieces; p++) {
+                std::size_t pa0 = a0 + (a1 - a0) * p / numPieces;
+                std::size_t pa1 = a0 + (a1 - a0) * (p + 1) / numPieces;
+                // elements of the right run that go before src[pa1], equal ones stay behind it
+                std::size_t pb1 = p + 1 == numPieces ? b1 : std::lower_bound(
+                    std::next(src, a1), std::next(src, b1), *std::next(src, pa1), comp) - src;
+                pieces.push_back({pa0, pa1, pb, pb1, pa0 + pb - a1});
+                pb = pb1;
+            }
+        }
+        next.push_back(bounds.back());
+        getThreadPool().parallelRun(pieces.size(), [&] (std::size_t i) {
+            auto const &pc = pieces[i];
+            std::merge(std::make_move_iterator(std::next(src, pc.a0)), std::make_move_iterator(std::next(src, pc.a1)),
+                       std::make_move_iterator(std::next(src, pc.b0)), std::make_move_iterator(std::next(src, pc.b1)),
+                       std::next(dst, pc.out), comp);
+        });
+        bounds = std::move(next);
+    };
+    bool inBuf = true;
+    while (bounds.size() > 2) {
+        if (inBuf)
+            mergeRuns(buf.begin(), first);
+        else
+            mergeRuns(first, buf.begin());
+        inBuf = !inBuf;
+    }
+    if (!inBuf)
+        return;
+    parallel_for(std::size_t{0}, count, parallel_leaf_size, [&] (std::size_t i) {
+        *std::next(first, i) = std::move(buf[i]);
+    });
+}
+
+}
+
 template <class It, class Func>
 void parallel_sort(It first, It last, Func func) {
-    std::sort(ZENO_PAR_UNSEQ first, last, func);
+    _parallel_sort_details::merge_sort<false>(first, last, func, parallel_leaf_size);
 }
 
 template <class It, class Func>
 void parallel_stable_sort(It first, It last, Func func) {
-    std::stable_sort(ZENO_PAR_UNSEQ first, last, func);
+    _parallel_sort_details::merge_sort<true>(first, last, func, parallel_leaf_size);
+}
+
+// orders by keyFn(element), each key computed once; ties keep their original order,
+// so the result is the same however the work is split
+template <class It, class KeyFn, class Compare = std::less<>>
+void parallel_sort_by_key(It first, It last, KeyFn keyFn, Compare comp = {}) {
+    using T = typename std::iterator_traits<It>::value_type;
+    using Key = std::decay_t<decltype(keyFn(*first))>;
+    std::size_t count = std::distance(first, last);
+    std::vector<std::pair<Key, std::size_t>> keys(count);
+    parallel_for(std::size_t{0}, count, parallel_leaf_size, [&] (std::size_t i) {
+        keys[i] = {keyFn(*std::next(first, i)), i};
+    });
+    parallel_sort(keys.begin(), keys.end(), [&comp] (auto const &x, auto const &y) {
+        if (comp(x.first, y.first)) return true;
+        if (comp(y.first, x.first)) return false;
+        return x.second < y.second;
+    });
+    std::vector<T> tmp(count);
+    parallel_for(std::size_t{0}, count, parallel_leaf_size, [&] (std::size_t i) {
+        tmp[i] = std::move(*std::next(first, keys[i].second));
+    });
+    parallel_for(std::size_t{0}, count, parallel_leaf_size, [&] (std::size_t i) {
+        *std::next(first, i) = std::move(tmp[i]);
+    });
 }
 
 }
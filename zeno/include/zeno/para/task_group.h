@@ -1,6 +1,6 @@
 #pragma once
 
-#include <zeno/para/execution.h>
+#include <zeno/extra/ThreadPool.h>
 #include <functional>
 #include <algorithm>
 #include <vector>
@@ -19,8 +19,8 @@ struct task_group {
     }
 
     void run() {
-        std::for_each(ZENO_PAR m_tasks.begin(), m_tasks.end(), [&] (auto &&f) {
-            std::move(f)();
+        getThreadPool().parallelRun(m_tasks.size(), [&] (std::size_t i) {
+            std::move(m_tasks[i])();
         });
     }
 };
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <zeno/types/AttrName.h>
+#include <string_view>
+#include <type_traits>
+#include <iterator>
+#include <utility>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+// The attribute arrays of an AttrVector, by name. Iterates in name order like the
+// std::map it replaces (the codec and attr_index rely on that), but looks up by hashing
+// into a flat open addressing table, so a lookup is a hash and one or two probes rather
+// than string compares down a tree; with an AttrName it is only integer compares. The
+// entries are allocated one by one, so references to them survive inserting and erasing
+// others, iterators do not.
+template <class V>
+struct AttrMap {
+    using key_type = std::string;
+    using mapped_type = V;
+    using value_type = std::pair<const std::string, V>;
+    using size_type = std::size_t;
+
+private:
+    std::vector<std::unique_ptr<value_type>> m_entries;  // sorted by key
+    std::vector<AttrName> m_names;                      // of m_entries, same order
+    std::vector<std::uint32_t> m_table;                 // m_entries index + 1, 0 for empty
+
+    template <class E, class It>
+    struct iterator_base {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::remove_const_t<E>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = E *;
+        using reference = E &;
+
+        It it;
+
+        iterator_base() = default;
+        explicit iterator_base(It it) : it(it) {}
+
+        template <class E2, class It2, class = std::enable_if_t<std::is_convertible_v<It2, It>>>
+        iterator_base(iterator_base<E2, It2> const &other) : it(other.it) {}
+
+        reference operator*() const { return **it; }
+        pointer operator->() const { return it->get(); }
+        iterator_base &operator++() { ++it; return *this; }
+        iterator_base &operator--() { --it; return *this; }
+        iterator_base operator++(int) { auto old = *this; ++it; return old; }
+        iterator_base operator--(int) { auto old = *this; --it; return old; }
+        bool operator==(iterator_base const &other) const { return it == other.it; }
+        bool operator!=(iterator_base const &other) const { return it != other.it; }
+    };
+
+public:
+    using iterator = iterator_base<value_type, typename decltype(m_entries)::iterator>;
+    using const_iterator = iterator_base<value_type const, typename decltype(m_entries)::const_iterator>;
+
+private:
+    std::size_t mask() const {
+        return m_table.size() - 1;
+    }
+
+    void rebuild_table() {
+        std::size_t cap = 8;
+        while (cap < m_entries.size() * 2)
+            cap *= 2;
+        m_table.assign(cap, 0);
+        for (std::size_t i = 0; i < m_names.size(); i++) {
+            std::size_t slot = m_names[i].hash & mask();
+            while (m_table[slot])
+                slot = (slot + 1) & mask();
+            m_table[slot] = static_cast<std::uint32_t>(i + 1);
+        }
+    }
+
+    std::size_t index_of(std::string_view name, std::size_t hash) const {
+        if (m_table.empty())
+            return npos;
+        for (std::size_t slot = hash & mask(); m_table[slot]; slot = (slot + 1) & mask()) {
+            std::size_t i = m_table[slot] - 1;
+            if (m_names[i].hash == hash && m_entries[i]->first == name)
+                return i;
+        }
+        return npos;
+    }
+
+    std::size_t index_of(AttrName const &name) const {
+        if (m_table.empty())
+            return npos;
+        for (std::size_t slot = name.hash & mask(); m_table[slot]; slot = (slot + 1) & mask()) {
+            std::size_t i = m_table[slot] - 1;
+            if (m_names[i].id == name.id)
+                return i;
+        }
+        return npos;
+    }
+
+    std::size_t insert_sorted(AttrName const &name) {
+        std::size_t i = 0, n = m_entries.size();
+        while (n) {  // lower_bound by key
+            std::size_t half = n / 2;
+            if (m_entries[i + half]->first < name.name()) {
+                i += half + 1;
+                n -= half + 1;
+            } else {
+                n = half;
+            }
+        }
+        m_entries.insert(m_entries.begin() + i, std::make_unique<value_type>(name.name(), V{}));
+        m_names.insert(m_names.begin() + i, name);
+        rebuild_table();
+        return i;
+    }
+
+    void erase_index(std::size_t i) {
+        m_entries.erase(m_entries.begin() + i);
+        m_names.erase(m_names.begin() + i);
+        rebuild_table();
+    }
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    AttrMap() = default;
+    AttrMap(AttrMap &&) noexcept = default;
+    AttrMap &operator=(AttrMap &&) noexcept = default;
+
+    AttrMap(AttrMap const &other) : m_names(other.m_names), m_table(other.m_table) {
+        m_entries.reserve(other.m_entries.size());
+        for (auto const &entry: other.m_entries)
+            m_entries.push_back(std::make_unique<value_type>(*entry));
+    }
+
+    AttrMap &operator=(AttrMap const &other) {
+        if (this != &other)
+            *this = AttrMap(other);
+        return *this;
+    }
+
+    iterator begin() { return iterator(m_entries.begin()); }
+    iterator end() { return iterator(m_entries.end()); }
+    const_iterator begin() const { return const_iterator(m_entries.begin()); }
+    const_iterator end() const { return const_iterator(m_entries.end()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_type size() const {
+        return m_entries.size();
+    }
+
+    bool empty() const {
+        return m_entries.empty();
+    }
+
+    iterator find(std::string_view name) {
+        std::size_t i = index_of(name, AttrName::hash_of(name));
+        return i == npos ? end() : iterator(m_entries.begin() + i);
+    }
+
+    const_iterator find(std::string_view name) const {
+        std::size_t i = index_of(name, AttrName::hash_of(name));
+        return i == npos ? end() : const_iterator(m_entries.begin() + i);
+    }
+
+    iterator find(AttrName const &name) {
+        std::size_t i = index_of(name);
+        return i == npos ? end() : iterator(m_entries.begin() + i);
+    }
+
+    const_iterator find(AttrName const &name) const {
+        std::size_t i = index_of(name);
+        return i == npos ? end() : const_iterator(m_entries.begin() + i);
+    }
+
+    // the value, or nullptr if there is none
+    V *lookup(AttrName const &name) {
+        std::size_t i = index_of(name);
+        return i == npos ? nullptr : &m_entries[i]->second;
+    }
+
+    V const *lookup(AttrName const &name) const {
+        std::size_t i = index_of(name);
+        return i == npos ? nullptr : &m_entries[i]->second;
+    }
+
+    V *lookup(std::string_view name) {
+        std::size_t i = index_of(name, AttrName::hash_of(name));
+        return i == npos ? nullptr : &m_entries[i]->second;
+    }
+
+    V const *lookup(std::string_view name) const {
+        std::size_t i = index_of(name, AttrName::hash_of(name));
+        return i == npos ? nullptr : &m_entries[i]->second;
+    }
+
+    size_type count(std::string_view name) const {
+        return index_of(name, AttrName::hash_of(name)) != npos;
+    }
+
+    size_type count(AttrName const &name) const {
+        return index_of(name) != npos;
+    }
+
+    // inserts a default constructed value if missing, like std::map
+    V &operator[](AttrName const &name) {
+        std::size_t i = index_of(name);
+        if (i == npos)
+            i = insert_sorted(name);
+        return m_entries[i]->second;
+    }
+
+    V &operator[](std::string_view name) {
+        std::size_t i = index_of(name, AttrName::hash_of(name));
+        if (i == npos)
+            i = insert_sorted(internAttrName(name));
+        return m_entries[i]->second;
+    }
+
+    size_type erase(std::string_view name) {
+        std::size_t i = index_of(name, AttrName::hash_of(name));
+        if (i == npos)
+            return 0;
+        erase_index(i);
+        return 1;
+    }
+
+    size_type erase(AttrName const &name) {
+        std::size_t i = index_of(name);
+        if (i == npos)
+            return 0;
+        erase_index(i);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        std::size_t i = pos.it - m_entries.cbegin();
+        erase_index(i);
+        return iterator(m_entries.begin() + i);
+    }
+
+    void clear() {
+        m_entries.clear();
+        m_names.clear();
+        m_table.clear();
+    }
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <string>
+
+namespace zeno {
+
+// An attribute name interned in a process wide table: equal names get the same small
+// id, so AttrMap compares ids instead of strings, and the hash is computed only once.
+// Interning takes a lock, so hot code resolves its names up front, e.g.
+//     static const AttrName clr("clr");
+// and then looks up with clr instead of "clr". Interned names live until exit.
+struct AttrName {
+    static constexpr std::uint32_t kPosId = 1;  // "pos" is always interned first
+
+    std::uint32_t id = 0;  // 0 for no name
+    std::size_t hash = 0;
+    std::string const *str = nullptr;
+
+    AttrName() = default;
+    inline explicit AttrName(std::string_view name);
+
+    static std::size_t hash_of(std::string_view name) {
+        return std::hash<std::string_view>{}(name);
+    }
+
+    bool is_pos() const {
+        return id == kPosId;
+    }
+
+    std::string const &name() const {
+        return *str;
+    }
+
+    bool operator==(AttrName const &other) const {
+        return id == other.id;
+    }
+
+    bool operator!=(AttrName const &other) const {
+        return id != other.id;
+    }
+};
+
+ZENO_API AttrName internAttrName(std::string_view name);
+
+inline AttrName::AttrName(std::string_view name) : AttrName(internAttrName(name)) {
+}
+
+// an AttrName that also says the element type, for AttrVector::attr(handle)
+template <class T>
+struct AttrHandle {
+    using value_type = T;
+
+    AttrName name;
+
+    AttrHandle() = default;
+    explicit AttrHandle(std::string_view name) : name(name) {}
+    explicit AttrHandle(AttrName name) : name(name) {}
+};
+
+}
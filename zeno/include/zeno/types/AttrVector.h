@@ -1,14 +1,21 @@
 #pragma once
 
 #include <zeno/utils/vec.h>
+#include <zeno/utils/half.h>
 #include <zeno/utils/Error.h>
 #include <zeno/utils/type_traits.h>
+#include <zeno/types/CowVector.h>
+#include <zeno/types/AttrMap.h>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
 #include <variant>
+#include <cmath>
 #include <vector>
-#include <map>
 
 namespace zeno {
 
+// the codec stores the index into this list, so new types only go at the end
 using AttrAcceptAll = std::variant
     < vec3f
     , float
@@ -18,8 +25,48 @@ using AttrAcceptAll = std::variant
     , vec2i
     , vec4f
     , vec4i
+    , half
+    , uint8_t
+    , vec4C
+    , int64_t
+    , double
+    , vec3d
     >;
 
+// Components of attribute elements as floats, for code computing only in floats, like the
+// wrangles and the viewer. vec4C is an 8 bit color, 0..255 as 0..1; the other integer
+// types keep their values (uint8_t for masks and ids), rounded and clamped when stored.
+template <class T>
+float attr_get_float(T const &val, size_t comp) {
+    if constexpr (std::is_same_v<T, vec4C>) {
+        return val[comp] * (1.f / 255.f);
+    } else if constexpr (is_vec_v<T>) {
+        return float(val[comp]);
+    } else {
+        return float(val);
+    }
+}
+
+template <class T>
+void attr_set_float(T &val, size_t comp, float f) {
+    auto conv = [] (auto &dst, float f) {
+        using S = std::decay_t<decltype(dst)>;
+        if constexpr (std::is_same_v<S, uint8_t>)
+            dst = S(std::min(std::max(std::nearbyint(f), 0.f), 255.f));
+        else if constexpr (std::is_integral_v<S>)
+            dst = S(std::nearbyint(f));
+        else
+            dst = S(f);
+    };
+    if constexpr (std::is_same_v<T, vec4C>) {
+        conv(val[comp], f * 255.f);
+    } else if constexpr (is_vec_v<T>) {
+        conv(val[comp], f);
+    } else {
+        conv(val, f);
+    }
+}
+
 struct AttrVectorIndex {
     size_t attrIndex = 0;
     size_t elementIndex = 0;
@@ -27,17 +74,30 @@ struct AttrVectorIndex {
 };
 
 // AttrVector = BaseVector + attrs
+// the arrays are shared by copies until written to, see CowVector, so that cloning a
+// primitive copies no elements, and a node then changing one attribute copies only that
+// one; the accessors below hand out the std::vector, already made this vector's own for
+// the non-const ones, so loops take it once and index that. The visitors only make an
+// array their own if the callback takes it by non-const reference, `auto const &arr` reads
+// each accessor taking a name also takes an AttrName (or AttrHandle), for loops and hot
+// nodes to look up without hashing the string every time, see AttrMap
 template <class ValT>
 struct AttrVector {
     using AttrVectorVariant = std::variant
-        < std::vector<vec3f>
-        , std::vector<float>
-        , std::vector<vec3i>
-        , std::vector<int>
-        , std::vector<vec2f>
-        , std::vector<vec2i>
-        , std::vector<vec4f>
-        , std::vector<vec4i>
+        < CowVector<vec3f>
+        , CowVector<float>
+        , CowVector<vec3i>
+        , CowVector<int>
+        , CowVector<vec2f>
+        , CowVector<vec2i>
+        , CowVector<vec4f>
+        , CowVector<vec4i>
+        , CowVector<half>
+        , CowVector<uint8_t>
+        , CowVector<vec4C>
+        , CowVector<int64_t>
+        , CowVector<double>
+        , CowVector<vec3d>
         >;
 
     using value_type = ValT;
@@ -52,8 +112,8 @@ struct AttrVector {
 
     inline static const std::string kpos = "pos"; 
 
-    BaseVector values;
-    std::map<std::string, AttrVectorVariant> attrs;
+    CowVector<ValT> values;
+    AttrMap<AttrVectorVariant> attrs;
 
     AttrVector() = default;
     AttrVector(std::vector<ValT> const &values_) : values(values_) {}
@@ -128,48 +188,44 @@ struct AttrVector {
         return &values;
     }
 
-    operator auto const &() const {
-        return values;
+    operator BaseVector const &() const {
+        return values.get();
     }
 
-    operator auto &() {
-        return values;
+    operator BaseVector &() {
+        return values.mut();
     }
 
     template <class Accept = std::variant<vec3f, float>, class F>
-    void attr_visit(std::string const &name, F const &f) const {
+    void attr_visit(std::string_view name, F const &f) const {
         if (name == "pos") {
-            f(values);
+            f(values.get());
             return;
         }
-        auto it = attrs.find(name);
-        if (it == attrs.end())
-            throw makeError<KeyError>(name, "attribute name of primitive");
+        auto &var = _attr_variant(name);
         std::visit([&] (auto &arr) {
             using T = std::decay_t<decltype(arr[0])>;
             if constexpr (variant_contains<T, Accept>::value) {
-                f(arr);
+                f(arr.get());
             }
-        }, it->second);
+        }, var);
     }
 
     template <class Accept = std::variant<vec3f, float>, class F>
-    void attr_visit(std::string const &name, F const &f) {
+    void attr_visit(std::string_view name, F const &f) {
         if constexpr (variant_contains<ValT, Accept>::value) {
             if (name == "pos") {
-                f(values);
+                cow_visit(values, f);
                 return;
             }
         }
-        auto it = attrs.find(name);
-        if (it == attrs.end())
-            throw makeError<KeyError>(name, "attribute name of primitive");
+        auto &var = _attr_variant(name);
         std::visit([&] (auto &arr) {
             using T = std::decay_t<decltype(arr[0])>;
             if constexpr (variant_contains<T, Accept>::value) {
-                f(arr);
+                cow_visit(arr, f);
             }
-        }, it->second);
+        }, var);
     }
 
     template <class Accept = std::variant<vec3f, float>, class F>
@@ -179,7 +235,7 @@ struct AttrVector {
             std::visit([&] (auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 if constexpr (variant_contains<T, Accept>::value) {
-                    f(k, arr);
+                    f(k, arr.get());
                 }
             }, arr);
         }
@@ -192,7 +248,7 @@ struct AttrVector {
             std::visit([&] (auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 if constexpr (variant_contains<T, Accept>::value) {
-                    f(k, arr);
+                    cow_visit(arr, f, k);
                 }
             }, arr);
         }
@@ -200,13 +256,13 @@ struct AttrVector {
 
     template <class Accept = std::variant<vec3f, float>, class F>
     void forall_attr(F &&f) const {
-        f(kpos, values);
+        f(kpos, values.get());
         for (auto const &[key, arr]: attrs) {
             auto const &k = key;
             std::visit([&] (auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 if constexpr (variant_contains<T, Accept>::value) {
-                    f(k, arr);
+                    f(k, arr.get());
                 }
             }, arr);
         }
@@ -214,13 +270,13 @@ struct AttrVector {
 
     template <class Accept = std::variant<vec3f, float>, class F>
     void forall_attr(F &&f) {
-        f(kpos, values);
+        cow_visit(values, f, kpos);
         for (auto &[key, arr]: attrs) {
             auto const &k = key;
             std::visit([&] (auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 if constexpr (variant_contains<T, Accept>::value) {
-                    f(k, arr);
+                    cow_visit(arr, f, k);
                 }
             }, arr);
         }
@@ -329,7 +385,7 @@ struct AttrVector {
         }
         attrIndex++;
         // attr
-        // attr is std::map, it's sorted, so here attrIndex++ is right.
+        // attrs iterate sorted by name, so here attrIndex++ is right.
         for (auto& [key, arr] : attrs) {
             auto const& k = key;
             std::visit([&](auto& arr) {
@@ -378,60 +434,55 @@ struct AttrVector {
         values.emplace_back(std::forward<Ts>(ts)...);
     }
 
-    template <class T>
-    auto &add_attr(std::string const &name) {
-        if (!attr_is<T>(name))
-            attrs[name] = std::vector<T>(size());
-        return attr<T>(name);
+private:
+    static bool _is_pos(std::string_view name) {
+        return name == "pos";
     }
 
-    // deprecated:
-    template <class T>
-    auto &add_attr(std::string const &name, T const &val) {
-        if (!attr_is<T>(name))
-            attrs[name] = std::vector<T>(size(), val);
-        return attr<T>(name);
+    static bool _is_pos(AttrName const &name) {
+        return name.is_pos();
     }
 
-    //template <class T>
-    //auto &add_attr(std::string const &name, T const &value) {
-        //if (!attr_is<T>(name))
-            //attrs[name] = std::vector<T>(size(), value);
-        //return attr<T>(name);
-    //}
+    static std::string_view _name_of(std::string_view name) {
+        return name;
+    }
 
-    template <class T>
-    auto const &attr(std::string const &name) const {
-        if (name == "pos") {
+    static std::string_view _name_of(AttrName const &name) {
+        return name.name();
+    }
+
+    template <class T, class Name>
+    std::vector<T> const &_attr(Name const &name) const {
+        if (_is_pos(name)) {
             if constexpr (!std::is_same_v<T, ValT>) {
                 throw makeError<TypeError>(typeid(T), typeid(ValT), "type of primitive attribute pos");
             } else {
-                return values;
+                return values.get();
             }
         }
-        auto const &arr = attr(name);
-        if (!std::holds_alternative<std::vector<T>>(arr))
-            throw makeError<TypeError>(typeid(T), std::visit([&] (auto const &t) -> std::type_info const & { return typeid(std::decay_t<decltype(t[0])>); }, arr), "type of primitive attribute " + name);
-        return std::get<std::vector<T>>(arr);
+        auto const &arr = _attr_variant(name);
+        if (!std::holds_alternative<CowVector<T>>(arr))
+            throw makeError<TypeError>(typeid(T), std::visit([&] (auto const &t) -> std::type_info const & { return typeid(std::decay_t<decltype(t[0])>); }, arr), "type of primitive attribute " + std::string(_name_of(name)));
+        return std::get<CowVector<T>>(arr).get();
     }
 
-    template <class T>
-    auto &attr(std::string const &name) {
-        if (name == "pos") {
+    template <class T, class Name>
+    std::vector<T> &_attr(Name const &name) {
+        if (_is_pos(name)) {
             if constexpr (!std::is_same_v<T, ValT>) {
                 throw makeError<TypeError>(typeid(T), typeid(ValT), "type of primitive attribute pos");
             } else {
-                return values;
+                return values.mut();
             }
         }
-        auto &arr = attr(name);
-        if (!std::holds_alternative<std::vector<T>>(arr))
-            throw makeError<TypeError>(typeid(T), std::visit([&] (auto const &t) -> std::type_info const & { return typeid(std::decay_t<decltype(t[0])>); }, arr), "type of primitive attribute " + name);
-        return std::get<std::vector<T>>(arr);
+        auto &arr = _attr_variant(name);
+        if (!std::holds_alternative<CowVector<T>>(arr))
+            throw makeError<TypeError>(typeid(T), std::visit([&] (auto const &t) -> std::type_info const & { return typeid(std::decay_t<decltype(t[0])>); }, arr), "type of primitive attribute " + std::string(_name_of(name)));
+        return std::get<CowVector<T>>(arr).mut();
     }
 
-    // deprecated:
-    auto const &attr(std::string const &name) const {
+    template <class Name>
+    AttrVectorVariant const &_attr_variant(Name const &name) const {
         //this causes bug in primitive clip
         //reason: in primitiveClip, we will emplace back to attr by
         //means like attr<T>.emplace_back(val)
@@ -440,35 +491,151 @@ struct AttrVector {
         //attr<vec3f>("clr").emplace_back(val)
         //attr<vec3f>("pos").emplace_back(val)<---this will resize "clr" to zero first and then push_back to "pos"
         //_ensure_update();
-        auto it = attrs.find(name);
-        if (it == attrs.end())
-            throw makeError<KeyError>(name, "attribute name of primitive");
-        return it->second;
+        auto arr = attrs.lookup(name);
+        if (!arr)
+            throw makeError<KeyError>(_name_of(name), "attribute name of primitive");
+        return *arr;
+    }
+
+    template <class Name>
+    AttrVectorVariant &_attr_variant(Name const &name) {
+        auto arr = attrs.lookup(name);
+        if (!arr)
+            throw makeError<KeyError>(_name_of(name), "attribute name of primitive");
+        return *arr;
+    }
+
+    template <class T, class Name>
+    bool _attr_is(Name const &name) const {
+        if (_is_pos(name)) return std::is_same_v<T, ValT>;
+        auto arr = attrs.lookup(name);
+        return arr && std::holds_alternative<CowVector<T>>(*arr);
+    }
+
+public:
+    template <class T>
+    auto &add_attr(std::string_view name) {
+        if (!attr_is<T>(name))
+            attrs[name] = CowVector<T>(size());
+        return attr<T>(name);
+    }
+
+    template <class T>
+    auto &add_attr(AttrName const &name) {
+        if (!attr_is<T>(name))
+            attrs[name] = CowVector<T>(size());
+        return attr<T>(name);
+    }
+
+    template <class T>
+    auto &add_attr(AttrHandle<T> const &handle) {
+        return add_attr<T>(handle.name);
     }
 
     // deprecated:
-    auto &attr(std::string const &name) {
-        //_ensure_update();
-        auto it = attrs.find(name);
-        if (it == attrs.end())
-            throw makeError<KeyError>(name, "attribute name of primitive");
-        return it->second;
+    template <class T>
+    auto &add_attr(std::string_view name, T const &val) {
+        if (!attr_is<T>(name))
+            attrs[name] = CowVector<T>(size(), val);
+        return attr<T>(name);
+    }
+
+    //template <class T>
+    //auto &add_attr(std::string_view name, T const &value) {
+        //if (!attr_is<T>(name))
+            //attrs[name] = std::vector<T>(size(), value);
+        //return attr<T>(name);
+    //}
+
+    template <class T>
+    std::vector<T> const &attr(std::string_view name) const {
+        return _attr<T>(name);
+    }
+
+    template <class T>
+    std::vector<T> &attr(std::string_view name) {
+        return _attr<T>(name);
+    }
+
+    template <class T>
+    std::vector<T> const &attr(AttrName const &name) const {
+        return _attr<T>(name);
+    }
+
+    template <class T>
+    std::vector<T> &attr(AttrName const &name) {
+        return _attr<T>(name);
+    }
+
+    template <class T>
+    std::vector<T> const &attr(AttrHandle<T> const &handle) const {
+        return _attr<T>(handle.name);
+    }
+
+    template <class T>
+    std::vector<T> &attr(AttrHandle<T> const &handle) {
+        return _attr<T>(handle.name);
+    }
+
+    // the array if there is one of this name and type, nullptr otherwise
+    template <class T>
+    std::vector<T> const *find_attr(AttrHandle<T> const &handle) const {
+        if (!_attr_is<T>(handle.name))
+            return nullptr;
+        return &_attr<T>(handle.name);
+    }
+
+    template <class T>
+    std::vector<T> *find_attr(AttrHandle<T> const &handle) {
+        if (!_attr_is<T>(handle.name))
+            return nullptr;
+        return &_attr<T>(handle.name);
+    }
+
+    // deprecated:
+    auto const &attr(std::string_view name) const {
+        return _attr_variant(name);
+    }
+
+    // deprecated:
+    auto &attr(std::string_view name) {
+        return _attr_variant(name);
     }
 
-    bool has_attr(std::string const &name) const {
+    auto const &attr(AttrName const &name) const {
+        return _attr_variant(name);
+    }
+
+    auto &attr(AttrName const &name) {
+        return _attr_variant(name);
+    }
+
+    bool has_attr(std::string_view name) const {
         if (name == "pos") return true;
-        return attrs.find(name) != attrs.end();
+        return attrs.count(name) != 0;
+    }
+
+    bool has_attr(AttrName const &name) const {
+        if (name.is_pos()) return true;
+        return attrs.count(name) != 0;
     }
 
-    void erase_attr(std::string const &name) {
+    void erase_attr(std::string_view name) {
         attrs.erase(name);
     }
 
+    void erase_attr(AttrName const &name) {
+        attrs.erase(name);
+    }
+
+    template <class T>
+    bool attr_is(std::string_view name) const {
+        return _attr_is<T>(name);
+    }
+
     template <class T>
-    bool attr_is(std::string const &name) const {
-        if (name == "pos") return std::is_same_v<T, ValT>;
-        auto it = attrs.find(name);
-        return it != attrs.end() && std::holds_alternative<std::vector<T>>(it->second);
+    bool attr_is(AttrName const &name) const {
+        return _attr_is<T>(name);
     }
 
     void clear_attrs() {
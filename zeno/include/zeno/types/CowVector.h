@@ -0,0 +1,401 @@
+#pragma once
+
+#include <initializer_list>
+#include <type_traits>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <atomic>
+#include <vector>
+#include <mutex>
+
+namespace zeno {
+
+// std::vector whose copies share the elements until one of them is written to: copying
+// costs a reference count, and the first mutable access (operator[], data(), begin(),
+// resize()...) of a shared copy makes it its own elements. That first access may come
+// from several threads at once, e.g. the body of a parallel_for. References, pointers
+// and iterators from mutable access are only good until the vector is next copied, as
+// writing through them then changes the copy too; get them again after cloning. Once
+// a vector holds its elements alone, mutable access is one load, without looking at the
+// reference count, until it is copied from again; copying a vector while another thread
+// writes to it is a race, as it is for std::vector.
+template <class T>
+struct CowVector {
+    using vector_type = std::vector<T>;
+    using value_type = typename vector_type::value_type;
+    using allocator_type = typename vector_type::allocator_type;
+    using size_type = typename vector_type::size_type;
+    using difference_type = typename vector_type::difference_type;
+    using reference = typename vector_type::reference;
+    using const_reference = typename vector_type::const_reference;
+    using pointer = typename vector_type::pointer;
+    using const_pointer = typename vector_type::const_pointer;
+    using iterator = typename vector_type::iterator;
+    using const_iterator = typename vector_type::const_iterator;
+    using reverse_iterator = typename vector_type::reverse_iterator;
+    using const_reverse_iterator = typename vector_type::const_reverse_iterator;
+
+private:
+    struct Block {
+        std::atomic<size_t> refs{1};
+        vector_type vec;
+
+        template <class ...Args>
+        explicit Block(Args &&...args) : vec(std::forward<Args>(args)...) {}
+    };
+
+    std::atomic<Block *> m_block{nullptr};  // null until first written
+    // m_block's elements once found to be only ours, for mut() to skip the check;
+    // set and cleared under detach_mutex, cleared when copied from
+    mutable std::atomic<vector_type *> m_own{nullptr};
+
+    static void release(Block *block) {
+        if (block && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete block;
+    }
+
+    Block *acquire() const {
+        std::lock_guard lck(detach_mutex(this));
+        Block *block = m_block.load(std::memory_order_acquire);
+        if (block)
+            block->refs.fetch_add(1, std::memory_order_relaxed);
+        m_own.store(nullptr, std::memory_order_relaxed);
+        return block;
+    }
+
+    void reset(Block *block) {
+        m_own.store(nullptr, std::memory_order_relaxed);
+        release(m_block.exchange(block, std::memory_order_acq_rel));
+    }
+
+    static vector_type const &empty_vector() {
+        static const vector_type empty;
+        return empty;
+    }
+
+    static std::mutex &detach_mutex(void const *self) {
+        static std::mutex mutexes[64];
+        return mutexes[std::hash<void const *>{}(self) % 64];
+    }
+
+    vector_type &detach() {
+        std::lock_guard lck(detach_mutex(this));
+        Block *block = m_block.load(std::memory_order_acquire);
+        if (!block) {
+            block = new Block();
+            m_block.store(block, std::memory_order_release);
+        } else if (block->refs.load(std::memory_order_acquire) != 1) {
+            Block *copy = new Block(block->vec);
+            m_block.store(copy, std::memory_order_release);
+            release(block);
+            block = copy;
+        }
+        m_own.store(&block->vec, std::memory_order_release);
+        return block->vec;
+    }
+
+    // replaces the elements, without copying the old ones first if they are shared
+    template <class ...Args>
+    void assign_block(Args &&...args) {
+        Block *block = m_block.load(std::memory_order_acquire);
+        if (block && block->refs.load(std::memory_order_acquire) == 1)
+            block->vec = vector_type(std::forward<Args>(args)...);
+        else
+            reset(new Block(std::forward<Args>(args)...));
+    }
+
+public:
+    CowVector() = default;
+
+    explicit CowVector(size_type n) {
+        if (n)
+            m_block.store(new Block(n), std::memory_order_relaxed);
+    }
+
+    CowVector(size_type n, T const &val) {
+        if (n)
+            m_block.store(new Block(n, val), std::memory_order_relaxed);
+    }
+
+    template <class It, class = typename std::iterator_traits<It>::iterator_category>
+    CowVector(It first, It last) : m_block(new Block(first, last)) {
+    }
+
+    CowVector(std::initializer_list<T> init) : m_block(new Block(init)) {
+    }
+
+    CowVector(vector_type const &vec) : m_block(new Block(vec)) {
+    }
+
+    CowVector(vector_type &&vec) : m_block(new Block(std::move(vec))) {
+    }
+
+    CowVector(CowVector const &other) : m_block(other.acquire()) {
+    }
+
+    CowVector(CowVector &&other) noexcept : m_block(other.m_block.exchange(nullptr, std::memory_order_relaxed)) {
+        other.m_own.store(nullptr, std::memory_order_relaxed);
+    }
+
+    CowVector &operator=(CowVector const &other) {
+        if (this != &other)
+            reset(other.acquire());
+        return *this;
+    }
+
+    CowVector &operator=(CowVector &&other) noexcept {
+        if (this != &other) {
+            other.m_own.store(nullptr, std::memory_order_relaxed);
+            reset(other.m_block.exchange(nullptr, std::memory_order_relaxed));
+        }
+        return *this;
+    }
+
+    CowVector &operator=(vector_type const &vec) {
+        assign_block(vec);
+        return *this;
+    }
+
+    CowVector &operator=(vector_type &&vec) {
+        assign_block(std::move(vec));
+        return *this;
+    }
+
+    CowVector &operator=(std::initializer_list<T> init) {
+        assign_block(init);
+        return *this;
+    }
+
+    ~CowVector() {
+        release(m_block.load(std::memory_order_relaxed));
+    }
+
+    vector_type const &get() const {
+        Block *block = m_block.load(std::memory_order_acquire);
+        return block ? block->vec : empty_vector();
+    }
+
+    // the elements for writing, made this vector's own if shared
+    vector_type &mut() {
+        if (vector_type *vec = m_own.load(std::memory_order_acquire))
+            return *vec;
+        return detach();
+    }
+
+    bool is_shared() const {
+        Block *block = m_block.load(std::memory_order_acquire);
+        return block && block->refs.load(std::memory_order_acquire) != 1;
+    }
+
+    operator vector_type const &() const {
+        return get();
+    }
+
+    operator vector_type &() {
+        return mut();
+    }
+
+    size_type size() const {
+        return get().size();
+    }
+
+    bool empty() const {
+        return get().empty();
+    }
+
+    size_type capacity() const {
+        return get().capacity();
+    }
+
+    size_type max_size() const {
+        return get().max_size();
+    }
+
+    const_pointer data() const {
+        return get().data();
+    }
+
+    pointer data() {
+        return mut().data();
+    }
+
+    const_reference operator[](size_type idx) const {
+        return get()[idx];
+    }
+
+    reference operator[](size_type idx) {
+        return mut()[idx];
+    }
+
+    const_reference at(size_type idx) const {
+        return get().at(idx);
+    }
+
+    reference at(size_type idx) {
+        return mut().at(idx);
+    }
+
+    const_reference front() const {
+        return get().front();
+    }
+
+    reference front() {
+        return mut().front();
+    }
+
+    const_reference back() const {
+        return get().back();
+    }
+
+    reference back() {
+        return mut().back();
+    }
+
+    const_iterator begin() const {
+        return get().begin();
+    }
+
+    const_iterator end() const {
+        return get().end();
+    }
+
+    iterator begin() {
+        return mut().begin();
+    }
+
+    iterator end() {
+        return mut().end();
+    }
+
+    const_iterator cbegin() const {
+        return get().cbegin();
+    }
+
+    const_iterator cend() const {
+        return get().cend();
+    }
+
+    const_reverse_iterator rbegin() const {
+        return get().rbegin();
+    }
+
+    const_reverse_iterator rend() const {
+        return get().rend();
+    }
+
+    reverse_iterator rbegin() {
+        return mut().rbegin();
+    }
+
+    reverse_iterator rend() {
+        return mut().rend();
+    }
+
+    void reserve(size_type n) {
+        mut().reserve(n);
+    }
+
+    void shrink_to_fit() {
+        // a shared vector is left alone, copying it would not free anything
+        if (m_block.load(std::memory_order_relaxed) && !is_shared())
+            mut().shrink_to_fit();
+    }
+
+    void resize(size_type n) {
+        if (n != size())
+            mut().resize(n);
+    }
+
+    void resize(size_type n, T const &val) {
+        if (n != size())
+            mut().resize(n, val);
+    }
+
+    void clear() {
+        if (is_shared())
+            reset(nullptr);
+        else if (m_block.load(std::memory_order_relaxed))
+            mut().clear();
+    }
+
+    void assign(size_type n, T const &val) {
+        assign_block(n, val);
+    }
+
+    template <class It, class = typename std::iterator_traits<It>::iterator_category>
+    void assign(It first, It last) {
+        assign_block(first, last);
+    }
+
+    void assign(std::initializer_list<T> init) {
+        assign_block(init);
+    }
+
+    void push_back(T const &val) {
+        mut().push_back(val);
+    }
+
+    void push_back(T &&val) {
+        mut().push_back(std::move(val));
+    }
+
+    template <class ...Args>
+    reference emplace_back(Args &&...args) {
+        return mut().emplace_back(std::forward<Args>(args)...);
+    }
+
+    void pop_back() {
+        mut().pop_back();
+    }
+
+    // pos comes from begin() or end() of this vector, and so already points into its own elements
+    template <class ...Args>
+    iterator insert(const_iterator pos, Args &&...args) {
+        return mut().insert(pos, std::forward<Args>(args)...);
+    }
+
+    template <class ...Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        return mut().emplace(pos, std::forward<Args>(args)...);
+    }
+
+    iterator erase(const_iterator pos) {
+        return mut().erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return mut().erase(first, last);
+    }
+
+    void swap(CowVector &other) noexcept {
+        m_own.store(nullptr, std::memory_order_relaxed);
+        other.m_own.store(nullptr, std::memory_order_relaxed);
+        Block *block = other.m_block.exchange(m_block.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_block.store(block, std::memory_order_relaxed);
+    }
+
+    void swap(vector_type &vec) {
+        mut().swap(vec);
+    }
+
+    friend bool operator==(CowVector const &lhs, CowVector const &rhs) {
+        return lhs.get() == rhs.get();
+    }
+
+    friend bool operator!=(CowVector const &lhs, CowVector const &rhs) {
+        return lhs.get() != rhs.get();
+    }
+};
+
+// calls f(args..., vec) with vec for reading if f takes it by const reference, as visitors
+// written `auto const &arr` do, so that only those which may write make the elements their own
+template <class T, class F, class ...Args>
+decltype(auto) cow_visit(CowVector<T> &vec, F &&f, Args &&...args) {
+    if constexpr (std::is_invocable_v<F &, Args..., std::vector<T> &&>)
+        return f(std::forward<Args>(args)..., vec.get());
+    else
+        return f(std::forward<Args>(args)..., vec.mut());
+}
+
+}
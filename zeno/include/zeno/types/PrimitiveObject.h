@@ -147,7 +147,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class Accept = std::variant<vec3f, float>, class F>
     void foreach_attr(F &&f) {
         std::string pos_name = "pos";
-        f(pos_name, verts.values);
+        cow_visit(verts.values, f, pos_name);
         verts.foreach_attr<Accept>(std::move(f));
     }
 
@@ -155,7 +155,7 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     template <class Accept = std::variant<vec3f, float>, class F>
     void foreach_attr(F &&f) const {
         std::string const pos_name = "pos";
-        f(pos_name, verts.values);
+        f(pos_name, verts.values.get());
         verts.foreach_attr<Accept>(std::move(f));
     }
 
@@ -173,9 +173,9 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
 
     // deprecated:
     template <class T>
-    auto &add_attr(std::string const &name) {
+    auto &add_attr(std::string_view name) {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.mut();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -185,9 +185,9 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
 
     // deprecated:
     template <class T>
-    auto &add_attr(std::string const &name, T const &value) {
+    auto &add_attr(std::string_view name, T const &value) {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.mut();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -203,9 +203,9 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
 
     // deprecated:
     template <class T>
-    auto const &attr(std::string const &name) const {
+    auto const &attr(std::string_view name) const {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.get();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -215,9 +215,9 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
 
     // deprecated:
     template <class T>
-    auto &attr(std::string const &name) {
+    auto &attr(std::string_view name) {
         if constexpr (std::is_same_v<T, vec3f>) {
-            if (name == "pos") return verts.values;
+            if (name == "pos") return verts.values.mut();
         } else {
             if (name == "pos") throw makeError<TypeError>(
                 typeid(vec3f), typeid(T), "attribute 'pos' must be vec3f");
@@ -226,22 +226,22 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     }
 
     // deprecated:
-    auto const &attr(std::string const &name) const {
+    auto const &attr(std::string_view name) const {
         //if (name == "pos") return verts.values;
         return verts.attr(name);
     }
 
     // deprecated:
-    auto &attr(std::string const &name) {
+    auto &attr(std::string_view name) {
         //if (name == "pos") return verts.values;
         return verts.attr(name);
     }
 
     // deprecated:
     template <class Accept = std::variant<vec3f, float>, class F>
-    auto attr_visit(std::string const &name, F const &f) const {
+    auto attr_visit(std::string_view name, F const &f) const {
         if (name == "pos") {
-            return f(verts.values);
+            return f(verts.values.get());
         } else {
             return verts.attr_visit<Accept>(name, f);
         }
@@ -249,23 +249,23 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
 
     // deprecated:
     template <class Accept = std::variant<vec3f, float>, class F>
-    auto attr_visit(std::string const &name, F const &f) {
+    auto attr_visit(std::string_view name, F const &f) {
         if (name == "pos") {
-            return f(verts.values);
+            return cow_visit(verts.values, f);
         } else {
             return verts.attr_visit<Accept>(name, f);
         }
     }
 
     // deprecated:
-    bool has_attr(std::string const &name) const {
+    bool has_attr(std::string_view name) const {
         if (name == "pos") return true;
         return verts.has_attr(name);
     }
 
     // deprecated:
     template <class T>
-    bool attr_is(std::string const &name) const {
+    bool attr_is(std::string_view name) const {
         if constexpr (std::is_same_v<T, vec3f>) {
             if (name == "pos") return true;
         } else {
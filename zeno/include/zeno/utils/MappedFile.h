@@ -0,0 +1,40 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <filesystem>
+#include <cstddef>
+#include <vector>
+
+namespace zeno {
+
+// read-only memory mapping of a whole file, the pages are loaded lazily by
+// the OS straight from the page cache, no user space buffer is filled up front
+struct MappedFile {
+private:
+    char const *m_data = nullptr;
+    std::size_t m_size = 0;
+    void *m_handle = nullptr;     // mapping handle on Windows
+    std::vector<char> m_fallback; // used when the file can't be mapped
+
+public:
+    ZENO_API explicit MappedFile(std::filesystem::path const &path);
+    ZENO_API ~MappedFile();
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    char const *data() const {
+        return m_data;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    // false if the file can't be opened or read
+    explicit operator bool() const {
+        return m_data != nullptr;
+    }
+};
+
+}
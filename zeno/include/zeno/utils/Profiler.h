@@ -0,0 +1,67 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+
+namespace zeno {
+
+// Timeline of what each thread is busy with (node apply, requireInput, codec, cache I/O,
+// IPC), see the ZENO_PROFILE_SCOPE uses. Off unless ZENO_PROFILE=1 or setEnabled(true),
+// a scope then costs one relaxed load. Each thread records into its own ring buffer of
+// ZENO_PROFILE_SPANS (default 65536) spans, overwriting the oldest. exportChromeTrace gives
+// JSON for chrome://tracing or ui.perfetto.dev, written to ZENO_PROFILE_OUTPUT at exit if set.
+struct Profiler {
+    struct Stat {
+        std::string category;
+        std::string name;
+        std::int64_t totalNs = 0;  // including nested spans
+        std::int64_t count = 0;
+    };
+
+    static bool enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    ZENO_API static void setEnabled(bool on);
+    ZENO_API static std::int64_t now();  // ns, steady clock
+    ZENO_API static void record(const char *category, std::string_view name, std::int64_t beginNs, std::int64_t endNs);
+    ZENO_API static void clear();
+    ZENO_API static std::string exportChromeTrace();
+    ZENO_API static bool saveChromeTrace(std::string const &path);
+    // totals of the spans begun since sinceNs, by name, slowest first; category null for all
+    ZENO_API static std::vector<Stat> summarize(std::int64_t sinceNs, const char *category = nullptr);
+
+private:
+    ZENO_API static std::atomic<bool> s_enabled;
+};
+
+// category must be a string literal, name must outlive the scope
+struct ProfileScope {
+    const char *m_category = nullptr;
+    std::string_view m_name;
+    std::int64_t m_begin = 0;
+
+    ProfileScope(const char *category, std::string_view name) {
+        if (Profiler::enabled()) {
+            m_category = category;
+            m_name = name;
+            m_begin = Profiler::now();
+        }
+    }
+
+    ~ProfileScope() {
+        if (m_category)
+            Profiler::record(m_category, m_name, m_begin, Profiler::now());
+    }
+
+    ProfileScope(ProfileScope const &) = delete;
+    ProfileScope &operator=(ProfileScope const &) = delete;
+};
+
+#define ZENO_PROFILE_SCOPE(category, name) ::zeno::ProfileScope _zeno_profile_scope(category, name)
+
+}
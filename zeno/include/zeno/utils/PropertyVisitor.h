@@ -1,7 +1,7 @@
 #ifndef ZENO_PROPERTYVISITOR_H
 #define ZENO_PROPERTYVISITOR_H
 
-#include "Timer.h"
+#include "Profiler.h"
 #include <functional>
 #include <map>
 #include <optional>
@@ -352,9 +352,7 @@ namespace zeno {
 
                 log_debug("==> enter {}", myname);
                 {
-#ifdef ZENO_BENCHMARKING
-                    Timer _(myname);
-#endif
+                    ZENO_PROFILE_SCOPE("node", myname);
                     apply();
                 }
 
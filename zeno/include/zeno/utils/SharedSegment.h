@@ -0,0 +1,43 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <string>
+#include <cstddef>
+
+namespace zeno {
+
+// named POSIX shared memory, to hand large buffers over to another process
+// without pushing them through a pipe or socket; not available on Windows
+struct SharedSegment {
+private:
+    char *m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    // create == true makes a new segment of size bytes for writing, the name
+    // stays until the reader opens it; otherwise an existing one is mapped
+    // read-only and its name removed at once, so nothing is left behind
+    ZENO_API SharedSegment(std::string const &name, std::size_t size, bool create);
+    ZENO_API ~SharedSegment();
+
+    SharedSegment(SharedSegment const &) = delete;
+    SharedSegment &operator=(SharedSegment const &) = delete;
+
+    ZENO_API static bool supported();
+    // removes the segments whose names start with prefix, left over by readers that never came
+    ZENO_API static void removeAll(std::string const &prefix);
+
+    char *data() const {
+        return m_data;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    explicit operator bool() const {
+        return m_data != nullptr;
+    }
+};
+
+}
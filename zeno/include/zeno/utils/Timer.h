@@ -1,16 +1,17 @@
 #pragma once
 
-#include <chrono>
+#include <zeno/utils/Profiler.h>
+#include <zeno/utils/cformat.h>
+#include <string_view>
 #include <string>
 #include <vector>
-#include <cassert>
 
 namespace zeno {
 
+// deprecated, use ZENO_PROFILE_SCOPE: a Timer is now a span of category "timer" in the
+// profiler, so it records nothing unless profiling is on (ZENO_PROFILE=1)
 class Timer {
 public:
-    using ClockType = std::chrono::high_resolution_clock;
-
     struct Record {
         std::string tag;
         int us;
@@ -20,30 +21,35 @@ public:
     };
 
 private:
-    static Timer *current;
-    static std::vector<Record> records;
-
-    Timer *parent = nullptr;
-    ClockType::time_point beg;
-    ClockType::time_point end;
-    std::string tag;
-
-    Timer(std::string_view &&tag, ClockType::time_point &&beg);
-    void _destroy(ClockType::time_point &&end);
+    std::string tag;  // before scope, the span refers to it until it is recorded
+    ProfileScope scope;
 
 public:
-    Timer(std::string_view tag_) : Timer(std::move(tag_), ClockType::now()) {}
-    ~Timer() { _destroy(ClockType::now()); }
-
-    static auto const &getRecords() { return records; }
-    static std::string getLog();
+    Timer(std::string_view tag_) : tag(tag_), scope("timer", tag) {}
+
+    // the total time of each tag, slowest first
+    static std::vector<Record> getRecords() {
+        std::vector<Record> res;
+        for (auto &stat: Profiler::summarize(0, "timer"))
+            res.emplace_back(std::move(stat.name), int(stat.totalNs / 1000));
+        return res;
+    }
+
+    static std::string getLog() {
+        auto stats = Profiler::summarize(0, "timer");
+        if (stats.empty())
+            return "";
+        std::string res = "   avg   |  total  | cnt | tag\n";
+        for (auto const &stat: stats) {
+            res += cformat("%9d|%9d|%5d| %s\n",
+                    int(stat.totalNs / 1000 / stat.count), int(stat.totalNs / 1000),
+                    int(stat.count), stat.name.c_str());
+        }
+        return res;
+    }
 };
 
 #define ZINC_FUNC_TIMER ::zeno::Timer _zeno_timer(__func__);
 #define ZINC_PRETTY_TIMER ::zeno::Timer _zeno_timer(__PRETTY_FUNCTION__);
 
-//struct TimerAtexitHelper {
-    //~TimerAtexitHelper();
-//};
-
 }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <type_traits>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace zeno {
+
+// 64-bit FNV-1a, unlike std::hash its result is stable across processes and platforms
+// https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+struct fnv1a {
+    uint64_t value = 14695981039346656037ull;
+
+    void update(void const *data, std::size_t size) {
+        auto p = static_cast<unsigned char const *>(data);
+        for (std::size_t i = 0; i < size; i++) {
+            value ^= p[i];
+            value *= 1099511628211ull;
+        }
+    }
+
+    template <class T, std::enable_if_t<std::is_trivially_copyable_v<T>, int> = 0>
+    void add(T const &t) {
+        update(&t, sizeof(t));
+    }
+
+    void add(std::string_view s) {
+        add(s.size());
+        update(s.data(), s.size());
+    }
+
+    void add(char const *s) {
+        add(std::string_view(s));
+    }
+
+    uint64_t digest() const {
+        return value;
+    }
+};
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace zeno {
+
+// IEEE 754 binary16, for attributes that need a float's range but not its precision
+// (image channels, weights); converts to float for any arithmetic, storing rounds to
+// nearest even, out of range values become infinity
+struct half {
+    std::uint16_t bits = 0;
+
+    half() = default;
+
+    half(float f) : bits(from_float(f)) {}
+
+    operator float() const {
+        return to_float(bits);
+    }
+
+    static half from_bits(std::uint16_t bits) {
+        half h;
+        h.bits = bits;
+        return h;
+    }
+
+    half &operator+=(float f) { return *this = float(*this) + f; }
+    half &operator-=(float f) { return *this = float(*this) - f; }
+    half &operator*=(float f) { return *this = float(*this) * f; }
+    half &operator/=(float f) { return *this = float(*this) / f; }
+
+    static std::uint16_t from_float(float f) {
+        std::uint32_t x;
+        std::memcpy(&x, &f, sizeof(x));
+        std::uint32_t sign = (x >> 16) & 0x8000u;
+        std::uint32_t absx = x & 0x7fffffffu;
+        if (absx >= 0x7f800000u)  // inf or nan, keeping nan a nan
+            return std::uint16_t(sign | 0x7c00u | (absx > 0x7f800000u ? 0x200u : 0u));
+        if (absx >= 0x477ff000u)  // rounds beyond 65504
+            return std::uint16_t(sign | 0x7c00u);
+        if (absx < 0x38800000u) {  // subnormal or zero as a half
+            if (absx < 0x33000000u)
+                return std::uint16_t(sign);
+            std::uint32_t mant = (absx & 0x7fffffu) | 0x800000u;
+            int shift = 126 - int(absx >> 23);  // 14..24
+            std::uint32_t res = mant >> shift;
+            std::uint32_t rem = mant & ((1u << shift) - 1);
+            std::uint32_t halfway = 1u << (shift - 1);
+            if (rem > halfway || (rem == halfway && (res & 1)))
+                res++;
+            return std::uint16_t(sign | res);
+        }
+        std::uint32_t res = ((absx - 0x38000000u) >> 13);
+        std::uint32_t rem = absx & 0x1fffu;
+        if (rem > 0x1000u || (rem == 0x1000u && (res & 1)))
+            res++;
+        return std::uint16_t(sign | res);
+    }
+
+    static float to_float(std::uint16_t h) {
+        std::uint32_t sign = std::uint32_t(h & 0x8000u) << 16;
+        std::uint32_t exp = (h >> 10) & 0x1fu;
+        std::uint32_t mant = h & 0x3ffu;
+        std::uint32_t x;
+        if (exp == 0x1fu) {
+            x = sign | 0x7f800000u | (mant << 13);
+        } else if (exp) {
+            x = sign | ((exp + 112) << 23) | (mant << 13);
+        } else if (mant) {  // subnormal, normalize it
+            exp = 113;
+            while (!(mant & 0x400u)) {
+                mant <<= 1;
+                exp--;
+            }
+            x = sign | (exp << 23) | ((mant & 0x3ffu) << 13);
+        } else {
+            x = sign;
+        }
+        float f;
+        std::memcpy(&f, &x, sizeof(f));
+        return f;
+    }
+};
+
+}
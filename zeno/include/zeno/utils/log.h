@@ -5,6 +5,12 @@
 //#include <zeno/utils/cformat.h>
 #include <zeno/utils/format.h>
 #include <string_view>
+#include <mutex>
+
+// levels below this are compiled out, their messages are never formatted
+#ifndef ZENO_LOG_MIN_LEVEL
+#define ZENO_LOG_MIN_LEVEL 0
+#endif
 
 namespace zeno {
 
@@ -33,6 +39,28 @@ ZENO_API void set_log_stream(std::ostream &osin);
 ZENO_API bool __check_log_level(log_level_t level);
 ZENO_API void __impl_log_print(log_level_t level, source_location const &loc, std::string_view msg);
 
+// In async mode (ZENO_LOGASYNC=1 or set_log_async) a log call only formats the message
+// and pushes it to a lock-free queue of the calling thread, a background thread writes
+// them to the log stream in time order every few milliseconds. Errors are flushed before
+// log_error returns. Anything else writing to the log stream should hold lock_log_stream
+// so that it doesn't end up in the middle of a line.
+ZENO_API void set_log_async(bool async);
+ZENO_API void log_flush();
+ZENO_API std::unique_lock<std::mutex> lock_log_stream();
+
+// adds the node name and frame number to the messages logged from this thread while alive
+class log_scope {
+    std::string_view m_oldNode;
+    int m_oldFrame;
+
+public:
+    ZENO_API log_scope(std::string_view node, int frame);
+    ZENO_API ~log_scope();
+
+    log_scope(log_scope const &) = delete;
+    log_scope &operator=(log_scope const &) = delete;
+};
+
 template <class ...Args>
 void log_print(log_level_t level, __with_source_location<std::string_view> const &msg, Args &&...args) {
     if (__check_log_level(level))
@@ -42,7 +70,8 @@ void log_print(log_level_t level, __with_source_location<std::string_view> const
 #define _ZENO_PER_LOG_LEVEL(x) \
 template <class ...Args> \
 void log_##x(__with_source_location<std::string_view> const &msg, Args &&...args) { \
-    log_print(log_level_t::x, msg, std::forward<Args>(args)...); \
+    if constexpr ((int)log_level_t::x >= ZENO_LOG_MIN_LEVEL) \
+        log_print(log_level_t::x, msg, std::forward<Args>(args)...); \
 }
 /*
 template <class ...Args>
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <cstddef>
+#include <vector>
+
+namespace zeno {
+
+// compresses into the LZ4 block format (no frame header), favours speed over ratio;
+// returns an empty vector if the data doesn't compress
+ZENO_API std::vector<char> lz4_compress_block(char const *src, std::size_t size);
+
+// dst must be exactly the uncompressed size, returns false on corrupted input
+ZENO_API bool lz4_decompress_block(char const *src, std::size_t size, char *dst, std::size_t dstSize);
+
+}
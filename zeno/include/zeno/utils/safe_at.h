@@ -4,6 +4,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <type_traits>
 #include <zeno/utils/Error.h>
 #include <zeno/utils/to_string.h>
 
@@ -30,6 +31,17 @@ T &safe_at(std::map<std::string, T> &m, std::string const &key, std::string_view
 }
 
 
+// for hints that need formatting, which is then only done when the key is missing
+template <class T, class F, class = std::enable_if_t<std::is_invocable_v<F const &>>>
+T const &safe_at(std::map<std::string, T> const &m, std::string const &key, F const &msg) {
+  auto it = m.find(key);
+  if (it == m.end()) {
+    throw makeError<KeyError>(key, msg());
+  }
+  return it->second;
+}
+
+
 template <class T, class S>
 T const &safe_at(std::map<S, T> const &m, S const &key, std::string_view msg) {
   auto it = m.find(key);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace zeno {
+
+// XXH64, a fast non-cryptographic checksum (several GB/s), for large buffers like cache files
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+struct xxhash64 {
+    static constexpr uint64_t P1 = 11400714785074694791ull;
+    static constexpr uint64_t P2 = 14029467366897019727ull;
+    static constexpr uint64_t P3 = 1609587929392839161ull;
+    static constexpr uint64_t P4 = 9650029242287828579ull;
+    static constexpr uint64_t P5 = 2870177450012600261ull;
+
+    static uint64_t rotl(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static uint64_t read64(unsigned char const *p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t read32(unsigned char const *p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * P2;
+        acc = rotl(acc, 31);
+        return acc * P1;
+    }
+
+    static uint64_t mergeRound(uint64_t acc, uint64_t val) {
+        acc ^= round(0, val);
+        return acc * P1 + P4;
+    }
+
+    static uint64_t hash(void const *data, std::size_t len, uint64_t seed = 0) {
+        auto p = static_cast<unsigned char const *>(data);
+        auto end = p + len;
+        uint64_t h;
+        if (len >= 32) {
+            uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+            for (auto limit = end - 32; p <= limit; p += 32) {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = mergeRound(h, v1);
+            h = mergeRound(h, v2);
+            h = mergeRound(h, v3);
+            h = mergeRound(h, v4);
+        } else {
+            h = seed + P5;
+        }
+        h += len;
+        for (; p + 8 <= end; p += 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * P1 + P4;
+        }
+        if (p + 4 <= end) {
+            h ^= (uint64_t)read32(p) * P1;
+            h = rotl(h, 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; p++) {
+            h ^= *p * P5;
+            h = rotl(h, 11) * P1;
+        }
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+};
+
+}
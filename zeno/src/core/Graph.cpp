@@ -12,6 +12,9 @@
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/SubnetNode.h>
 #include <zeno/extra/DirtyChecker.h>
+#include <zeno/extra/EvalCache.h>
+#include <zeno/extra/GraphScheduler.h>
+#include <zeno/extra/ThreadPool.h>
 #include <zeno/utils/Error.h>
 #include <zeno/utils/log.h>
 #include <iostream>
@@ -33,7 +36,7 @@ ZENO_API zany const &Graph::getNodeOutput(
     auto node = safe_at(nodes, sn, "node name").get();
     if (node->muted_output)
         return node->muted_output;
-    return safe_at(node->outputs, ss, "output socket name of node " + node->myname);
+    return safe_at(node->outputs, ss, [&] { return "output socket name of node " + node->myname; });
 }
 
 zany Graph::getNodeInput(std::string const& sn, std::string const& ss) const {
@@ -43,6 +46,12 @@ zany Graph::getNodeInput(std::string const& sn, std::string const& ss) const {
 
 ZENO_API void Graph::clearNodes() {
     nodes.clear();
+    nodeList.clear();
+    freeNodeIndices.clear();
+    loadedSources.clear();
+    linksChanged = true;
+    if (evalCache)
+        evalCache->clear();
 }
 
 ZENO_API void Graph::addNode(std::string const &cls, std::string const &id) {
@@ -53,7 +62,44 @@ ZENO_API void Graph::addNode(std::string const &cls, std::string const &id) {
     node->graph = this;
     node->myname = id;
     node->nodeClass = cl;
+    node->nodeIndex = allocNodeIndex();
+    nodeList[node->nodeIndex] = node.get();
     nodes[id] = std::move(node);
+    linksChanged = true;
+}
+
+// slots of removed nodes are taken first, so that nodeList (and Context::visited) doesn't
+// grow with each updateGraph of a long-lived graph
+int Graph::allocNodeIndex() {
+    if (!freeNodeIndices.empty()) {
+        int index = freeNodeIndices.back();
+        freeNodeIndices.pop_back();
+        return index;
+    }
+    nodeList.emplace_back();
+    return (int)nodeList.size() - 1;
+}
+
+ZENO_API void Graph::removeNode(std::string const &id) {
+    auto it = nodes.find(id);
+    if (it == nodes.end())
+        return;
+    nodeList[it->second->nodeIndex] = nullptr;  // indices of the others stay valid
+    freeNodeIndices.push_back(it->second->nodeIndex);
+    nodes.erase(it);
+    nodesToExec.erase(id);
+    for (auto *names: {&portalIns, &subInputNodes, &subOutputNodes}) {
+        for (auto it = names->begin(); it != names->end();) {
+            if (it->second == id)
+                it = names->erase(it);
+            else
+                ++it;
+        }
+    }
+    loadedSources.erase(id);
+    if (evalCache)
+        evalCache->forget(id);
+    linksChanged = true;
 }
 
 ZENO_API Graph *Graph::addSubnetNode(std::string const &id) {
@@ -66,7 +112,14 @@ ZENO_API Graph *Graph::addSubnetNode(std::string const &id) {
     subnode->subgraph->session = this->session;
     subnode->subnetClass = std::move(subcl);
     auto subg = subnode->subgraph.get();
-    nodes[id] = std::move(node);
+    subg->parallelApply = parallelApply;
+    if (evalCache)
+        subg->evalCache = std::make_unique<EvalCache>(subg);
+    auto &slot = nodes[id];
+    node->nodeIndex = slot ? slot->nodeIndex : allocNodeIndex();
+    nodeList[node->nodeIndex] = node.get();
+    slot = std::move(node);
+    linksChanged = true;
     return subg;
 }
 
@@ -80,27 +133,66 @@ ZENO_API void Graph::completeNode(std::string const &id) {
 }
 
 ZENO_API bool Graph::applyNode(std::string const &id) {
-    if (ctx->visited.find(id) != ctx->visited.end()) {
+    return applyNode(safe_at(nodes, id, "node name").get());
+}
+
+ZENO_API bool Graph::applyNode(INode *node) {
+    if (scheduler) {
+        if (auto dirty = scheduler->applyPlannedNode(node))
+            return *dirty;
+    }
+    if (!ctx->markVisited(node->nodeIndex)) {
         return false;
     }
-    ctx->visited.insert(id);
-    auto node = safe_at(nodes, id, "node name").get();
     GraphException::translated([&] {
         node->doApply();
     }, node->myname);
-    if (dirtyChecker && dirtyChecker->amIDirty(id)) {
+    if (dirtyChecker && dirtyChecker->amIDirty(node->myname)) {
         return true;
     }
     return false;
 }
 
+ZENO_API void Graph::compileLinks() {
+    for (auto node: nodeList) {
+        if (!node)
+            continue;
+        node->inputLinks.clear();
+        for (auto const &[ds, bound]: node->inputBounds) {
+            auto it = nodes.find(bound.first);
+            node->inputLinks.push_back({&ds, &bound, it == nodes.end() ? nullptr : it->second.get()});
+        }
+    }
+    linksChanged = false;
+}
+
 ZENO_API void Graph::applyNodes(std::set<std::string> const &ids) {
     ctx = std::make_unique<Context>();
+    if (linksChanged)
+        compileLinks();
 
     scope_exit _{[&] {
         ctx = nullptr;
     }};
 
+    if (evalCache)
+        evalCache->beginApply();
+
+    // nested graphs (e.g. subnets applied by a worker) stay serial, the pool is already busy
+    if (parallelApply && !ThreadPool::inWorkerThread()) {
+        GraphScheduler sched(this, session->threadPool.get());
+        if (sched.plan(ids)) {
+            getDirtyChecker();
+            scheduler = &sched;
+            scope_exit _{[&] {
+                scheduler = nullptr;
+            }};
+            sched.run();
+            return;
+        }
+        log_debug("graph has cycles, falling back to serial apply");
+    }
+
     for (auto const &id: ids) {
         applyNode(id);
     }
@@ -114,6 +206,7 @@ ZENO_API void Graph::applyNodesToExec() {
 ZENO_API void Graph::bindNodeInput(std::string const &dn, std::string const &ds,
         std::string const &sn, std::string const &ss) {
     safe_at(nodes, dn, "node name")->inputBounds[ds] = std::pair(sn, ss);
+    linksChanged = true;
 }
 
 ZENO_API void Graph::setNodeInput(std::string const &id, std::string const &par,
@@ -160,6 +253,14 @@ ZENO_API INode* Graph::getNode(std::string const& id)
     return safe_at(nodes, id, "node name").get();
 }
 
+ZENO_API bool Graph::hasFrameState() const {
+    for (auto const &[id, node]: nodes) {
+        if (!node->isFrameIndependent())
+            return true;
+    }
+    return false;
+}
+
 ZENO_API void Graph::addNodeOutput(std::string const& id, std::string const& par) {
     // add "dynamic" output which is not descriped by core.
     safe_at(nodes, id, "node name")->outputs[par] = nullptr;
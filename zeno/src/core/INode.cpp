@@ -7,12 +7,12 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/DirtyChecker.h>
+#include <zeno/extra/EvalCache.h>
 #include <zeno/extra/TempNode.h>
 #include <zeno/utils/Error.h>
-#ifdef ZENO_BENCHMARKING
-#include <zeno/utils/Timer.h>
-#endif
+#include <zeno/utils/Profiler.h>
 #include <zeno/utils/safe_at.h>
+#include <zeno/utils/format.h>
 #include <zeno/utils/logger.h>
 #include <zeno/extra/GlobalState.h>
 #include <filesystem>
@@ -72,10 +72,33 @@ ZENO_API void INode::complete() {}
     return true;
 }*/
 
+namespace {
+
+std::optional<uint64_t> contentHash(INode *node) {
+    if (auto cache = node->graph->evalCache.get())
+        return cache->nodeHash(node->myname);
+    return std::nullopt;
+}
+
+// content addressed nodes have their hash in the file name, so that the cache
+// stays valid across runs exactly as long as their inputs don't change
+std::string tmpCacheFileName(INode *node) {
+    if (auto hash = contentHash(node))
+        return format("{}.{:016x}.zenocache", node->myname, *hash);
+    return node->myname + ".zenocache";
+}
+
+std::filesystem::path tmpCacheFrameDir() {
+    int frameid = zeno::getSession().globalState->frameid;
+    return std::filesystem::u8path(zeno::getSession().globalComm->objTmpCachePath + "/" + std::to_string(1000000 + frameid).substr(1));
+}
+
+}
+
 ZENO_API bool zeno::INode::getTmpCache()
 {
     GlobalComm::ViewObjects objs;
-    std::string fileName = myname + ".zenocache";
+    std::string fileName = tmpCacheFileName(this);
     int frameid = zeno::getSession().globalState->frameid;
     bool ret = GlobalComm::fromDisk(zeno::getSession().globalComm->objTmpCachePath, frameid, objs, fileName);
     if (ret && objs.size() > 0)
@@ -106,37 +129,56 @@ ZENO_API void zeno::INode::writeTmpCaches()
 
     }
     int frameid = zeno::getSession().globalState->frameid;
-    std::string fileName = myname + ".zenocache";
+    std::string fileName = tmpCacheFileName(this);
     GlobalComm::toDisk(zeno::getSession().globalComm->objTmpCachePath, frameid, objs, false, false, fileName);
+    if (fileName == myname + ".zenocache")
+        return;
+    // drop what was cached for earlier inputs of this node
+    std::error_code ec;
+    for (auto const &entry: std::filesystem::directory_iterator(tmpCacheFrameDir(), ec)) {
+        auto name = entry.path().filename().u8string();
+        if (name != fileName && name.size() == fileName.size()
+            && name.compare(0, myname.size() + 1, myname + ".") == 0
+            && name.compare(name.size() - 10, 10, ".zenocache") == 0) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
 }
 
 ZENO_API void INode::preApply() {
     auto& dc = graph->getDirtyChecker();
-    if (!dc.amIDirty(myname) && bTmpCache)
+    // content addressed caches can't go stale, others rely on the editor telling what has changed
+    bool dirty = !contentHash(this) && dc.amIDirty(myname);
+    if (!dirty && bTmpCache)
     {
         if (getTmpCache())
             return;
     }
-    else if (dc.amIDirty(myname) && !bTmpCache)//remove cache
+    else if (dirty && !bTmpCache)//remove cache
     {
-        std::string fileName = myname + ".zenocache";
-        int frameid = zeno::getSession().globalState->frameid;
-        const auto& path = std::filesystem::u8path(zeno::getSession().globalComm->objTmpCachePath + "/" + std::to_string(1000000 + frameid).substr(1) + "/" + fileName);
+        const auto& path = tmpCacheFrameDir() / std::filesystem::u8path(myname + ".zenocache");
         if (std::filesystem::exists(path))
         {
             std::filesystem::remove(path);
             zeno::log_info("remove cache file: {}", path.string());
         }
     }
-    for (auto const &[ds, bound]: inputBounds) {
-        requireInput(ds);
+    if (graph->linksChanged)
+        graph->compileLinks();
+    if (nodeIndex >= 0) {
+        for (auto const &link: inputLinks) {
+            requireLink(link);
+        }
+    } else {
+        for (auto const &[ds, bound]: inputBounds) {
+            requireInput(ds);
+        }
     }
 
     log_debug("==> enter {}", myname);
     {
-#ifdef ZENO_BENCHMARKING
-        Timer _(myname);
-#endif
+        ZENO_PROFILE_SCOPE("node", myname);
+        log_scope _(myname, getGlobalState()->frameid);
         apply();
         if (bTmpCache)
             writeTmpCaches();
@@ -144,17 +186,59 @@ ZENO_API void INode::preApply() {
     log_debug("==> leave {}", myname);
 }
 
+ZENO_API bool INode::hasLazyInputs() const {
+    return false;
+}
+
+ZENO_API bool INode::isThreadSafe() const {
+    return true;
+}
+
+ZENO_API bool INode::isPure() const {
+    return false;
+}
+
+ZENO_API bool INode::isFrameIndependent() const {
+    return true;
+}
+
+ZENO_API void INode::resetFrameState() {
+}
+
 ZENO_API bool INode::requireInput(std::string const &ds) {
     auto it = inputBounds.find(ds);
     if (it == inputBounds.end())
         return false;
-    auto [sn, ss] = it->second;
-    if (graph->applyNode(sn)) {
+    if (graph->linksChanged)
+        graph->compileLinks();
+    for (auto const &link: inputLinks) {
+        if (link.socket == &it->first)
+            return requireLink(link);
+    }
+    // not added to the graph, look up the source by name
+    auto src = graph->nodes.find(it->second.first);
+    return requireLink({&it->first, &it->second, src == graph->nodes.end() ? nullptr : src->second.get()});
+}
+
+bool INode::requireLink(InputLink const &link) {
+    auto const &[sn, ss] = *link.bound;
+    ZENO_PROFILE_SCOPE("input", *link.socket);
+    if (!link.source)
+        throw makeError<KeyError>(sn, "node name");
+    if (graph->applyNode(link.source)) {
         auto &dc = graph->getDirtyChecker();
         dc.taintThisNode(myname);
     }
-    auto ref = graph->getNodeOutput(sn, ss);
-    inputs[ds] = ref;
+    auto ref = link.source->muted_output ? link.source->muted_output
+        : safe_at(link.source->outputs, ss, [&] { return "output socket name of node " + sn; });
+    if (auto cache = graph->evalCache.get(); cache && ref && cache->isCachedOutput(link.source->myname, ref.get())) {
+        // this node may modify its input in-place, which must not change the cached one
+        if (auto copy = ref->clone())
+            ref = std::move(copy);
+        else
+            cache->forget(link.source->myname);
+    }
+    inputs[*link.socket] = std::move(ref);
     return true;
 }
 
@@ -163,11 +247,18 @@ ZENO_API void INode::doOnlyApply() {
 }
 
 ZENO_API void INode::doApply() {
+    auto cache = isPure() ? graph->evalCache.get() : nullptr;
+    if (cache && cache->tryRestore(this)) {
+        log_debug("==> reuse {}", myname);
+        return;
+    }
     //if (checkApplyCondition()) {
     log_trace("--> enter {}", myname);
     preApply();
     log_trace("--> leave {}", myname);
     //}
+    if (cache)
+        cache->store(this);
 
     /*if (has_option("VIEW")) {
         graph->hasAnyView = true;
@@ -198,7 +289,7 @@ ZENO_API zany INode::get_input(std::string const &id) const {
     } else if (has_formula(id)) {
         return get_formula(id);
     }
-    return safe_at(inputs, id, "input socket of node `" + myname + "`");
+    return safe_at(inputs, id, [&] { return "input socket of node `" + myname + "`"; });
 }
 
 ZENO_API zany INode::resolveInput(std::string const& id) {
@@ -219,18 +310,28 @@ ZENO_API void INode::set_output(std::string const &id, zany obj) {
     outputs[id] = std::move(obj);
 }
 
-ZENO_API bool INode::has_keyframe(std::string const &id) const {
-    return kframes.find(id) != kframes.end();
+namespace {
+
+// returns a copy of the memoized value so callers may still modify what get_input gives them
+template <class F>
+zany evaluateOncePerSubstep(INode::EvaluatedInput &memo, zany const &source, GlobalState const *gs, F const &evaluate) {
+    if (!memo.value || memo.source != source || memo.frameid != gs->frameid
+        || memo.substepid != gs->substepid || memo.frame_time_elapsed != gs->frame_time_elapsed) {
+        memo.value = nullptr;
+        auto value = evaluate();
+        memo.source = source;
+        memo.frameid = gs->frameid;
+        memo.substepid = gs->substepid;
+        memo.frame_time_elapsed = gs->frame_time_elapsed;
+        memo.value = std::move(value);
+    }
+    if (auto copy = memo.value->clone())
+        return copy;
+    return memo.value;
 }
 
-ZENO_API zany INode::get_keyframe(std::string const &id) const 
-{
-    auto value = safe_at(inputs, id, "input socket of node `" + myname + "`");
-    auto curves = dynamic_cast<zeno::CurveObject *>(value.get());
-    if (!curves) {
-        return value;
-    }
-    int frame = getGlobalState()->frameid;
+// a single curve gives a float, two to four curves named x, y, z, w give a vector
+zany evalCurvesAt(zeno::CurveObject const *curves, int frame, zany value) {
     if (curves->keys.size() == 1) {
         auto val = curves->keys.begin()->second.eval(frame);
         value = objectFromLiterial(val);
@@ -265,21 +366,45 @@ ZENO_API zany INode::get_keyframe(std::string const &id) const
     return value;
 }
 
+}
+
+ZENO_API bool INode::has_keyframe(std::string const &id) const {
+    return kframes.find(id) != kframes.end();
+}
+
+ZENO_API zany INode::get_keyframe(std::string const &id) const 
+{
+    auto value = safe_at(inputs, id, [&] { return "input socket of node `" + myname + "`"; });
+    auto curves = dynamic_cast<zeno::CurveObject *>(value.get());
+    if (!curves) {
+        return value;
+    }
+    int frame = getGlobalState()->frameid;
+    return evaluateOncePerSubstep(evaluatedInputs[id], value, getGlobalState(), [&] {
+        return evalCurvesAt(curves, frame, value);
+    });
+}
+
 ZENO_API bool INode::has_formula(std::string const &id) const {
     return formulas.find(id) != formulas.end();
 }
 
 ZENO_API zany INode::get_formula(std::string const &id) const 
 {
-    auto value = safe_at(inputs, id, "input socket of node `" + myname + "`");
-    if (auto formulas = dynamic_cast<zeno::StringObject *>(value.get())) 
-    {
+    auto value = safe_at(inputs, id, [&] { return "input socket of node `" + myname + "`"; });
+    auto formulas = dynamic_cast<zeno::StringObject *>(value.get());
+    if (!formulas) {
+        return value;
+    }
+    auto &memo = evaluatedInputs[id];
+    auto evaluate = [&] {
         std::string code = formulas->get();
+        std::map<std::string, zany> args;
+        std::string evalNode;
         if (code.find("=") == 0)
         { 
             code.replace(0, 1, "");
-            auto res = getThisGraph()->callTempNode("StringEval", { {"zfxCode", objectFromLiterial(code)} }).at("result");
-            value = objectFromLiterial(std::move(res));
+            evalNode = "StringEval";
         }
         else
         {
@@ -291,11 +416,22 @@ ZENO_API zany INode::get_formula(std::string const &id) const
             else {
                 resType = "float";
             }
-            auto res = getThisGraph()->callTempNode("NumericEval", { {"zfxCode", objectFromLiterial(code)}, {"resType", objectFromLiterial(resType)} }).at("result");
-            value = objectFromLiterial(std::move(res));
+            evalNode = "NumericEval";
+            args["resType"] = objectFromLiterial(resType);
         }
-    }     
-    return value;
+        args["zfxCode"] = objectFromLiterial(code);
+        if (memo.formula)
+            args["formula"] = memo.formula;
+        auto res = getThisGraph()->callTempNode(evalNode, std::move(args));
+        auto it = res.find("formula");
+        memo.formula = it != res.end() ? it->second : nullptr;
+        return res.at("result");
+    };
+    // ref(node/param) reads an input of another node, which may change within a substep, as
+    // in the iterations of a loop or a subnet called twice, so only the compiled formula is kept
+    if (formulas->get().find("ref(") != std::string::npos)
+        return evaluate();
+    return evaluateOncePerSubstep(memo, value, getGlobalState(), evaluate);
 }
 
 ZENO_API TempNodeCaller INode::temp_node(std::string const &id) {
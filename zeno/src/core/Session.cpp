@@ -4,12 +4,15 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/EventCallbacks.h>
+#include <zeno/extra/ThreadPool.h>
+#include <zeno/extra/EvalCache.h>
 #include <zeno/types/UserData.h>
 #include <zeno/core/Graph.h>
 #include <zeno/core/INode.h>
 #include <zeno/utils/safe_at.h>
 #include <zeno/utils/logger.h>
 #include <zeno/utils/string.h>
+#include <zeno/utils/envconfig.h>
 #include "rapidjson/document.h"
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
@@ -37,10 +40,19 @@ ZENO_API Session::Session()
     , globalStatus(std::make_unique<GlobalStatus>())
     , eventCallbacks(std::make_unique<EventCallbacks>())
     , m_userData(std::make_unique<UserData>())
+    , threadPool(std::make_unique<ThreadPool>())
     {
 }
 
-ZENO_API Session::~Session() = default;
+ZENO_API Session::~Session() {
+    // the frame cache writer encodes on our thread pool, which goes away first
+    globalComm->waitFrameCacheWritten();
+}
+
+ZENO_API void Session::setThreads(std::size_t numThreads, bool pinThreads) {
+    threadPool->configure(numThreads, pinThreads);
+    eventCallbacks->triggerEvent("threadsConfigured");
+}
 
 ZENO_API void Session::defNodeClass(std::unique_ptr<INode>(*ctor)(), std::string const &id, Descriptor const &desc) {
     if (nodeClasses.find(id) != nodeClasses.end()) {
@@ -102,6 +114,9 @@ ZENO_API INodeClass::~INodeClass() = default;
 ZENO_API std::shared_ptr<Graph> Session::createGraph() {
     auto graph = std::make_shared<Graph>();
     graph->session = const_cast<Session *>(this);
+    graph->parallelApply = envconfig::getBool("PARALLEL_GRAPH");
+    if (envconfig::getBool("EVAL_CACHE", true))
+        graph->evalCache = std::make_unique<EvalCache>(graph.get());
     return graph;
 }
 
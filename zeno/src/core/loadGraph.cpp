@@ -1,22 +1,106 @@
 #include <zeno/core/Graph.h>
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 #include <zeno/funcs/LiterialConverter.h>
 #include <zeno/funcs/ParseObjectFromUi.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/extra/DirtyChecker.h>
+#include <zeno/utils/Profiler.h>
 #include <zeno/utils/logger.h>
 #include <zeno/utils/vec.h>
 #include <zeno/utils/zeno_p.h>
 #include <zeno/zeno.h>
+#include <unordered_map>
+#include <string_view>
+#include <climits>
 #include <stack>
+#include <set>
 
 namespace zeno {
 
 using namespace rapidjson;
 
+namespace {
+
+enum class GraphCommand {
+    unknown,
+    addNode,
+    setNodeInput,
+    setKeyFrame,
+    setFormula,
+    setNodeParam,
+    bindNodeInput,
+    completeNode,
+    addSubnetNode,
+    addNodeOutput,
+    pushSubnetScope,
+    popSubnetScope,
+    setBeginFrameNumber,
+    setEndFrameNumber,
+    setNodeOption,
+    markNodeChanged,
+    cacheToDisk,
+};
+
+GraphCommand lookupCommand(std::string_view name) {
+    static const std::unordered_map<std::string_view, GraphCommand> lut = {
+        {"addNode", GraphCommand::addNode},
+        {"setNodeInput", GraphCommand::setNodeInput},
+        {"setKeyFrame", GraphCommand::setKeyFrame},
+        {"setFormula", GraphCommand::setFormula},
+        {"setNodeParam", GraphCommand::setNodeParam},
+        {"bindNodeInput", GraphCommand::bindNodeInput},
+        {"completeNode", GraphCommand::completeNode},
+        {"addSubnetNode", GraphCommand::addSubnetNode},
+        {"addNodeOutput", GraphCommand::addNodeOutput},
+        {"pushSubnetScope", GraphCommand::pushSubnetScope},
+        {"popSubnetScope", GraphCommand::popSubnetScope},
+        {"setBeginFrameNumber", GraphCommand::setBeginFrameNumber},
+        {"setEndFrameNumber", GraphCommand::setEndFrameNumber},
+        {"setNodeOption", GraphCommand::setNodeOption},
+        {"markNodeChanged", GraphCommand::markNodeChanged},
+        {"cacheToDisk", GraphCommand::cacheToDisk},
+    };
+    auto it = lut.find(name);
+    return it == lut.end() ? GraphCommand::unknown : it->second;
+}
+
+// one argument of a command, as read from the SAX events
+struct GraphArg {
+    enum Kind {
+        Unknown,
+        Bool,
+        Int,
+        Float,
+        String,
+        Array,   // of numbers, becomes a vec
+        Object,  // its JSON text in str, for parseObjectFromUi
+    } kind = Unknown;
+
+    bool b = false;
+    int i = 0;
+    float f = 0;
+    std::string str;
+    std::vector<double> arr;
+    bool arrIsInt = false;  // the first element decides, like before
+
+    std::string const &getString() const {
+        if (kind != String)
+            throw makeError("expect a string argument in graph command");
+        return str;
+    }
+
+    int getInt() const {
+        if (kind != Int)
+            throw makeError("expect an integer argument in graph command");
+        return i;
+    }
+};
+
 template <class T, bool HasVec = true>
-static T generic_get(Value const &x) {
+T generic_get(GraphArg const &x) {
     auto cast = [&] {
         if constexpr (std::is_same_v<T, zany>) {
             return [&] (auto &&x) -> zany {
@@ -26,109 +110,488 @@ static T generic_get(Value const &x) {
             return [&] (auto &&x) { return x; };
         };
     }();
-    if (x.IsString()) {
-        return cast((std::string)x.GetString());
-    } else if (x.IsInt()) {
-        return cast(x.GetInt());
-    } else if (x.IsDouble()) {
-        return cast((float)x.GetDouble());
-    } else if (x.IsBool()) {
-        return cast(x.GetBool());
-    } else {
-        if (x.IsObject()) {
-            return parseObjectFromUi(x.GetObject());
-        }
+    switch (x.kind) {
+    case GraphArg::String:
+        return cast(x.str);
+    case GraphArg::Int:
+        return cast(x.i);
+    case GraphArg::Float:
+        return cast(x.f);
+    case GraphArg::Bool:
+        return cast(x.b);
+    case GraphArg::Object: {
+        Document d;
+        d.Parse(x.str.data(), x.str.size());
+        return parseObjectFromUi(d);
+    }
+    case GraphArg::Array:
         if constexpr (HasVec) {
-            if (x.IsArray()) {
-                auto a = x.GetArray();
-                if (a.Size() == 2) {
-                    if (a[0].IsInt()) {
-                        return cast(vec2i(a[0].GetInt(), a[1].GetInt()));
-                    } else if (a[0].IsDouble()) {
-                        return cast(vec2f(a[0].GetDouble(), a[1].GetDouble()));
-                    }
-                } else if (a.Size() == 3) {
-                    if (a[0].IsInt()) {
-                        return cast(vec3i(a[0].GetInt(), a[1].GetInt(), a[2].GetInt()));
-                    } else if (a[0].IsDouble()) {
-                        return cast(vec3f(a[0].GetDouble(), a[1].GetDouble(), a[2].GetDouble()));
-                    }
-                } else if (a.Size() == 4) {
-                    if (a[0].IsInt()) {
-                        return cast(vec4i(a[0].GetInt(), a[1].GetInt(), a[2].GetInt(), a[3].GetInt()));
-                    } else if (a[0].IsDouble()) {
-                        return cast(vec4f(a[0].GetDouble(), a[1].GetDouble(), a[2].GetDouble(), a[3].GetDouble()));
-                    }
-                }
+            auto const &a = x.arr;
+            if (a.size() == 2) {
+                if (x.arrIsInt)
+                    return cast(vec2i(a[0], a[1]));
+                else
+                    return cast(vec2f(a[0], a[1]));
+            } else if (a.size() == 3) {
+                if (x.arrIsInt)
+                    return cast(vec3i(a[0], a[1], a[2]));
+                else
+                    return cast(vec3f(a[0], a[1], a[2]));
+            } else if (a.size() == 4) {
+                if (x.arrIsInt)
+                    return cast(vec4i(a[0], a[1], a[2], a[3]));
+                else
+                    return cast(vec4f(a[0], a[1], a[2], a[3]));
             }
         }
+        [[fallthrough]];
+    default:
         log_warn("unknown type encountered in generic_get");
         return cast(0);
     }
 }
 
-ZENO_API void Graph::loadGraph(const char *json) {
-    Document d;
-    d.Parse(json);
+// Runs the commands of a graph program as they are parsed, instead of building the
+// whole DOM first: the program is an array of commands, each an array of the command
+// name and its arguments, see GraphCommand.
+struct GraphProgramHandler : BaseReaderHandler<UTF8<>, GraphProgramHandler> {
+    Graph *root;
+    Graph *g;
+    std::stack<Graph *> gStack;
 
-    if (!d.IsArray()) {
-        throw GraphException { "None", nullptr };
+    int depth = 0;         // of arrays and objects around the current event
+    std::vector<GraphArg> args;
+    size_t nargs = 0;      // args are reused between commands, only the first nargs are valid
+    bool inVec = false;    // in an array argument
+    int skipDepth = 0;     // in something nested deeper than a command takes, ignored
+    int objectDepth = 0;   // in an object argument, being copied to objectWriter
+    StringBuffer objectBuf;
+    Writer<StringBuffer> objectWriter;
+
+    explicit GraphProgramHandler(Graph *root) : root(root), g(root) {
     }
 
-    Graph *g = this;
-    std::stack<Graph *> gStack;
+    GraphArg &newArg(GraphArg::Kind kind) {
+        if (nargs == args.size())
+            args.emplace_back();
+        GraphArg &arg = args[nargs++];
+        arg.kind = kind;
+        return arg;
+    }
+
+    bool value(GraphArg::Kind kind, bool b, int i, double f, const char *s = nullptr, SizeType len = 0) {
+        if (depth == 2) {
+            GraphArg &arg = newArg(kind);
+            arg.b = b;
+            arg.i = i;
+            arg.f = (float)f;
+            if (s)
+                arg.str.assign(s, len);
+        } else if (depth == 3 && inVec && !skipDepth) {
+            GraphArg &arg = args[nargs - 1];
+            if (kind != GraphArg::Int && kind != GraphArg::Float) {
+                arg.kind = GraphArg::Unknown;
+            } else {
+                if (arg.arr.empty())
+                    arg.arrIsInt = kind == GraphArg::Int;
+                arg.arr.push_back(kind == GraphArg::Int ? i : f);
+            }
+        } else if (depth < 2) {
+            return false;  // not an array of commands
+        }
+        return true;
+    }
+
+    bool Null() {
+        if (objectDepth) return objectWriter.Null();
+        return value(GraphArg::Unknown, false, 0, 0);
+    }
+
+    bool Bool(bool b) {
+        if (objectDepth) return objectWriter.Bool(b);
+        return value(GraphArg::Bool, b, 0, 0);
+    }
+
+    bool Int(int i) {
+        if (objectDepth) return objectWriter.Int(i);
+        return value(GraphArg::Int, false, i, i);
+    }
+
+    bool Uint(unsigned u) {
+        if (objectDepth) return objectWriter.Uint(u);
+        if (u > INT_MAX)
+            return value(GraphArg::Unknown, false, 0, 0);
+        return value(GraphArg::Int, false, (int)u, u);
+    }
+
+    bool Int64(int64_t i) {
+        if (objectDepth) return objectWriter.Int64(i);
+        return value(GraphArg::Unknown, false, 0, 0);
+    }
+
+    bool Uint64(uint64_t u) {
+        if (objectDepth) return objectWriter.Uint64(u);
+        return value(GraphArg::Unknown, false, 0, 0);
+    }
+
+    bool Double(double d) {
+        if (objectDepth) return objectWriter.Double(d);
+        return value(GraphArg::Float, false, 0, d);
+    }
+
+    bool String(const char *s, SizeType len, bool copy) {
+        if (objectDepth) return objectWriter.String(s, len, copy);
+        return value(GraphArg::String, false, 0, 0, s, len);
+    }
+
+    bool Key(const char *s, SizeType len, bool copy) {
+        if (objectDepth) return objectWriter.Key(s, len, copy);
+        return true;
+    }
+
+    bool StartObject() {
+        if (objectDepth) {
+            objectDepth++;
+            return objectWriter.StartObject();
+        }
+        if (depth < 2)
+            return false;
+        depth++;
+        if (depth == 3) {
+            newArg(GraphArg::Object);
+            objectBuf.Clear();
+            objectWriter.Reset(objectBuf);
+            objectDepth = 1;
+            return objectWriter.StartObject();
+        }
+        if (depth == 4 && inVec)
+            args[nargs - 1].kind = GraphArg::Unknown;
+        skipDepth++;
+        return true;
+    }
+
+    bool EndObject(SizeType count) {
+        if (objectDepth) {
+            bool ok = objectWriter.EndObject(count);
+            if (--objectDepth == 0) {
+                args[nargs - 1].str.assign(objectBuf.GetString(), objectBuf.GetSize());
+                depth--;
+            }
+            return ok;
+        }
+        depth--;
+        skipDepth--;
+        return true;
+    }
+
+    bool StartArray() {
+        if (objectDepth) {
+            objectDepth++;
+            return objectWriter.StartArray();
+        }
+        depth++;
+        if (depth == 2) {
+            nargs = 0;
+        } else if (depth == 3) {
+            GraphArg &arg = newArg(GraphArg::Array);
+            arg.arr.clear();
+            inVec = true;
+        } else if (depth > 3) {
+            if (depth == 4)
+                args[nargs - 1].kind = GraphArg::Unknown;
+            skipDepth++;
+        }
+        return true;
+    }
 
-    for (int i = 0; i < d.Size(); i++) {
-        Value const &di = d[i];
-        std::string cmd = di[0].GetString();
-        const char *maybeNodeName = cmd == "addNode" ? di[2].GetString() : (
-            di.Size() >= 1 && di[1].IsString() ? di[1].GetString() : "(not a node)");
-        //ZENO_P(cmd);
-        //ZENO_P(maybeNodeName);
+    bool EndArray(SizeType count) {
+        if (objectDepth) {
+            objectDepth--;
+            return objectWriter.EndArray(count);
+        }
+        if (depth == 2) {
+            run();
+        } else if (depth == 3) {
+            inVec = false;
+        } else if (depth > 3) {
+            skipDepth--;
+        }
+        depth--;
+        return true;
+    }
+
+    GraphArg const &arg(size_t i) const {
+        if (i >= nargs)
+            throw makeError("too few arguments for graph command");
+        return args[i];
+    }
+
+    void run() {
+        if (!nargs || args[0].kind != GraphArg::String)
+            return;
+        auto const &name = args[0].str;
+        auto cmd = lookupCommand(name);
+        std::string const &maybeNodeName = cmd == GraphCommand::addNode && nargs > 2 && args[2].kind == GraphArg::String
+            ? args[2].str : nargs > 1 && args[1].kind == GraphArg::String ? args[1].str : notANode();
         GraphException::translated([&] {
-            if (0) {
-            } else if (cmd == "addNode") {
-                g->addNode(di[1].GetString(), di[2].GetString());
-            } else if (cmd == "setNodeInput") {
-                g->setNodeInput(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
-            } else if (cmd == "setKeyFrame") {
-                g->setKeyFrame(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
-            } else if (cmd == "setFormula") {
-                g->setFormula(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
-            } else if (cmd == "setNodeParam") {
-                g->setNodeParam(di[1].GetString(), di[2].GetString(), generic_get<std::variant<int, float, std::string, zany>, false>(di[3]));
-            } else if (cmd == "bindNodeInput") {
-                g->bindNodeInput(di[1].GetString(), di[2].GetString(), di[3].GetString(), di[4].GetString());
-            } else if (cmd == "completeNode") {
-                g->completeNode(di[1].GetString());
-            } else if (cmd == "addSubnetNode") {
-                auto newG = g->addSubnetNode(/*di[1].GetString(), */di[2].GetString());
-            } else if (cmd == "addNodeOutput") {
-                g->addNodeOutput(di[1].GetString(), di[2].GetString());
-            } else if (cmd == "pushSubnetScope") {
+            switch (cmd) {
+            case GraphCommand::addNode:
+                g->addNode(arg(1).getString(), arg(2).getString());
+                break;
+            case GraphCommand::setNodeInput:
+                g->setNodeInput(arg(1).getString(), arg(2).getString(), generic_get<zany>(arg(3)));
+                break;
+            case GraphCommand::setKeyFrame:
+                g->setKeyFrame(arg(1).getString(), arg(2).getString(), generic_get<zany>(arg(3)));
+                break;
+            case GraphCommand::setFormula:
+                g->setFormula(arg(1).getString(), arg(2).getString(), generic_get<zany>(arg(3)));
+                break;
+            case GraphCommand::setNodeParam:
+                g->setNodeParam(arg(1).getString(), arg(2).getString(), generic_get<std::variant<int, float, std::string, zany>, false>(arg(3)));
+                break;
+            case GraphCommand::bindNodeInput:
+                g->bindNodeInput(arg(1).getString(), arg(2).getString(), arg(3).getString(), arg(4).getString());
+                break;
+            case GraphCommand::completeNode:
+                g->completeNode(arg(1).getString());
+                break;
+            case GraphCommand::addSubnetNode:
+                g->addSubnetNode(/*arg(1).getString(), */arg(2).getString());
+                break;
+            case GraphCommand::addNodeOutput:
+                g->addNodeOutput(arg(1).getString(), arg(2).getString());
+                break;
+            case GraphCommand::pushSubnetScope:
                 gStack.push(g);
-                g = g->getSubnetGraph(di[1].GetString());
-            } else if (cmd == "popSubnetScope") {
+                g = g->getSubnetGraph(arg(1).getString());
+                break;
+            case GraphCommand::popSubnetScope:
                 g = gStack.top();
                 gStack.pop();
-            } else if (cmd == "setBeginFrameNumber") {
-                this->beginFrameNumber = di[1].GetInt();
-            } else if (cmd == "setEndFrameNumber") {
-                this->endFrameNumber = di[1].GetInt();
-            } else if (cmd == "setNodeOption") {
+                break;
+            case GraphCommand::setBeginFrameNumber:
+                root->beginFrameNumber = arg(1).getInt();
+                break;
+            case GraphCommand::setEndFrameNumber:
+                root->endFrameNumber = arg(1).getInt();
+                break;
+            case GraphCommand::setNodeOption:
                 // skip this for compatibility
-            } else if (cmd == "markNodeChanged") {
-                auto ident = di[1].GetString();
+                break;
+            case GraphCommand::markNodeChanged: {
                 auto &dc = g->getDirtyChecker();
-                dc.taintThisNode(ident);
+                dc.taintThisNode(arg(1).getString());
                 //todo: mark node data change.
-            } else if (cmd == "cacheToDisk") {
-                g->setTempCache(di[1].GetString());
-            } else {
-                log_warn("got unexpected command: {}", cmd);
+            } break;
+            case GraphCommand::cacheToDisk:
+                g->setTempCache(arg(1).getString());
+                break;
+            default:
+                log_warn("got unexpected command: {}", name);
+                break;
             }
         }, maybeNodeName);
     }
+
+    static std::string const &notANode() {
+        static const std::string name = "(not a node)";
+        return name;
+    }
+};
+
+// Splits a graph program into the commands of each node as they are parsed, for
+// Graph::updateGraph to tell which nodes changed. The commands are kept as their text,
+// comma separated; a subnet owns everything in its scope.
+struct GraphProgramSplitter : BaseReaderHandler<UTF8<>, GraphProgramSplitter> {
+    const char *json;
+    StringStream ss;
+    std::map<std::string, std::string> blocks;  // by node name
+    std::vector<std::string> order;             // the node names, as they first appear
+    std::string global;                         // the frame range
+    std::string changed;                        // markNodeChanged
+
+    int depth = 0;
+    size_t cmdBegin = 0;
+    size_t nargs = 0;
+    std::string args[3];  // the leading string arguments of the current command, that name it
+    std::string scopeOwner;
+    int scopeDepth = 0;
+
+    explicit GraphProgramSplitter(const char *json) : json(json), ss(json) {
+    }
+
+    bool value(const char *s = nullptr, SizeType len = 0) {
+        if (depth < 2)
+            return false;  // not an array of commands
+        if (depth == 2) {
+            if (nargs < std::size(args))
+                args[nargs].assign(s ? s : "", s ? len : 0);
+            nargs++;
+        }
+        return true;
+    }
+
+    bool Null() { return value(); }
+    bool Bool(bool) { return value(); }
+    bool Int(int) { return value(); }
+    bool Uint(unsigned) { return value(); }
+    bool Int64(int64_t) { return value(); }
+    bool Uint64(uint64_t) { return value(); }
+    bool Double(double) { return value(); }
+    bool String(const char *s, SizeType len, bool) { return value(s, len); }
+    bool Key(const char *, SizeType, bool) { return true; }
+
+    bool StartObject() {
+        if (!value())
+            return false;
+        depth++;
+        return true;
+    }
+
+    bool EndObject(SizeType) {
+        depth--;
+        return true;
+    }
+
+    bool StartArray() {
+        if (depth >= 2)
+            value();
+        depth++;
+        if (depth == 2) {
+            cmdBegin = ss.Tell() - 1;  // the '[' was just taken
+            nargs = 0;
+        }
+        return true;
+    }
+
+    bool EndArray(SizeType) {
+        if (depth == 2)
+            split(std::string_view(json + cmdBegin, ss.Tell() - cmdBegin));
+        depth--;
+        return true;
+    }
+
+    std::string const &arg(size_t i) const {
+        static const std::string none;
+        return i < nargs && i < std::size(args) ? args[i] : none;
+    }
+
+    void split(std::string_view cmd) {
+        auto c = lookupCommand(arg(0));
+        std::string *block = &global;
+        if (scopeDepth) {
+            block = &blocks.at(scopeOwner);
+            if (c == GraphCommand::pushSubnetScope)
+                scopeDepth++;
+            else if (c == GraphCommand::popSubnetScope)
+                scopeDepth--;
+        } else if (c == GraphCommand::markNodeChanged) {
+            block = &changed;
+        } else if (c != GraphCommand::setBeginFrameNumber && c != GraphCommand::setEndFrameNumber) {
+            auto const &id = c == GraphCommand::addNode || c == GraphCommand::addSubnetNode ? arg(2) : arg(1);
+            if (!id.empty()) {
+                auto [it, inserted] = blocks.try_emplace(id);
+                if (inserted)
+                    order.push_back(id);
+                block = &it->second;
+                if (c == GraphCommand::pushSubnetScope) {
+                    scopeOwner = id;
+                    scopeDepth = 1;
+                }
+            }
+        }
+        if (!block->empty())
+            *block += ',';
+        block->append(cmd);
+    }
+};
+
+}
+
+ZENO_API void Graph::loadGraph(const char *json) {
+    ZENO_PROFILE_SCOPE("graph", "loadGraph");
+    GraphProgramHandler handler(this);
+    Reader reader;
+    StringStream ss(json);
+    if (!reader.Parse(ss, handler)) {
+        log_error("graph program is not an array of commands, stopped at offset {}", reader.GetErrorOffset());
+        throw GraphException { "None", nullptr };
+    }
+}
+
+ZENO_API void Graph::updateGraph(const char *json) {
+    ZENO_PROFILE_SCOPE("graph", "updateGraph");
+    GraphProgramSplitter splitter(json);
+    Reader reader;
+    if (!reader.Parse(splitter.ss, splitter)) {
+        log_error("graph program is not an array of commands, stopped at offset {}", reader.GetErrorOffset());
+        throw GraphException { "None", nullptr };
+    }
+    auto &blocks = splitter.blocks;
+    auto &order = splitter.order;
+
+    auto &dc = getDirtyChecker();
+    {
+        std::lock_guard lck(dc.mtx);
+        dc.dirts.clear();  // only what this program marks changed
+    }
+    std::vector<std::string> removed;
+    for (auto const &[id, source]: loadedSources) {
+        if (!blocks.count(id))
+            removed.push_back(id);
+    }
+    std::set<std::string> reload(removed.begin(), removed.end());
+    for (auto const &id: order) {
+        if (auto it = loadedSources.find(id); it == loadedSources.end() || it->second != blocks.at(id) || !nodes.count(id))
+            reload.insert(id);
+    }
+    // a kept node reading from a reloaded one would hand out what it computed from the
+    // old inputs, so reload it too
+    for (bool grown = true; grown;) {
+        grown = false;
+        for (auto const &[id, node]: nodes) {
+            if (reload.count(id))
+                continue;
+            for (auto const &[ds, bound]: node->inputBounds) {
+                if (reload.count(bound.first)) {
+                    reload.insert(id);
+                    grown = true;
+                    break;
+                }
+            }
+        }
+    }
+    for (auto const &id: removed)
+        removeNode(id);
+    // the commands of the reloaded nodes, then the global ones, run as a single program
+    std::string program = "[";
+    auto append = [&] (std::string const &cmds) {
+        if (cmds.empty())
+            return;
+        if (program.size() > 1)
+            program += ',';
+        program += cmds;
+    };
+    size_t numKept = 0;
+    for (auto const &id: order) {
+        if (!reload.count(id)) {
+            // a run starts over from its first frame, so the kept nodes forget what the frames
+            // of the last run left in them (CachedOnce, ObjTimeShift, solvers...)
+            nodes.at(id)->resetFrameState();
+            numKept++;
+            continue;
+        }
+        removeNode(id);
+        append(blocks.at(id));
+        dc.taintThisNode(id);
+    }
+    append(splitter.global);
+    append(splitter.changed);
+    program += ']';
+    loadGraph(program.c_str());
+    loadedSources = std::move(blocks);
+    log_debug("updated graph: {} nodes kept, {} loaded, {} removed", numKept, order.size() - numKept, removed.size());
 }
 
 }
@@ -0,0 +1,150 @@
+#include <zeno/extra/EvalCache.h>
+#include <zeno/core/Graph.h>
+#include <zeno/core/INode.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/types/DummyObject.h>
+#include <zeno/utils/fnv1a.h>
+#include <zeno/utils/log.h>
+#include <typeinfo>
+#include <variant>
+
+namespace zeno {
+
+namespace {
+
+bool hashLiterial(fnv1a &h, IObject const *obj) {
+    if (!obj) {
+        h.add(0);
+    } else if (auto num = dynamic_cast<NumericObject const *>(obj)) {
+        h.add(1);
+        h.add(num->value.index());
+        std::visit([&] (auto const &val) {
+            h.add(val);
+        }, num->value);
+    } else if (auto str = dynamic_cast<StringObject const *>(obj)) {
+        h.add(2);
+        h.add(std::string_view(str->value));
+    } else if (dynamic_cast<DummyObject const *>(obj)) {
+        h.add(3);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}
+
+ZENO_API EvalCache::EvalCache(Graph *graph) : m_graph(graph) {}
+ZENO_API EvalCache::~EvalCache() = default;
+
+ZENO_API void EvalCache::beginApply() {
+    std::lock_guard lck(m_mtx);
+    m_hashes.clear();
+}
+
+ZENO_API void EvalCache::clear() {
+    std::lock_guard lck(m_mtx);
+    m_hashes.clear();
+    m_entries.clear();
+}
+
+ZENO_API void EvalCache::forget(std::string const &id) {
+    std::lock_guard lck(m_mtx);
+    m_hashes.erase(id);
+    m_entries.erase(id);
+}
+
+std::optional<uint64_t> EvalCache::computeHash(INode *node) {
+    if (!node->isPure())
+        return std::nullopt;
+    fnv1a h;
+    h.add(typeid(*node).name());
+    try {
+        for (auto const &[id, _]: node->inputs) {
+            if (node->inputBounds.find(id) != node->inputBounds.end())
+                continue;  // value left over from the last requireInput
+            h.add(std::string_view(id));
+            if (!hashLiterial(h, node->get_input(id).get()))
+                return std::nullopt;
+        }
+    } catch (std::exception const &e) {
+        // e.g. a bad formula, leave it to apply to report
+        log_debug("can't hash inputs of {}: {}", node->myname, e.what());
+        return std::nullopt;
+    }
+    for (auto const &[ds, bound]: node->inputBounds) {
+        auto hash = nodeHash(bound.first);
+        if (!hash)
+            return std::nullopt;
+        h.add(std::string_view(ds));
+        h.add(std::string_view(bound.second));
+        h.add(*hash);
+    }
+    return h.digest();
+}
+
+ZENO_API std::optional<uint64_t> EvalCache::nodeHash(std::string const &id) {
+    {
+        std::lock_guard lck(m_mtx);
+        auto [it, inserted] = m_hashes.try_emplace(id, std::nullopt);
+        if (!inserted)
+            return it->second;  // also breaks cycles, they are not addressable
+    }
+    auto it = m_graph->nodes.find(id);
+    if (it == m_graph->nodes.end())
+        return std::nullopt;
+    auto hash = computeHash(it->second.get());
+    std::lock_guard lck(m_mtx);
+    m_hashes[id] = hash;
+    return hash;
+}
+
+ZENO_API bool EvalCache::tryRestore(INode *node) {
+    auto hash = nodeHash(node->myname);
+    if (!hash)
+        return false;
+    std::map<std::string, zany> outputs;
+    {
+        std::lock_guard lck(m_mtx);
+        auto it = m_entries.find(node->myname);
+        if (it == m_entries.end() || it->second.hash != *hash)
+            return false;
+        outputs = it->second.outputs;
+    }
+    // the very objects, INode::requireLink copies them for the nodes taking them as input
+    for (auto const &[id, obj]: outputs) {
+        node->set_output(id, obj);
+    }
+    return true;
+}
+
+ZENO_API void EvalCache::store(INode *node) {
+    auto hash = nodeHash(node->myname);
+    if (!hash) {
+        std::lock_guard lck(m_mtx);
+        m_entries.erase(node->myname);
+        return;
+    }
+    Entry entry;
+    entry.hash = *hash;
+    // not copied here, nor in tryRestore, but only by requireLink when a node takes
+    // one of them as input, see isCachedOutput
+    entry.outputs = node->outputs;
+    std::lock_guard lck(m_mtx);
+    m_entries[node->myname] = std::move(entry);
+}
+
+ZENO_API bool EvalCache::isCachedOutput(std::string const &id, IObject const *obj) {
+    std::lock_guard lck(m_mtx);
+    auto it = m_entries.find(id);
+    if (it == m_entries.end())
+        return false;
+    for (auto const &[_, out]: it->second.outputs) {
+        if (out.get() == obj)
+            return true;
+    }
+    return false;
+}
+
+}
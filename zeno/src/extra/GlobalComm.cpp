@@ -1,11 +1,23 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalState.h>
+#include <zeno/extra/ThreadPool.h>
+#include <zeno/core/Session.h>
 #include <zeno/funcs/ObjectCodec.h>
+#include <zeno/funcs/ObjectMemory.h>
+#include <zeno/utils/MappedFile.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/Profiler.h>
+#include <zeno/utils/lz4block.h>
+#include <zeno/utils/xxhash64.h>
 #include <zeno/utils/log.h>
 #include <filesystem>
 #include <algorithm>
 #include <fstream>
 #include <cassert>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <cstdlib>
 #include <zeno/types/UserData.h>
 #include <unordered_set>
 #include <zeno/types/MaterialObject.h>
@@ -18,97 +30,275 @@
 
 namespace zeno {
 
-std::vector<std::filesystem::path> cachepath(3);
 std::unordered_set<std::string> lightCameraNodes({
     "CameraEval", "CameraNode", "CihouMayaCameraFov", "ExtractCameraData", "GetAlembicCamera","MakeCamera",
     "LightNode", "BindLight", "ProceduralSky", "HDRSky",
     });
 std::set<std::string> matNodeNames = {"ShaderFinalize", "ShaderVolume", "ShaderVolumeHomogeneous"};
 
-void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName) {
-    if (cachedir.empty()) return;
-    std::filesystem::path dir = std::filesystem::u8path(cachedir + "/" + std::to_string(1000000 + frameid).substr(1));
-    if (!std::filesystem::exists(dir) && !std::filesystem::create_directories(dir))
-    {
-        log_critical("can not create path: {}", dir);
+namespace {
+
+/* zencache v2 file layout:
+ *
+ *   ZencacheHeader
+ *   one block per object, the output of encodeObject, maybe lz4 compressed
+ *   table of contents, a ZencacheEntry followed by the key for each block
+ *
+ * readers go straight to the table of contents and only touch the blocks of
+ * the objects they want, every block and the table have their own checksum.
+ * v1 files ("ZENCACHE<count>\a<key>\a...\a<offsets><data>") can still be read.
+ */
+constexpr char kZencacheMagic[8] = {'Z', 'E', 'N', 'C', 'A', 'C', 'H', '2'};
+constexpr uint32_t kZencacheVersion = 2;
+
+enum ZencacheCodec : uint32_t {
+    CodecRaw = 0,
+    CodecLZ4 = 1,
+};
+
+struct ZencacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numEntries;
+    uint64_t tocOffset;
+    uint64_t tocSize;
+    uint64_t tocChecksum;
+};
+
+struct ZencacheEntry {
+    uint64_t offset;    // of the block, from the beginning of file
+    uint64_t size;      // of the block as stored
+    uint64_t rawSize;   // of the block as decoded by decodeObject
+    uint64_t checksum;  // xxhash64 of the block as stored
+    uint32_t codec;
+    uint32_t keyLen;    // the key follows right after the entry
+};
+
+struct ZencacheWriter {
+    struct Block {
+        std::string key;
+        std::shared_ptr<IObject> obj;  // released as soon as it's encoded
+        std::vector<char> data;
+        uint64_t rawSize = 0;
+        uint32_t codec = CodecRaw;
+        bool encoded = false;
+
+        void encode() {
+            encoded = encodeObject(obj.get(), data);
+            obj = nullptr;
+            rawSize = data.size();
+            static const bool compress = envconfig::getBool("ZENCACHE_COMPRESS");
+            if (encoded && compress) {
+                auto packed = lz4_compress_block(data.data(), data.size());
+                if (!packed.empty()) {
+                    data = std::move(packed);
+                    codec = CodecLZ4;
+                }
+            }
+        }
+    };
+
+    std::vector<Block> blocks;
+
+    void add(std::string const &key, std::shared_ptr<IObject> obj) {
+        auto &block = blocks.emplace_back();
+        block.key = key;
+        block.obj = std::move(obj);
     }
-    std::vector<std::vector<char>> bufCaches(3);
-    std::vector<std::vector<size_t>> poses(3);
-    std::vector<std::string> keys(3);
-    for (auto const &[key, obj]: objs) {
 
-        size_t bufsize =0;
-        std::string nodeName = key.substr(key.find("-") + 1, key.find(":") - key.find("-") -1);
-        if (cacheLightCameraOnly && (lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj)))
+    // objects that failed to encode are left out of the file
+    void dropUnencoded() {
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [] (Block const &block) {
+            return !block.encoded;
+        }), blocks.end());
+    }
+
+    bool empty() const {
+        return blocks.empty();
+    }
+
+    std::vector<char> tableOfContents() const {
+        std::vector<char> toc;
+        uint64_t offset = sizeof(ZencacheHeader);
+        for (auto const &block: blocks) {
+            ZencacheEntry entry;
+            entry.offset = offset;
+            entry.size = block.data.size();
+            entry.rawSize = block.rawSize;
+            entry.checksum = xxhash64::hash(block.data.data(), block.data.size());
+            entry.codec = block.codec;
+            entry.keyLen = block.key.size();
+            toc.insert(toc.end(), (char const *)&entry, (char const *)(&entry + 1));
+            toc.insert(toc.end(), block.key.begin(), block.key.end());
+            offset += block.data.size();
+        }
+        return toc;
+    }
+
+    std::size_t fileSize() const {
+        std::size_t size = sizeof(ZencacheHeader);
+        for (auto const &block: blocks)
+            size += block.data.size() + sizeof(ZencacheEntry) + block.key.size();
+        return size;
+    }
+
+    bool write(std::filesystem::path const &path) const {
+        auto toc = tableOfContents();
+        ZencacheHeader header;
+        std::copy_n(kZencacheMagic, sizeof(header.magic), header.magic);
+        header.version = kZencacheVersion;
+        header.numEntries = blocks.size();
+        header.tocOffset = sizeof(ZencacheHeader);
+        for (auto const &block: blocks)
+            header.tocOffset += block.data.size();
+        header.tocSize = toc.size();
+        header.tocChecksum = xxhash64::hash(toc.data(), toc.size());
+
+        // written aside and renamed, so that a crash or a full disk never leaves half a
+        // file under the final name for the viewer to map
+        auto tmpPath = path;
+        tmpPath += ".tmp";
+        std::error_code ec;
         {
-            bufsize = bufCaches[0].size();
-            if (encodeObject(obj.get(), bufCaches[0]))
-            {
-                keys[0].push_back('\a');
-                keys[0].append(key);
-                poses[0].push_back(bufsize);
+            std::ofstream ofs(tmpPath, std::ios::binary);
+            ofs.write((char const *)&header, sizeof(header));
+            for (auto const &block: blocks)
+                ofs.write(block.data.data(), block.data.size());
+            ofs.write(toc.data(), toc.size());
+            ofs.close();
+            if (!ofs) {
+                log_error("failed to write zeno cache file {}", tmpPath);
+                std::filesystem::remove(tmpPath, ec);
+                return false;
             }
         }
-        if (cacheMaterialOnly && (matNodeNames.count(nodeName)>0 || std::dynamic_pointer_cast<MaterialObject>(obj)))
-        {
-            bufsize = bufCaches[1].size();
-            if (encodeObject(obj.get(), bufCaches[1]))
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            log_error("failed to rename zeno cache file to {}: {}", path, ec.message());
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+};
+
+// the cache files of one frame: light & camera, material and the other objects
+struct ZencacheFrame {
+    std::filesystem::path dir;
+    ZencacheWriter files[3];
+    std::filesystem::path paths[3];
+    bool wanted[3] = {};  // written even if empty
+
+    ZencacheFrame() = default;
+
+    ZencacheFrame(std::string const &cachedir, int frameid, GlobalComm::ViewObjects const &objs,
+                  bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string const &fileName) {
+        dir = std::filesystem::u8path(cachedir + "/" + std::to_string(1000000 + frameid).substr(1));
+        for (auto const &[key, obj]: objs) {
+            std::string nodeName = key.substr(key.find("-") + 1, key.find(":") - key.find("-") -1);
+            auto isLightCamera = [&] {
+                return lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj);
+            };
+            auto isMaterial = [&] {
+                return matNodeNames.count(nodeName) > 0 || std::dynamic_pointer_cast<MaterialObject>(obj);
+            };
+            if (cacheLightCameraOnly && isLightCamera())
+                files[0].add(key, obj);
+            if (cacheMaterialOnly && isMaterial())
+                files[1].add(key, obj);
+            if (!cacheLightCameraOnly && !cacheMaterialOnly)
             {
-                keys[1].push_back('\a');
-                keys[1].append(key);
-                poses[1].push_back(bufsize);
+                if (isLightCamera())
+                    files[0].add(key, obj);
+                else if (isMaterial())
+                    files[1].add(key, obj);
+                else
+                    files[2].add(key, obj);
             }
         }
-        if (!cacheLightCameraOnly && !cacheMaterialOnly)
+
+        if (fileName == "")
         {
-            if (lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj)) {
-                bufsize = bufCaches[0].size();
-                if (encodeObject(obj.get(), bufCaches[0]))
-                {
-                    keys[0].push_back('\a');
-                    keys[0].append(key);
-                    poses[0].push_back(bufsize);
-                }
-            } else if (matNodeNames.count(nodeName)>0 || std::dynamic_pointer_cast<MaterialObject>(obj)) {
-                bufsize = bufCaches[1].size();
-                if (encodeObject(obj.get(), bufCaches[1]))
-                {
-                    keys[1].push_back('\a');
-                    keys[1].append(key);
-                    poses[1].push_back(bufsize);
-                }
-            } else {
-                bufsize = bufCaches[2].size();
-                if (encodeObject(obj.get(), bufCaches[2]))
-                {
-                    keys[2].push_back('\a');
-                    keys[2].append(key);
-                    poses[2].push_back(bufsize);
-                }
-            }
+            paths[0] = dir / "lightCameraObj.zencache";
+            paths[1] = dir / "materialObj.zencache";
+            paths[2] = dir / "normalObj.zencache";
+        }
+        else
+        {
+            paths[2] = std::filesystem::u8path(dir.string() + "/" + fileName);
         }
+        for (int i = 0; i < 3; i++)
+            wanted[i] = !(cacheLightCameraOnly && i != 0 || cacheMaterialOnly && i != 1 || fileName != "" && i != 2);
     }
 
-    if (fileName == "")
-    {
-        cachepath[0] = dir / "lightCameraObj.zencache";
-        cachepath[1] = dir / "materialObj.zencache";
-        cachepath[2] = dir / "normalObj.zencache";
+    bool skipped(int i) const {
+        return files[i].empty() && !wanted[i];
     }
-    else
-    {
-        cachepath[2] = std::filesystem::u8path(dir.string() + "/" + fileName);
+
+    // encodes the objects in parallel on pool, or right here if it's null
+    void encode(ThreadPool *pool) {
+        ZENO_PROFILE_SCOPE("cache", "encode frame");
+        std::vector<ZencacheWriter::Block *> todo;
+        for (auto &file: files)
+            for (auto &block: file.blocks)
+                todo.push_back(&block);
+        auto encodeBlock = [] (ZencacheWriter::Block *block) {
+            try {
+                block->encode();
+            } catch (std::exception const &e) {
+                log_error("failed to encode {} for zeno cache: {}", block->key, e.what());
+                block->obj = nullptr;
+            }
+        };
+        if (pool && todo.size() > 1) {
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::size_t left = todo.size();
+            for (auto *block: todo) {
+                pool->submit([&, block] {
+                    encodeBlock(block);
+                    std::lock_guard lck(mtx);
+                    if (!--left)
+                        cv.notify_one();
+                });
+            }
+            std::unique_lock lck(mtx);
+            cv.wait(lck, [&] { return !left; });
+        } else {
+            for (auto *block: todo)
+                encodeBlock(block);
+        }
+        for (auto &file: files)
+            file.dropUnencoded();
     }
-    size_t currentFrameSize = 0;
-    for (int i = 0; i < 3; i++)
-    {
-        if (poses[i].size() == 0 && (cacheLightCameraOnly && i != 0 || cacheMaterialOnly && i != 1 || fileName != "" && i != 2))
-            continue;
-        keys[i].push_back('\a');
-        keys[i] = "ZENCACHE" + std::to_string(poses[i].size()) + keys[i];
-        poses[i].push_back(bufCaches[i].size());
-        currentFrameSize += keys[i].size() + poses[i].size() * sizeof(size_t) + bufCaches[i].size();
+
+    std::size_t fileSize() const {
+        std::size_t size = 0;
+        for (int i = 0; i < 3; i++)
+            if (!skipped(i))
+                size += files[i].fileSize();
+        return size;
+    }
+
+    bool write() const {
+        ZENO_PROFILE_SCOPE("cache", "write frame");
+        if (!std::filesystem::exists(dir) && !std::filesystem::create_directories(dir))
+        {
+            log_critical("can not create path: {}", dir);
+        }
+        bool ok = true;
+        for (int i = 0; i < 3; i++)
+        {
+            if (skipped(i))
+                continue;
+            log_debug("dump cache to disk {}", paths[i]);
+            ok = files[i].write(paths[i]) && ok;
+        }
+        return ok;
     }
+};
+
+void waitForDiskSpace(std::string const &cachedir, size_t currentFrameSize) {
     size_t freeSpace = 0;
     #ifdef __linux__
         struct statfs diskInfo;
@@ -132,91 +322,315 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
             freeSpace = std::filesystem::space(std::filesystem::u8path(cachedir)).free;
         #endif
     }
-    for (int i = 0; i < 3; i++)
-    {
-        if (poses[i].size() == 0 && (cacheLightCameraOnly && i != 0 || cacheMaterialOnly && i != 1 || fileName != "" && i != 2))
+}
+
+bool readZencacheV1(MappedFile const &file, GlobalComm::ViewObjects &objs, GlobalComm::KeyFilter const &filter) {
+    const char *dat = file.data(), *end = file.data() + file.size();
+    size_t pos = std::find(dat + 8, end, '\a') - dat;
+    if (pos == file.size()) {
+        log_error("zeno cache file broken (2)");
+        return false;
+    }
+    size_t keyscount = std::stoi(std::string(dat + 8, pos - 8));
+    pos = pos + 1;
+    std::vector<std::string> keys;
+    for (int k = 0; k < keyscount; k++) {
+        size_t newpos = std::find(dat + pos, end, '\a') - dat;
+        if (newpos == file.size()) {
+            log_error("zeno cache file broken (3.{})", k);
+            return false;
+        }
+        keys.emplace_back(dat + pos, newpos - pos);
+        pos = newpos + 1;
+    }
+    if ((keyscount + 1) * sizeof(size_t) > file.size() - pos) {
+        log_error("zeno cache file broken (3)");
+        return false;
+    }
+    std::vector<size_t> poses(keyscount + 1);
+    std::copy_n(dat + pos, (keyscount + 1) * sizeof(size_t), (char *)poses.data());
+    pos += (keyscount + 1) * sizeof(size_t);
+    for (int k = 0; k < keyscount; k++) {
+        if (poses[k + 1] > file.size() - pos || poses[k + 1] < poses[k]) {
+            log_error("zeno cache file broken (4.{})", k);
+            return false;
+        }
+        if (filter && !filter(keys[k])) {
+            objs.try_emplace(keys[k], nullptr);
+            continue;
+        }
+        const char *p = dat + pos + poses[k];
+        objs.try_emplace(keys[k], decodeObject(p, poses[k + 1] - poses[k]));
+    }
+    return true;
+}
+
+bool readZencacheV2(MappedFile const &file, GlobalComm::ViewObjects &objs, GlobalComm::KeyFilter const &filter) {
+    ZencacheHeader header;
+    std::copy_n(file.data(), sizeof(header), (char *)&header);
+    if (header.version != kZencacheVersion) {
+        log_error("unsupported zeno cache file version {}", header.version);
+        return false;
+    }
+    if (header.tocOffset > file.size() || header.tocSize > file.size() - header.tocOffset) {
+        log_error("zeno cache file broken (table of contents)");
+        return false;
+    }
+    const char *toc = file.data() + header.tocOffset;
+    if (xxhash64::hash(toc, header.tocSize) != header.tocChecksum) {
+        log_error("zeno cache file broken (table of contents checksum)");
+        return false;
+    }
+    size_t pos = 0;
+    for (uint32_t k = 0; k < header.numEntries; k++) {
+        ZencacheEntry entry;
+        if (header.tocSize - pos < sizeof(entry)) {
+            log_error("zeno cache file broken (entry {})", k);
+            return false;
+        }
+        std::copy_n(toc + pos, sizeof(entry), (char *)&entry);
+        pos += sizeof(entry);
+        if (entry.keyLen > header.tocSize - pos) {
+            log_error("zeno cache file broken (key {})", k);
+            return false;
+        }
+        std::string key(toc + pos, entry.keyLen);
+        pos += entry.keyLen;
+
+        // blocks of the objects filtered out are never even paged in
+        if (filter && !filter(key)) {
+            objs.try_emplace(key, nullptr);
             continue;
-        log_debug("dump cache to disk {}", cachepath[i]);
-        std::ofstream ofs(cachepath[i], std::ios::binary);
-        std::ostreambuf_iterator<char> oit(ofs);
-        std::copy(keys[i].begin(), keys[i].end(), oit);
-        std::copy_n((const char *)poses[i].data(), poses[i].size() * sizeof(size_t), oit);
-        std::copy(bufCaches[i].begin(), bufCaches[i].end(), oit);
+        }
+        if (entry.offset > file.size() || entry.size > file.size() - entry.offset) {
+            log_error("zeno cache file broken (block of {})", key);
+            return false;
+        }
+        const char *block = file.data() + entry.offset;
+        if (xxhash64::hash(block, entry.size) != entry.checksum) {
+            log_error("zeno cache file broken (checksum of {})", key);
+            return false;
+        }
+        if (entry.codec == CodecLZ4) {
+            std::vector<char> raw(entry.rawSize);
+            if (!lz4_decompress_block(block, entry.size, raw.data(), raw.size())) {
+                log_error("zeno cache file broken (compressed block of {})", key);
+                return false;
+            }
+            objs.try_emplace(key, decodeObject(raw.data(), raw.size()));
+        } else if (entry.codec == CodecRaw) {
+            objs.try_emplace(key, decodeObject(block, entry.size));
+        } else {
+            log_error("unsupported codec {} in zeno cache file", entry.codec);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readZencache(std::filesystem::path const &path, GlobalComm::ViewObjects &objs, GlobalComm::KeyFilter const &filter) {
+    // decode straight from the mapped pages, no intermediate copy of the whole file
+    MappedFile file(path);
+    if (!file) {
+        log_error("zeno cache file does not exist");
+        return false;
+    }
+    if (file.size() >= sizeof(ZencacheHeader) && std::equal(kZencacheMagic, kZencacheMagic + 8, file.data()))
+        return readZencacheV2(file, objs, filter);
+    if (file.size() > 8 && std::string(file.data(), 8) == "ZENCACHE")
+        return readZencacheV1(file, objs, filter);
+    log_error("zeno cache file broken (1)");
+    return false;
+}
+
+}
+
+// frames are encoded on the thread pool and written in order by our own thread,
+// dumpFrameCache blocks while ZENO_CACHE_WRITE_QUEUE (default 2) frames are pending
+struct GlobalComm::CacheWriter {
+    struct Job {
+        std::string cachedir;
+        ZencacheFrame frame;
+        std::function<void(bool ok)> done;
+    };
+
+    std::deque<Job> m_jobs;
+    std::size_t m_numPending = 0;  // queued plus the one being written
+    std::size_t const m_maxPending;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+    bool m_stopping = false;
+
+    CacheWriter() : m_maxPending(std::max(1, envconfig::getInt("CACHE_WRITE_QUEUE", 2))) {
+    }
+
+    ~CacheWriter() {
+        {
+            std::lock_guard lck(m_mtx);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();  // after writing whatever is left
+    }
+
+    void push(Job job) {
+        std::unique_lock lck(m_mtx);
+        if (!m_thread.joinable())
+            m_thread = std::thread([this] { threadMain(); });
+        m_cv.wait(lck, [&] { return m_numPending < m_maxPending; });
+        m_jobs.push_back(std::move(job));
+        m_numPending++;
+        m_cv.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock lck(m_mtx);
+        m_cv.wait(lck, [&] { return !m_numPending; });
+    }
+
+    void threadMain() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lck(m_mtx);
+                m_cv.wait(lck, [&] { return m_stopping || !m_jobs.empty(); });
+                if (m_jobs.empty())
+                    return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            bool ok = false;
+            if (!job.cachedir.empty()) {
+                try {
+                    job.frame.encode(getSession().threadPool.get());
+                    // a full disk stalls this thread only, the queue filling up slows the caller down
+                    waitForDiskSpace(job.cachedir, job.frame.fileSize());
+                    ok = job.frame.write();
+                } catch (std::exception const &e) {
+                    log_error("failed to write frame cache {}: {}", job.frame.dir, e.what());
+                }
+            }
+            job.done(ok);
+            {
+                std::lock_guard lck(m_mtx);
+                m_numPending--;
+            }
+            m_cv.notify_all();
+        }
+    }
+};
+
+// loads the frames ahead of the one being viewed in the background, one at a time
+struct GlobalComm::FramePrefetcher {
+    GlobalComm *m_comm;
+    std::deque<int> m_queue;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+    bool m_stopping = false;
+
+    explicit FramePrefetcher(GlobalComm *comm) : m_comm(comm) {
     }
+
+    ~FramePrefetcher() {
+        {
+            std::lock_guard lck(m_mtx);
+            m_stopping = true;
+            m_queue.clear();
+        }
+        m_cv.notify_all();
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    // what's still queued from before is dropped, playback has moved on
+    void request(std::vector<int> frames) {
+        std::lock_guard lck(m_mtx);
+        if (!m_thread.joinable()) {
+            if (frames.empty())
+                return;
+            m_thread = std::thread([this] { threadMain(); });
+        }
+        m_queue.assign(frames.begin(), frames.end());
+        m_cv.notify_all();
+    }
+
+    void threadMain() {
+        while (true) {
+            int frameid;
+            {
+                std::unique_lock lck(m_mtx);
+                m_cv.wait(lck, [&] { return m_stopping || !m_queue.empty(); });
+                if (m_stopping)
+                    return;
+                frameid = m_queue.front();
+                m_queue.pop_front();
+            }
+            std::unique_lock lck(m_comm->m_mtx);
+            m_comm->_loadFrame(lck, frameid, true);
+        }
+    }
+};
+
+void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName) {
+    if (cachedir.empty()) return;
+    ZencacheFrame frame(cachedir, frameid, objs, cacheLightCameraOnly, cacheMaterialOnly, fileName);
+    frame.encode(nullptr);
+    waitForDiskSpace(cachedir, frame.fileSize());
+    frame.write();
     objs.clear();
 }
 
-bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, std::string fileName) {
+bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, std::string fileName, KeyFilter const &filter) {
     if (cachedir.empty())
         return false;
+    ZENO_PROFILE_SCOPE("cache", "read frame");
     objs.clear();
     auto dir = std::filesystem::u8path(cachedir) / std::to_string(1000000 + frameid).substr(1);
+    std::vector<std::filesystem::path> cachepath;
     if (fileName == "")
     {
-        cachepath[0] = dir / "lightCameraObj.zencache";
-        cachepath[1] = dir / "materialObj.zencache";
-        cachepath[2] = dir / "normalObj.zencache";
+        cachepath.push_back(dir / "lightCameraObj.zencache");
+        cachepath.push_back(dir / "materialObj.zencache");
+        cachepath.push_back(dir / "normalObj.zencache");
     }
     else
     {
-        cachepath[2] = std::filesystem::u8path(dir.string() + "/" + fileName);
+        cachepath.push_back(std::filesystem::u8path(dir.string() + "/" + fileName));
     }
 
-    for (auto path : cachepath)
+    for (auto const &path : cachepath)
     {
         if (!std::filesystem::exists(path))
         {
             continue;
         }
         log_debug("load cache from disk {}", path);
-
-        auto szBuffer = std::filesystem::file_size(path);
-        std::vector<char> dat(szBuffer);
-        FILE *fp = fopen(path.string().c_str(), "rb");
-        if (!fp) {
-            log_error("zeno cache file does not exist");
-            return false;
-        }
-        size_t ret = fread(&dat[0], 1, szBuffer, fp);
-        assert(ret == szBuffer);
-        fclose(fp);
-        fp = nullptr;
-
-        if (dat.size() <= 8 || std::string(dat.data(), 8) != "ZENCACHE") {
-            log_error("zeno cache file broken (1)");
-            return false;
-        }
-        size_t pos = std::find(dat.begin() + 8, dat.end(), '\a') - dat.begin();
-        if (pos == dat.size()) {
-            log_error("zeno cache file broken (2)");
+        if (!readZencache(path, objs, filter))
             return false;
-        }
-        size_t keyscount = std::stoi(std::string(dat.data() + 8, pos - 8));
-        pos = pos + 1;
-        std::vector<std::string> keys;
-        for (int k = 0; k < keyscount; k++) {
-            size_t newpos = std::find(dat.begin() + pos, dat.end(), '\a') - dat.begin();
-            if (newpos == dat.size()) {
-                log_error("zeno cache file broken (3.{})", k);
-                return false;
-            }
-            keys.emplace_back(dat.data() + pos, newpos - pos);
-            pos = newpos + 1;
-        }
-        std::vector<size_t> poses(keyscount + 1);
-        std::copy_n(dat.data() + pos, (keyscount + 1) * sizeof(size_t), (char *)poses.data());
-        pos += (keyscount + 1) * sizeof(size_t);
-        for (int k = 0; k < keyscount; k++) {
-            if (poses[k] > dat.size() - pos || poses[k + 1] < poses[k]) {
-                log_error("zeno cache file broken (4.{})", k);
-            }
-            const char *p = dat.data() + pos + poses[k];
-            objs.try_emplace(keys[k], decodeObject(p, poses[k + 1] - poses[k]));
-        }
     }
     return true;
 }
 
+static size_t viewObjectsMemoryBytes(GlobalComm::ViewObjects const &objs) {
+    std::unordered_set<void const *> visited;
+    size_t bytes = 0;
+    for (auto const &[key, obj]: objs)
+        bytes += objectMemoryBytes(obj.get(), visited);
+    return bytes;
+}
+
+ZENO_API GlobalComm::GlobalComm()
+    : maxCachedBytes(size_t(std::max(0, envconfig::getInt("FRAME_CACHE_MB"))) << 20)
+    , maxPrefetchFrames(std::max(0, envconfig::getInt("FRAME_PREFETCH", 2)))
+    , m_cacheWriter(std::make_unique<CacheWriter>())
+    , m_prefetcher(std::make_unique<FramePrefetcher>(this)) {
+}
+
+ZENO_API GlobalComm::~GlobalComm() = default;
+
 ZENO_API void GlobalComm::newFrame() {
     std::lock_guard lck(m_mtx);
     log_debug("GlobalComm::newFrame {}", m_frames.size());
@@ -226,18 +640,48 @@ ZENO_API void GlobalComm::newFrame() {
 ZENO_API void GlobalComm::finishFrame() {
     std::lock_guard lck(m_mtx);
     log_debug("GlobalComm::finishFrame {}", m_maxPlayFrame);
-    if (m_maxPlayFrame >= 0 && m_maxPlayFrame < m_frames.size())
+    // the cache may already have failed to write
+    if (m_maxPlayFrame >= 0 && m_maxPlayFrame < m_frames.size() && m_frames[m_maxPlayFrame].frame_state != FRAME_BROKEN)
         m_frames[m_maxPlayFrame].frame_state = FRAME_COMPLETED;
+    if (m_maxPlayFrame >= 0 && m_maxPlayFrame < m_frames.size())
+        m_frames[m_maxPlayFrame].memoryBytes = viewObjectsMemoryBytes(m_frames[m_maxPlayFrame].view_objects);
     m_maxPlayFrame += 1;
 }
 
-ZENO_API void GlobalComm::dumpFrameCache(int frameid, bool cacheLightCameraOnly, bool cacheMaterialOnly) {
-    std::lock_guard lck(m_mtx);
-    int frameIdx = frameid - beginFrameNumber;
-    if (frameIdx >= 0 && frameIdx < m_frames.size()) {
-        log_debug("dumping frame {}", frameid);
-        toDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects, cacheLightCameraOnly, cacheMaterialOnly);
+ZENO_API void GlobalComm::dumpFrameCache(int frameid, bool cacheLightCameraOnly, bool cacheMaterialOnly, CacheWrittenCallback onWritten) {
+    CacheWriter::Job job;
+    {
+        std::lock_guard lck(m_mtx);
+        int frameIdx = frameid - beginFrameNumber;
+        if (frameIdx >= 0 && frameIdx < m_frames.size() && !cacheFramePath.empty()) {
+            log_debug("dumping frame {}", frameid);
+            // only the pointers are copied here, the frame is served from memory until it's written
+            job.cachedir = cacheFramePath;
+            job.frame = ZencacheFrame(cacheFramePath, frameid, m_frames[frameIdx].view_objects, cacheLightCameraOnly, cacheMaterialOnly, "");
+            m_writingFrames.insert(frameid);
+        }
     }
+    // still queued when there's nothing to write, so that onWritten is always called in frame order
+    job.done = [this, frameid, written = !job.cachedir.empty(), onWritten = std::move(onWritten)] (bool ok) {
+        if (written) {
+            std::lock_guard lck(m_mtx);
+            m_writingFrames.erase(frameid);
+            int frameIdx = frameid - beginFrameNumber;
+            if (frameIdx >= 0 && frameIdx < m_frames.size()) {
+                if (!ok)
+                    m_frames[frameIdx].frame_state = FRAME_BROKEN;
+                else if (!m_inCacheFrames.count(frameid))
+                    m_frames[frameIdx].view_objects.clear();
+            }
+        }
+        if (onWritten)
+            onWritten(frameid, ok);
+    };
+    m_cacheWriter->push(std::move(job));
+}
+
+ZENO_API void GlobalComm::waitFrameCacheWritten() {
+    m_cacheWriter->wait();
 }
 
 ZENO_API void GlobalComm::addViewObject(std::string const &key, std::shared_ptr<IObject> object) {
@@ -248,9 +692,10 @@ ZENO_API void GlobalComm::addViewObject(std::string const &key, std::shared_ptr<
 }
 
 ZENO_API void GlobalComm::clearState() {
+    m_cacheWriter->wait();
     std::lock_guard lck(m_mtx);
     m_frames.clear();
-    m_inCacheFrames.clear();
+    _clearCachedFrames();
     m_maxPlayFrame = 0;
     maxCachedFrames = 1;
     cacheFramePath = {};
@@ -258,9 +703,10 @@ ZENO_API void GlobalComm::clearState() {
 
 ZENO_API void GlobalComm::clearFrameState()
 {
+    m_cacheWriter->wait();
     std::lock_guard lck(m_mtx);
     m_frames.clear();
-    m_inCacheFrames.clear();
+    _clearCachedFrames();
     m_maxPlayFrame = 0;
 }
 
@@ -298,40 +744,126 @@ ZENO_API std::pair<int, int> GlobalComm::frameRange() {
 }
 
 ZENO_API GlobalComm::ViewObjects const *GlobalComm::getViewObjects(const int frameid) {
-    std::lock_guard lck(m_mtx);
-    return _getViewObjects(frameid);
+    std::unique_lock lck(m_mtx);
+    return _getViewObjects(lck, frameid);
 }
 
-GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(const int frameid) {
+GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(std::unique_lock<std::mutex> &lck, const int frameid) {
     int frameIdx = frameid - beginFrameNumber;
     if (frameIdx < 0 || frameIdx >= m_frames.size())
         return nullptr;
     if (maxCachedFrames != 0) {
-        // load back one gc:
-        if (!m_inCacheFrames.count(frameid)) {  // notinmem then cacheit
-            bool ret = fromDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects);
-            if (!ret)
-                return nullptr;
-
-            m_inCacheFrames.insert(frameid);
-            // and dump one as balance:
-            if (m_inCacheFrames.size() && m_inCacheFrames.size() > maxCachedFrames) { // notindisk then dumpit
-                for (int i: m_inCacheFrames) {
-                    if (i != frameid) {
-                        // seems that objs will not be modified when load_objects called later.
-                        // so, there is no need to dump.
-                        //toDisk(cacheFramePath, i, m_frames[i - beginFrameNumber].view_objects);
-                        m_frames[i - beginFrameNumber].view_objects.clear();
-                        m_inCacheFrames.erase(i);
-                        break;
-                    }
-                }
-            }
-        }
+        if (!_loadFrame(lck, frameid, false))
+            return nullptr;
+        // the frames may have been cleared while reading
+        frameIdx = frameid - beginFrameNumber;
+        if (frameIdx < 0 || frameIdx >= m_frames.size())
+            return nullptr;
+        auto it = std::find(m_lruFrames.begin(), m_lruFrames.end(), frameid);
+        if (it != m_lruFrames.end())
+            m_lruFrames.splice(m_lruFrames.begin(), m_lruFrames, it);
+        _prefetchAhead(frameid);
     }
     return &m_frames[frameIdx].view_objects;
 }
 
+// reads the frame from the cache unless it's in memory, m_mtx is released meanwhile
+bool GlobalComm::_loadFrame(std::unique_lock<std::mutex> &lck, int frameid, bool prefetch) {
+    m_loadedCv.wait(lck, [&] { return !m_loadingFrames.count(frameid); });
+    if (m_inCacheFrames.count(frameid) || m_writingFrames.count(frameid))
+        return true;
+    int frameIdx = frameid - beginFrameNumber;
+    if (frameIdx < 0 || frameIdx >= m_frames.size())
+        return false;
+    if (prefetch && m_frames[frameIdx].frame_state != FRAME_COMPLETED)
+        return false;
+
+    m_loadingFrames.insert(frameid);
+    auto generation = m_generation;
+    auto cachedir = cacheFramePath;
+    lck.unlock();
+    ViewObjects objs;
+    bool ret = fromDisk(cachedir, frameid, objs);
+    size_t bytes = ret ? viewObjectsMemoryBytes(objs) : 0;
+    lck.lock();
+    m_loadingFrames.erase(frameid);
+    m_loadedCv.notify_all();
+
+    frameIdx = frameid - beginFrameNumber;
+    if (!ret || generation != m_generation || frameIdx < 0 || frameIdx >= m_frames.size())
+        return false;
+    auto &frame = m_frames[frameIdx];
+    frame.view_objects = std::move(objs);
+    frame.memoryBytes = bytes;
+    m_inCacheFrames.insert(frameid);
+    m_cachedBytes += bytes;
+    // the frame being viewed stays in front, those prefetched come after it nearest first
+    if (prefetch && !m_lruFrames.empty()) {
+        int viewed = m_lruFrames.front();
+        auto pos = std::next(m_lruFrames.begin());
+        while (pos != m_lruFrames.end() && (*pos - viewed) * (frameid - viewed) > 0
+               && std::abs(*pos - viewed) < std::abs(frameid - viewed))
+            ++pos;
+        m_lruFrames.insert(pos, frameid);
+    } else {
+        m_lruFrames.push_front(frameid);
+    }
+    _evictFrames();
+    return m_inCacheFrames.count(frameid) != 0;
+}
+
+// least recently viewed first, never the frame in front
+void GlobalComm::_evictFrames() {
+    while (m_lruFrames.size() > 1) {
+        if (maxCachedBytes ? m_cachedBytes <= maxCachedBytes : m_lruFrames.size() <= maxCachedFrames + maxPrefetchFrames)
+            break;
+        int frameid = m_lruFrames.back();
+        m_lruFrames.pop_back();
+        m_inCacheFrames.erase(frameid);
+        int frameIdx = frameid - beginFrameNumber;
+        if (frameIdx >= 0 && frameIdx < m_frames.size()) {
+            // seems that objs will not be modified when load_objects called later.
+            // so, there is no need to dump.
+            m_cachedBytes -= std::min(m_cachedBytes, m_frames[frameIdx].memoryBytes);
+            m_frames[frameIdx].view_objects.clear();
+        }
+    }
+}
+
+// queues the next maxPrefetchFrames frames in the direction of playback, as many as fit
+// in the byte budget beside the frame being viewed if there is one
+void GlobalComm::_prefetchAhead(int frameid) {
+    int step = frameid < m_lastViewedFrame ? -1 : 1;
+    m_lastViewedFrame = frameid;
+
+    size_t frameBytes = m_frames[frameid - beginFrameNumber].memoryBytes;
+    size_t budgetBytes = maxCachedBytes - std::min(maxCachedBytes, frameBytes);
+    std::vector<int> frames;
+    for (int i = 1; i <= maxPrefetchFrames; i++) {
+        int next = frameid + step * i;
+        int nextIdx = next - beginFrameNumber;
+        if (nextIdx < 0 || nextIdx >= m_frames.size() || m_frames[nextIdx].frame_state != FRAME_COMPLETED)
+            break;
+        if (maxCachedBytes) {
+            // not known until loaded once, guess it's like this one
+            size_t bytes = m_frames[nextIdx].memoryBytes ? m_frames[nextIdx].memoryBytes : frameBytes;
+            if (bytes > budgetBytes)
+                break;
+            budgetBytes -= bytes;
+        }
+        if (!m_inCacheFrames.count(next) && !m_writingFrames.count(next) && !m_loadingFrames.count(next))
+            frames.push_back(next);
+    }
+    m_prefetcher->request(std::move(frames));
+}
+
+void GlobalComm::_clearCachedFrames() {
+    m_inCacheFrames.clear();
+    m_lruFrames.clear();
+    m_cachedBytes = 0;
+    m_generation++;
+}
+
 ZENO_API GlobalComm::ViewObjects const &GlobalComm::getViewObjects() {
     std::lock_guard lck(m_mtx);
     return m_frames.back().view_objects;
@@ -341,11 +873,20 @@ ZENO_API bool GlobalComm::load_objects(
         const int frameid,
         const std::function<bool(std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs)>& callback,
         bool& isFrameValid)
+{
+    return load_objects(frameid, {}, callback, isFrameValid);
+}
+
+ZENO_API bool GlobalComm::load_objects(
+        const int frameid,
+        KeyFilter const &filter,
+        const std::function<bool(std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs)>& callback,
+        bool& isFrameValid)
 {
     if (!callback)
         return false;
 
-    std::lock_guard lck(m_mtx);
+    std::unique_lock lck(m_mtx);
 
     int frame = frameid;
     frame -= beginFrameNumber;
@@ -357,8 +898,17 @@ ZENO_API bool GlobalComm::load_objects(
 
     isFrameValid = true;
     bool inserted = false;
-    auto const* viewObjs = _getViewObjects(frameid);
-    if (viewObjs) {
+    // read whole with m_mtx released, so that it's kept in the LRU and the frames after it are prefetched
+    auto const* viewObjs = _getViewObjects(lck, frameid);
+    if (viewObjs && filter) {
+        // the objects the caller already has are passed as nullptr, as fromDisk does
+        std::map<std::string, std::shared_ptr<zeno::IObject>> objs;
+        for (auto const &[key, obj]: *viewObjs)
+            objs.try_emplace(key, filter(key) ? obj : nullptr);
+        zeno::log_trace("load_objects: {} objects at frame {}", objs.size(), frameid);
+        inserted = callback(objs);
+    }
+    else if (viewObjs) {
         zeno::log_trace("load_objects: {} objects at frame {}", viewObjs->size(), frameid);
         inserted = callback(viewObjs->m_curr);
     }
@@ -417,7 +967,11 @@ ZENO_API bool GlobalComm::removeCache(int frame)
         for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dirToRemove))
         {
             std::string filePath = entry.path().string();
-            if (std::filesystem::is_directory(entry.path()) || filePath.substr(filePath.size() - 9) != ".zencache")
+            auto endsWith = [&] (std::string const &suffix) {
+                return filePath.size() >= suffix.size() && filePath.compare(filePath.size() - suffix.size(), suffix.size(), suffix) == 0;
+            };
+            // .zencache.tmp is left by a write that didn't finish, see ZencacheWriter::write
+            if (std::filesystem::is_directory(entry.path()) || !(endsWith(".zencache") || endsWith(".zencache.tmp")))
             {
                 hasZencacheOnly = false;
                 break;
@@ -430,14 +984,52 @@ ZENO_API bool GlobalComm::removeCache(int frame)
             zeno::log_info("remove dir: {}", dirToRemove);
         }
     }
-    if (frame == endFrameNumber && std::filesystem::exists(std::filesystem::u8path(cacheFramePath)) && std::filesystem::is_empty(std::filesystem::u8path(cacheFramePath)))
+    std::filesystem::path cacheDir = std::filesystem::u8path(cacheFramePath);
+    if (frame == endFrameNumber && std::filesystem::exists(cacheDir))
     {
-        std::filesystem::remove(std::filesystem::u8path(cacheFramePath));
-        zeno::log_info("remove dir: {}", std::filesystem::u8path(cacheFramePath).string());
+        // the memory reports of the runners go with the frames, the dir is kept if anything else is left
+        bool hasReportsOnly = true;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cacheDir))
+        {
+            if (entry.path().filename() != memoryReportDir)
+            {
+                hasReportsOnly = false;
+                break;
+            }
+        }
+        if (hasReportsOnly)
+        {
+            std::filesystem::remove_all(cacheDir);
+            zeno::log_info("remove dir: {}", cacheDir.string());
+        }
     }
     return true;
 }
 
+ZENO_API size_t GlobalComm::residentMemoryBytes(std::unordered_set<void const *> &visited) const {
+    std::lock_guard lck(m_mtx);
+    size_t bytes = 0;
+    for (auto const &frame: m_frames) {
+        for (auto const &[key, obj]: frame.view_objects)
+            bytes += objectMemoryBytes(obj.get(), visited);
+    }
+    return bytes;
+}
+
+ZENO_API size_t GlobalComm::frameMemoryBytes(int frameid) const {
+    std::lock_guard lck(m_mtx);
+    int frameIdx = frameid - beginFrameNumber;
+    if (frameIdx < 0 || frameIdx >= m_frames.size())
+        return 0;
+    return m_frames[frameIdx].memoryBytes;
+}
+
+ZENO_API void GlobalComm::updatePeakMemory(size_t bytes) {
+    std::lock_guard lck(m_mtx);
+    if (!m_frames.empty())
+        m_frames.back().peakMemoryBytes = std::max(m_frames.back().peakMemoryBytes, bytes);
+}
+
 ZENO_API void GlobalComm::removeCachePath()
 {
     std::lock_guard lck(m_mtx);
@@ -10,6 +10,7 @@ namespace zeno {
 ZENO_API void GlobalStatus::clearState() {
     nodeName = {};
     error = nullptr;
+    frameProfile.clear();
 }
 
 ZENO_API std::string GlobalStatus::toJson() const {
@@ -57,4 +58,32 @@ ZENO_API void GlobalStatus::fromJson(std::string_view json) {
     }
 }
 
+ZENO_API std::string GlobalStatus::frameProfileToJson() const {
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer writer(buf);
+    writer.StartArray();
+    for (auto const &[name, ms]: frameProfile) {
+        writer.StartArray();
+        writer.String(name.data(), name.size());
+        writer.Double(ms);
+        writer.EndArray();
+    }
+    writer.EndArray();
+    return {buf.GetString(), buf.GetLength()};
+}
+
+ZENO_API void GlobalStatus::frameProfileFromJson(std::string_view json) {
+    frameProfile.clear();
+    rapidjson::Document doc;
+    doc.Parse(json.data(), json.size());
+    if (!doc.IsArray()) {
+        log_warn("frame profile is not an array");
+        return;
+    }
+    for (auto const &entry: doc.GetArray()) {
+        if (entry.IsArray() && entry.Size() == 2 && entry[0].IsString() && entry[1].IsNumber())
+            frameProfile.emplace_back(std::string{entry[0].GetString(), entry[0].GetStringLength()}, entry[1].GetDouble());
+    }
+}
+
 }
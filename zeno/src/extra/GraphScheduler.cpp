@@ -0,0 +1,233 @@
+#include <zeno/extra/GraphScheduler.h>
+#include <zeno/extra/GraphException.h>
+#include <zeno/extra/DirtyChecker.h>
+#include <zeno/extra/ThreadPool.h>
+#include <zeno/core/Graph.h>
+#include <zeno/core/INode.h>
+#include <zeno/utils/log.h>
+
+namespace zeno {
+
+ZENO_API GraphScheduler::GraphScheduler(Graph *graph, ThreadPool *pool)
+    : m_graph(graph), m_pool(pool) {}
+
+ZENO_API GraphScheduler::~GraphScheduler() = default;
+
+ZENO_API bool GraphScheduler::plan(std::set<std::string> const &ids) {
+    auto const &nodes = m_graph->nodes;
+    auto sourcesOf = [&] (std::string const &id) {
+        std::set<std::string> res;
+        for (auto const &[ds, bound]: nodes.at(id)->inputBounds) {
+            if (nodes.find(bound.first) != nodes.end())
+                res.insert(bound.first);
+        }
+        return res;
+    };
+
+    // all nodes the legacy pull could reach, 1 = on stack, 2 = finished
+    std::map<std::string, int> reachable;
+    bool hasCycle = false;
+    auto visit = [&] (auto &&visit, std::string const &id) -> void {
+        auto [it, inserted] = reachable.try_emplace(id, 1);
+        if (!inserted) {
+            if (it->second == 1)
+                hasCycle = true;
+            return;
+        }
+        for (auto const &src: sourcesOf(id))
+            visit(visit, src);
+        reachable[id] = 2;
+    };
+    for (auto const &id: ids) {
+        if (nodes.find(id) == nodes.end())
+            return false;  // let the legacy path report it
+        visit(visit, id);
+    }
+    if (hasCycle)
+        return false;
+
+    // lazy nodes decide themselves which inputs to pull (and how often),
+    // so anything upstream of them must not be evaluated ahead of time
+    std::set<std::string> lazyUpstream;
+    auto markLazy = [&] (auto &&markLazy, std::string const &id) -> void {
+        if (!lazyUpstream.insert(id).second)
+            return;
+        for (auto const &src: sourcesOf(id))
+            markLazy(markLazy, src);
+    };
+    for (auto const &[id, _]: reachable) {
+        if (nodes.at(id)->hasLazyInputs())
+            markLazy(markLazy, id);
+    }
+
+    std::set<std::string> frontier;
+    for (auto const &id: ids) {
+        if (lazyUpstream.count(id))
+            frontier.insert(id);
+    }
+    for (auto const &[id, _]: reachable) {
+        if (lazyUpstream.count(id))
+            continue;
+        for (auto const &src: sourcesOf(id)) {
+            if (lazyUpstream.count(src))
+                frontier.insert(src);
+        }
+    }
+
+    // index in node name order, so that serial nodes are applied deterministically
+    m_lut.assign(m_graph->nodeList.size(), -1);
+    for (auto const &[id, node]: nodes) {
+        Kind kind;
+        if (frontier.count(id))
+            kind = Kind::Frontier;
+        else if (reachable.count(id) && !lazyUpstream.count(id))
+            kind = node->isThreadSafe() ? Kind::Parallel : Kind::Serial;
+        else
+            continue;
+        m_lut[node->nodeIndex] = (int)m_tasks.size();
+        m_tasks.emplace_back().node = node.get();
+        m_tasks.back().kind = kind;
+    }
+    for (auto &task: m_tasks) {
+        if (task.kind == Kind::Frontier)
+            continue;
+        int i = m_lut[task.node->nodeIndex];
+        for (auto const &src: sourcesOf(task.node->myname)) {
+            m_tasks[m_lut[nodes.at(src)->nodeIndex]].dependents.push_back(i);
+            task.numDeps++;
+        }
+    }
+    m_states = std::vector<std::atomic<int>>(m_tasks.size());
+    for (auto &state: m_states)
+        state = Pending;
+
+    log_debug("scheduled {} nodes ({} behind lazy nodes) on {} threads",
+              m_tasks.size(), lazyUpstream.size(), m_pool->numThreads());
+    return true;
+}
+
+bool GraphScheduler::isDirty(INode *node) const {
+    return m_graph->dirtyChecker && m_graph->dirtyChecker->amIDirty(node->myname);
+}
+
+void GraphScheduler::makeReady(int i) {
+    if (m_error)
+        return;
+    if (m_tasks[i].kind != Kind::Parallel) {
+        m_serialReady.insert(i);
+        return;
+    }
+    m_inflight++;
+    m_pool->submit([this, i] {
+        try {
+            runTask(i);
+        } catch (...) {
+            std::lock_guard lck(m_mtx);
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+        {
+            std::lock_guard lck(m_mtx);
+            m_inflight--;
+        }
+        m_cv.notify_all();
+    });
+}
+
+void GraphScheduler::finish(int i) {
+    {
+        std::lock_guard lck(m_mtx);
+        m_states[i] = Done;
+        for (int j: m_tasks[i].dependents) {
+            if (!--m_tasks[j].numDeps)
+                makeReady(j);
+        }
+    }
+    m_cv.notify_all();
+}
+
+bool GraphScheduler::execute(int i) {
+    int expected = Pending;
+    if (!m_states[i].compare_exchange_strong(expected, Running))
+        return false;
+    auto node = m_tasks[i].node;
+    try {
+        GraphException::translated([&] {
+            node->doApply();
+        }, node->myname);
+    } catch (...) {
+        {
+            std::lock_guard lck(m_mtx);
+            m_states[i] = Failed;
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+        m_cv.notify_all();
+        throw;
+    }
+    return true;
+}
+
+void GraphScheduler::runTask(int i) {
+    if (m_tasks[i].kind == Kind::Frontier) {
+        m_graph->applyNode(m_tasks[i].node->myname);
+        finish(i);
+    } else if (execute(i)) {
+        finish(i);
+    }
+}
+
+ZENO_API void GraphScheduler::run() {
+    std::unique_lock lck(m_mtx);
+    for (int i = 0; i < m_tasks.size(); i++) {
+        if (!m_tasks[i].numDeps)
+            makeReady(i);
+    }
+    while (true) {
+        // serial nodes only run when the pool is idle
+        m_cv.wait(lck, [&] { return !m_inflight; });
+        if (m_error || m_serialReady.empty())
+            break;
+        int i = *m_serialReady.begin();
+        m_serialReady.erase(m_serialReady.begin());
+        lck.unlock();
+        try {
+            runTask(i);
+        } catch (...) {
+            lck.lock();
+            if (!m_error)
+                m_error = std::current_exception();
+            continue;
+        }
+        lck.lock();
+    }
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+ZENO_API std::optional<bool> GraphScheduler::applyPlannedNode(INode *node) {
+    if (node->graph != m_graph || node->nodeIndex < 0 || node->nodeIndex >= (int)m_lut.size())
+        return std::nullopt;
+    int i = m_lut[node->nodeIndex];
+    if (i < 0)
+        return std::nullopt;
+    if (m_tasks[i].kind == Kind::Frontier) {
+        if (m_states[i] != Done)
+            return std::nullopt;  // still owned by the legacy pull
+        return isDirty(node);
+    }
+    if (m_states[i] != Done) {
+        if (execute(i)) {
+            // pulled ahead of schedule, e.g. by a lazy node
+            finish(i);
+        } else {
+            std::unique_lock lck(m_mtx);
+            m_cv.wait(lck, [&] { return m_states[i] != Running; });
+            if (m_states[i] == Failed)
+                std::rethrow_exception(m_error);
+        }
+    }
+    return isDirty(node);
+}
+
+}
@@ -0,0 +1,135 @@
+#include <zeno/extra/MemoryReport.h>
+#include <zeno/extra/GlobalComm.h>
+#include <zeno/funcs/ObjectMemory.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <fstream>
+
+namespace zeno {
+
+ZENO_API bool MemoryReport::enabled() {
+    static const bool on = envconfig::getInt("MEMORY_REPORT") != 0;
+    return on;
+}
+
+ZENO_API void MemoryReport::samplePeak(Graph const *graph, GlobalComm &comm) {
+    std::unordered_set<void const *> visited;
+    size_t bytes = graphMemoryBytes(graph, visited);
+    bytes += comm.residentMemoryBytes(visited);
+    comm.updatePeakMemory(bytes);
+}
+
+ZENO_API void MemoryReport::collect(Graph const *graph, GlobalComm &comm) {
+    std::unordered_set<void const *> visited;
+    nodes.clear();
+    nodeBytes = graphMemoryBytes(graph, visited, &nodes);
+    std::sort(nodes.begin(), nodes.end(), [] (auto const &a, auto const &b) {
+        return a.second > b.second;
+    });
+    residentBytes = nodeBytes + comm.residentMemoryBytes(visited);
+
+    frames.clear();
+    std::lock_guard lck(comm.m_mtx);
+    for (size_t i = 0; i < comm.m_frames.size(); i++) {
+        auto const &data = comm.m_frames[i];
+        if (!data.memoryBytes && !data.peakMemoryBytes)
+            continue;  // not computed by this runner
+        auto &frame = frames.emplace_back();
+        frame.frameid = comm.beginFrameNumber + (int)i;
+        frame.bytes = data.memoryBytes;
+        frame.peakBytes = data.peakMemoryBytes;
+        frame.inMemory = data.view_objects.size() != 0;
+        frame.inCache = comm.m_inCacheFrames.count(frame.frameid) != 0;
+    }
+}
+
+ZENO_API std::string MemoryReport::toJson() const {
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer writer(buf);
+    writer.StartObject();
+    writer.Key("nodeBytes");
+    writer.Uint64(nodeBytes);
+    writer.Key("residentBytes");
+    writer.Uint64(residentBytes);
+    writer.Key("nodes");
+    writer.StartArray();
+    for (auto const &[ident, bytes]: nodes) {
+        writer.StartArray();
+        writer.String(ident.data(), ident.size());
+        writer.Uint64(bytes);
+        writer.EndArray();
+    }
+    writer.EndArray();
+    writer.Key("frames");
+    writer.StartArray();
+    for (auto const &frame: frames) {
+        writer.StartObject();
+        writer.Key("frame");
+        writer.Int(frame.frameid);
+        writer.Key("bytes");
+        writer.Uint64(frame.bytes);
+        writer.Key("peakBytes");
+        writer.Uint64(frame.peakBytes);
+        writer.Key("inMemory");
+        writer.Bool(frame.inMemory);
+        writer.Key("inCache");
+        writer.Bool(frame.inCache);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetLength()};
+}
+
+ZENO_API void MemoryReport::fromJson(std::string_view json) {
+    *this = {};
+    rapidjson::Document doc;
+    doc.Parse(json.data(), json.size());
+    if (!doc.IsObject()) {
+        log_warn("memory report is not an object");
+        return;
+    }
+    if (doc.HasMember("nodeBytes") && doc["nodeBytes"].IsUint64())
+        nodeBytes = doc["nodeBytes"].GetUint64();
+    if (doc.HasMember("residentBytes") && doc["residentBytes"].IsUint64())
+        residentBytes = doc["residentBytes"].GetUint64();
+    if (doc.HasMember("nodes") && doc["nodes"].IsArray()) {
+        for (auto const &entry: doc["nodes"].GetArray()) {
+            if (entry.IsArray() && entry.Size() == 2 && entry[0].IsString() && entry[1].IsUint64())
+                nodes.emplace_back(std::string{entry[0].GetString(), entry[0].GetStringLength()}, entry[1].GetUint64());
+        }
+    }
+    if (doc.HasMember("frames") && doc["frames"].IsArray()) {
+        for (auto const &entry: doc["frames"].GetArray()) {
+            if (!entry.IsObject() || !entry.HasMember("frame") || !entry["frame"].IsInt())
+                continue;
+            auto &frame = frames.emplace_back();
+            frame.frameid = entry["frame"].GetInt();
+            if (entry.HasMember("bytes") && entry["bytes"].IsUint64())
+                frame.bytes = entry["bytes"].GetUint64();
+            if (entry.HasMember("peakBytes") && entry["peakBytes"].IsUint64())
+                frame.peakBytes = entry["peakBytes"].GetUint64();
+            if (entry.HasMember("inMemory") && entry["inMemory"].IsBool())
+                frame.inMemory = entry["inMemory"].GetBool();
+            if (entry.HasMember("inCache") && entry["inCache"].IsBool())
+                frame.inCache = entry["inCache"].GetBool();
+        }
+    }
+}
+
+ZENO_API bool MemoryReport::save(std::string const &path) const {
+    std::ofstream fout(path, std::ios::binary);
+    if (!fout) {
+        log_error("cannot open {} to write the memory report", path);
+        return false;
+    }
+    auto json = toJson();
+    fout.write(json.data(), json.size());
+    return fout.good();
+}
+
+}
@@ -43,4 +43,14 @@ ZENO_API void SubnetNode::apply() {
     }
 }
 
+ZENO_API bool SubnetNode::isFrameIndependent() const {
+    return !subgraph->hasFrameState();
+}
+
+ZENO_API void SubnetNode::resetFrameState() {
+    for (auto const &[id, node]: subgraph->nodes) {
+        node->resetFrameState();
+    }
+}
+
 }
@@ -0,0 +1,251 @@
+#include <zeno/extra/ThreadPool.h>
+#include <zeno/core/Session.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+#include <exception>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef _WIN32
+#include <zeno/utils/fuck_win.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace zeno {
+
+namespace {
+
+thread_local ThreadPool *tls_pool = nullptr;
+thread_local std::size_t tls_index = 0;
+
+void pinThisThread(std::size_t cpu) {
+    cpu %= std::max(1u, std::thread::hardware_concurrency());
+#ifdef _WIN32
+    if (cpu < 64)
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+// OpenMP regions in node code would start a whole team per busy worker,
+// so they get an even share of the pool and no nesting
+void limitOpenMP(std::size_t numThreads) {
+#ifdef _OPENMP
+    omp_set_num_threads((int)std::max<std::size_t>(1, numThreads));
+    omp_set_max_active_levels(1);
+#endif
+}
+
+// the team size is read when a region starts and can't follow how many workers are busy
+// later on, so every task gets the share it would have with all of the workers busy
+std::size_t openMPShare(std::size_t numWorkers) {
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency() / std::max<std::size_t>(1, numWorkers));
+}
+
+int currentOpenMPLimit() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 0;
+#endif
+}
+
+struct ParallelJob {
+    std::function<void(std::size_t)> const *body = nullptr;
+    std::size_t numTasks = 0;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    // claims indices until all are taken, so nobody ever waits for a task that is still queued
+    void work() {
+        std::size_t i;
+        while ((i = next++) < numTasks) {
+            if (!failed) {
+                try {
+                    (*body)(i);
+                } catch (...) {
+                    std::lock_guard lck(mtx);
+                    if (!error)
+                        error = std::current_exception();
+                    failed = true;
+                }
+            }
+            if (++done == numTasks) {
+                std::lock_guard lck(mtx);
+                cv.notify_all();
+            }
+        }
+    }
+};
+
+}
+
+ZENO_API ThreadPool::ThreadPool(std::size_t numThreads) : m_numThreads(numThreads) {
+    if (!m_numThreads)
+        m_numThreads = envconfig::getInt("THREADS", 0);
+    if (m_numThreads)
+        limitOpenMP(m_numThreads);
+    else
+        m_numThreads = std::max(1u, std::thread::hardware_concurrency());
+    m_pinThreads = envconfig::getBool("PIN_THREADS");
+    for (std::size_t i = 0; i < m_numThreads; i++)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+}
+
+ZENO_API ThreadPool::~ThreadPool() {
+    stop();
+}
+
+void ThreadPool::start() {
+    log_debug("starting thread pool with {} workers", m_numThreads);
+    for (std::size_t i = 0; i < m_numThreads; i++)
+        m_workers.emplace_back([this, i] { workerMain(i); });
+}
+
+void ThreadPool::stop() {
+    std::lock_guard slck(m_startMtx);
+    if (!m_started)
+        return;
+    {
+        std::lock_guard lck(m_sleepMtx);
+        m_stopping = true;
+    }
+    m_sleepCv.notify_all();
+    for (auto &worker: m_workers)
+        worker.join();
+    m_workers.clear();
+    m_stopping = false;
+    m_started = false;
+}
+
+bool ThreadPool::popTask(std::size_t index, std::function<void()> &task) {
+    {   // newest task of our own queue first, it's most likely still hot in cache
+        auto &q = *m_queues[index];
+        std::lock_guard lck(q.mtx);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k < m_numThreads; k++) {
+        // steal the oldest task of others
+        auto &q = *m_queues[(index + k) % m_numThreads];
+        std::lock_guard lck(q.mtx);
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerMain(std::size_t index) {
+    tls_pool = this;
+    tls_index = index;
+    if (m_pinThreads)
+        pinThisThread(index);
+    limitOpenMP(openMPShare(m_numThreads));
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            --m_numPending;
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock lck(m_sleepMtx);
+        m_sleepCv.wait(lck, [&] { return m_stopping || m_numPending > 0; });
+        if (m_stopping && m_numPending <= 0)
+            return;
+    }
+}
+
+ZENO_API void ThreadPool::submit(std::function<void()> task) {
+    if (!m_started) {
+        std::lock_guard lck(m_startMtx);
+        if (!m_started) {
+            start();
+            m_started = true;
+        }
+    }
+    std::size_t index = tls_pool == this ? tls_index : m_nextQueue++ % m_numThreads;
+    ++m_numPending;
+    {
+        auto &q = *m_queues[index];
+        std::lock_guard lck(q.mtx);
+        q.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard lck(m_sleepMtx);
+    }
+    m_sleepCv.notify_one();
+}
+
+ZENO_API std::size_t ThreadPool::numThreads() const {
+    return m_numThreads;
+}
+
+ZENO_API bool ThreadPool::inWorkerThread() {
+    return tls_pool != nullptr;
+}
+
+ZENO_API void ThreadPool::parallelRun(std::size_t numTasks, std::function<void(std::size_t)> const &body) {
+    if (numTasks <= 1) {
+        if (numTasks)
+            body(0);
+        return;
+    }
+    auto job = std::make_shared<ParallelJob>();
+    job->body = &body;
+    job->numTasks = numTasks;
+    std::size_t numHelpers = std::min(numTasks - 1, m_numThreads);
+    for (std::size_t k = 0; k < numHelpers; k++)
+        submit([job] { job->work(); });
+    if (inWorkerThread()) {
+        job->work();
+    } else {
+        // the calling thread works along with the pool, so it takes a worker's share too
+        int ompLimit = currentOpenMPLimit();
+        limitOpenMP(openMPShare(m_numThreads));
+        job->work();
+        limitOpenMP(ompLimit);
+    }
+    {
+        std::unique_lock lck(job->mtx);
+        job->cv.wait(lck, [&] { return job->done == numTasks; });
+    }
+    if (job->error)
+        std::rethrow_exception(job->error);
+}
+
+ZENO_API void ThreadPool::configure(std::size_t numThreads, bool pinThreads) {
+    if (!numThreads)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    stop();
+    m_numThreads = numThreads;
+    m_pinThreads = pinThreads;
+    m_queues.clear();
+    for (std::size_t i = 0; i < m_numThreads; i++)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    limitOpenMP(m_numThreads);
+    log_debug("thread pool set to {} workers{}", m_numThreads, m_pinThreads ? ", pinned" : "");
+}
+
+ZENO_API ThreadPool &getThreadPool() {
+    return *getSession().threadPool;
+}
+
+}
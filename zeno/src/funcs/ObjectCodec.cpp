@@ -10,6 +10,8 @@
 #include <zeno/utils/cppdemangle.h>
 #include <zeno/types/UserData.h>
 #include <zeno/utils/log.h>
+#include <zeno/utils/Profiler.h>
+#include <zeno/para/parallel_for.h>
 #include <algorithm>
 #include <cstring>
 
@@ -39,7 +41,7 @@ namespace _implObjectCodec {
 
 #define _PER_OBJECT_TYPE(TypeName, ...) \
 std::shared_ptr<TypeName> decode##TypeName(const char *it); \
-bool encode##TypeName(TypeName const *obj, std::back_insert_iterator<std::vector<char>> it);
+bool encode##TypeName(TypeName const *obj, ObjectWriter &writer);
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
@@ -70,6 +72,7 @@ ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 }
 
 std::shared_ptr<IObject> decodeObject(const char *buf, size_t len) {
+    ZENO_PROFILE_SCOPE("codec", "decodeObject");
     auto &header = *(ObjectHeader *)buf;
     if (header.magicNumber != ObjectHeader::kMagicNumber) {
         log_error("object header magic number mismatch");
@@ -100,18 +103,13 @@ std::shared_ptr<IObject> decodeObject(const char *buf, size_t len) {
     return object;
 }
 
-static bool _encodeObjectImpl(IObject const *object, std::vector<char> &buf) {
-    auto it = std::back_inserter(buf);
-    ObjectHeader header;
-    header.magicNumber = ObjectHeader::kMagicNumber;
-
+static bool _encodeObjectBody(IObject const *object, ObjectType &type, ObjectWriter &writer) {
     if (0) {
 
 #define _PER_OBJECT_TYPE(TypeName, ...) \
     } else if (auto obj = dynamic_cast<TypeName const *>(object)) { \
-        header.type = ObjectType::TypeName; \
-        it = std::copy_n((char *)&header, sizeof(ObjectHeader), it); \
-        return encode##TypeName(obj, it);
+        type = ObjectType::TypeName; \
+        return encode##TypeName(obj, writer);
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
@@ -121,29 +119,89 @@ ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
     }
 }
 
-bool encodeObject(IObject const *object, std::vector<char> &buf) {
-    auto oldsize = buf.size();
-    if (!_encodeObjectImpl(object, buf))
+namespace _implObjectCodec {
+
+ZENO_API void ObjectWriter::flush() {
+    // split into chunks so that a single huge attribute is spread over threads as well
+    constexpr size_t kChunk = 1 << 20;
+    std::vector<std::tuple<char *, char const *, size_t>> chunks;
+    for (auto const &[dst, src, size]: m_bulkCopies)
+        for (size_t i = 0; i < size; i += kChunk)
+            chunks.emplace_back(dst + i, src + i, std::min(kChunk, size - i));
+    m_bulkCopies.clear();
+    parallel_for(chunks.size(), [&] (size_t i) {
+        auto const &[dst, src, size] = chunks[i];
+        std::memcpy(dst, src, size);
+    });
+}
+
+ZENO_API bool encodeObjectTo(IObject const *object, ObjectWriter &writer) {
+    // the header points past the body, so everything is measured before the first byte goes out
+    ObjectHeader header;
+    header.magicNumber = ObjectHeader::kMagicNumber;
+    ObjectWriter bodySize;
+    if (!_encodeObjectBody(object, header.type, bodySize))
         return false;
 
-    std::vector<std::vector<char>> valbufs;
+    std::vector<std::pair<std::string const *, IObject const *>> userData;
+    std::vector<size_t> userDataSizes;
     for (auto const &[key, val]: object->userData()) {
-        std::vector<char> valbuf;
-        size_t keysize = key.size();
-        valbuf.insert(valbuf.end(), (char *)&keysize, (char *)(&keysize + 1));
-        valbuf.insert(valbuf.end(), key.begin(), key.end());
-        if (encodeObject(val.get(), valbuf))
-            valbufs.push_back(std::move(valbuf));
+        ObjectWriter valSize;
+        if (encodeObjectTo(val.get(), valSize)) {
+            userData.emplace_back(&key, val.get());
+            userDataSizes.push_back(valSize.offset());
+        }
     }
-    auto &header = *(ObjectHeader *)(buf.data() + oldsize);
-    header.numUserData = valbufs.size();
-    header.beginUserData = buf.size() - oldsize;
-    for (auto const &valbuf: valbufs) {
-        size_t valbufsize = valbuf.size();
-        buf.insert(buf.end(), (char *)&valbufsize, (char *)(&valbufsize + 1));
-        buf.insert(buf.end(), valbuf.begin(), valbuf.end());
+    header.numUserData = userData.size();
+    header.beginUserData = sizeof(ObjectHeader) + bodySize.offset();
+
+    if (writer.measuring()) {
+        writer.m_offset += header.beginUserData;
+        for (size_t i = 0; i < userData.size(); i++)
+            writer.m_offset += sizeof(size_t) * 2 + userData[i].first->size() + userDataSizes[i];
+        return true;
+    }
+
+    writer.writeValue(header);
+    _encodeObjectBody(object, header.type, writer);
+    for (size_t i = 0; i < userData.size(); i++) {
+        auto const &key = *userData[i].first;
+        size_t keysize = key.size();
+        size_t valbufsize = sizeof(keysize) + keysize + userDataSizes[i];
+        writer.writeValue(valbufsize);
+        writer.writeValue(keysize);
+        writer.write(key.data(), keysize);
+        encodeObjectTo(userData[i].second, writer);
     }
     return true;
 }
 
 }
+
+size_t encodedObjectSize(IObject const *object) {
+    ObjectWriter writer;
+    if (!encodeObjectTo(object, writer))
+        return 0;
+    return writer.offset();
+}
+
+bool encodeObject(IObject const *object, std::vector<char> &buf) {
+    ZENO_PROFILE_SCOPE("codec", "encodeObject");
+    auto size = encodedObjectSize(object);
+    if (!size)
+        return false;
+    auto oldsize = buf.size();
+    buf.resize(oldsize + size);
+    ObjectWriter writer(buf.data() + oldsize);
+    encodeObjectTo(object, writer);
+    writer.flush();
+    return true;
+}
+
+bool encodeObject(IObject const *object, EncodeSink const &sink) {
+    ZENO_PROFILE_SCOPE("codec", "encodeObject");
+    ObjectWriter writer(&sink);
+    return encodeObjectTo(object, writer);
+}
+
+}
@@ -16,9 +16,9 @@ std::shared_ptr<CameraObject> decodeCameraObject(const char *it) {
     return obj;
 }
 
-bool encodeCameraObject(CameraObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeCameraObject(CameraObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    it = std::copy_n((char const *)static_cast<CameraData const *>(obj), sizeof(CameraData), it);
+bool encodeCameraObject(CameraObject const *obj, ObjectWriter &writer);
+bool encodeCameraObject(CameraObject const *obj, ObjectWriter &writer) {
+    writer.writeValue(*static_cast<CameraData const *>(obj));
     return true;
 }
 
@@ -29,9 +29,9 @@ std::shared_ptr<LightObject> decodeLightObject(const char *it) {
     return obj;
 }
 
-bool encodeLightObject(LightObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeLightObject(LightObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    it = std::copy_n((char const *)static_cast<LightData const *>(obj), sizeof(LightData), it);
+bool encodeLightObject(LightObject const *obj, ObjectWriter &writer);
+bool encodeLightObject(LightObject const *obj, ObjectWriter &writer) {
+    writer.writeValue(*static_cast<LightData const *>(obj));
     return true;
 }
 
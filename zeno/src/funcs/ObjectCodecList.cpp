@@ -1,6 +1,7 @@
 #include <zeno/types/ListObject.h>
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/utils/log.h>
+#include <zeno/para/parallel_for.h>
 #include <algorithm>
 #include <cstring>
 
@@ -20,37 +21,49 @@ std::shared_ptr<ListObject> decodeListObject(const char *it) {
     it += sizeof(size_t) * tab.size();
 
     obj->arr.resize(size);
-    for (size_t i = 0; i < size; i++) {
+    std::vector<char> failed(size);
+    parallel_for(size, [&] (size_t i) {
         auto elm = decodeObject(it + tab[i * 2], tab[i * 2 + 1]);
-        if (!elm) return nullptr;
+        failed[i] = !elm;
         obj->arr[i] = std::move(elm);
-    }
+    });
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+        return nullptr;
 
     return obj;
 }
 
-bool encodeListObject(ListObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeListObject(ListObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeListObject(ListObject const *obj, ObjectWriter &writer);
+bool encodeListObject(ListObject const *obj, ObjectWriter &writer) {
     size_t size = obj->arr.size();
-    std::copy_n((char const *)&size, sizeof(size), it);
+    writer.writeValue(size);
 
-    std::vector<char> buf;
-    std::vector<char> fin;
+    // the table of offsets comes first, so elements are measured before any is written
     std::vector<size_t> tab(size * 2);
     size_t base = 0;
     for (size_t i = 0; i < size; i++) {
-        auto const *elm = obj->arr[i].get();
-        if (!encodeObject(elm, buf))
+        ObjectWriter elmSize;
+        if (!encodeObjectTo(obj->arr[i].get(), elmSize))
             return false;
-        size_t len = buf.size();
-        fin.insert(fin.end(), buf.begin(), buf.end());
-        buf.clear();
         tab[i * 2] = base;
-        tab[i * 2 + 1] = len;
-        base += len;
+        tab[i * 2 + 1] = elmSize.offset();
+        base += elmSize.offset();
+    }
+    writer.write(tab.data(), tab.size() * sizeof(size_t));
+    if (writer.measuring()) {
+        writer.m_offset += base;
+    } else if (writer.m_dst) {
+        // each element has its own place already, encode them all at once
+        char *dst = writer.claim(base);
+        parallel_for(size, [&] (size_t i) {
+            ObjectWriter elmWriter(dst + tab[i * 2]);
+            encodeObjectTo(obj->arr[i].get(), elmWriter);
+            elmWriter.flush();
+        });
+    } else {
+        for (size_t i = 0; i < size; i++)
+            encodeObjectTo(obj->arr[i].get(), writer);
     }
-    std::copy_n(tab.data(), tab.size() * sizeof(size_t), it);
-    std::copy(fin.begin(), fin.end(), it);
 
     return true;
 }
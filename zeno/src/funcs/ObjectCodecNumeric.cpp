@@ -27,13 +27,12 @@ std::shared_ptr<NumericObject> decodeNumericObject(const char *it) {
     return succ ? obj : nullptr;
 }
 
-bool encodeNumericObject(NumericObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeNumericObject(NumericObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeNumericObject(NumericObject const *obj, ObjectWriter &writer);
+bool encodeNumericObject(NumericObject const *obj, ObjectWriter &writer) {
     size_t index = obj->value.index();
-    it = std::copy_n((char const *)&index, sizeof(index), it);
+    writer.writeValue(index);
     std::visit([&] (auto const &val) {
-        using T = std::decay_t<decltype(val)>;
-        it = std::copy_n((char const *)&val, sizeof(val), it);
+        writer.writeValue(val);
     }, obj->value);
     return true;
 }
@@ -47,12 +46,12 @@ std::shared_ptr<StringObject> decodeStringObject(const char *it) {
     return obj;
 }
 
-bool encodeStringObject(StringObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeStringObject(StringObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeStringObject(StringObject const *obj, ObjectWriter &writer);
+bool encodeStringObject(StringObject const *obj, ObjectWriter &writer) {
     size_t size = obj->value.size();
     char const *data = obj->value.data();
-    it = std::copy_n((char const *)&size, sizeof(size), it);
-    it = std::copy_n(data, size, it);
+    writer.writeValue(size);
+    writer.writeBulk(data, size);
     return true;
 }
 
@@ -29,8 +29,13 @@ void decodeAttrVector(AttrVector<T0> &arr, It &it) {
     AttrVectorHeader header;
     std::copy_n(it, sizeof(header), (char *)&header);
     it += sizeof(header);
-    arr.values.reserve(header.size);
-    std::copy_n((T0 const *)it, header.size, std::back_inserter(arr.values));
+    // one memcpy per array, not a push_back per element; the arrays are not aligned in the
+    // file, so they are only read as bytes. They can't borrow the mapped pages instead:
+    // CowVector hands out std::vector references, and the file may be rewritten by the
+    // next run while the decoded objects are still alive
+    auto &values = arr.values.mut();
+    values.resize(header.size);
+    std::memcpy(values.data(), it, sizeof(T0) * header.size);
     it += sizeof(T0) * header.size;
 
     for (int a = 0; a < header.nattrs; a++) {
@@ -40,23 +45,22 @@ void decodeAttrVector(AttrVector<T0> &arr, It &it) {
         std::string key{h.name, h.namelen};
         index_switch<std::variant_size_v<AttrAcceptAll>>((size_t)h.type, [&] (auto type) {
             using T = std::variant_alternative_t<type.value, AttrAcceptAll>;
-            auto &attr = arr.template add_attr<T>(key);
-            attr.clear();
-            attr.reserve(h.size);
-            std::copy_n((T const *)it, h.size, std::back_inserter(attr));
+            CowVector<T> attr(h.size);
+            std::memcpy(attr.data(), it, sizeof(T) * h.size);
+            arr.attrs[key] = std::move(attr);
             it += sizeof(T) * h.size;
         });
     }
     arr.update();
 }
 
-template <class T0, class It>
-void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
+template <class T0>
+void encodeAttrVector(AttrVector<T0> const &arr, ObjectWriter &writer) {
     AttrVectorHeader header;
     header.size = arr.size();
     header.nattrs = arr.template num_attrs<AttrAcceptAll>();
-    it = std::copy_n((char const *)&header, sizeof(header), it);
-    it = std::copy_n((char const *)arr.data(), sizeof(T0) * arr.size(), it);
+    writer.writeValue(header);
+    writer.writeBulk(arr.data(), sizeof(T0) * arr.size());
 
     arr.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
         AttributeHeader h;
@@ -65,13 +69,15 @@ void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
         h.size = attr.size();
         h.namelen = key.size();
         std::strncpy(h.name, key.c_str(), sizeof(h.name));
-        it = std::copy_n((char const *)&h, sizeof(h), it);
-        it = std::copy_n((char const *)attr.data(), sizeof(T) * attr.size(), it);
+        writer.writeValue(h);
+        writer.writeBulk(attr.data(), sizeof(T) * attr.size());
     });
 }
 
 }
 
+bool encodeMaterialObject(MaterialObject const *obj, ObjectWriter &writer);
+
 std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it);
 std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it) {
     auto obj = std::make_shared<PrimitiveObject>();
@@ -91,23 +97,22 @@ std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it) {
     return obj;
 }
 
-bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    encodeAttrVector(obj->verts, it);
-    encodeAttrVector(obj->points, it);
-    encodeAttrVector(obj->lines, it);
-    encodeAttrVector(obj->tris, it);
-    encodeAttrVector(obj->quads, it);
-    encodeAttrVector(obj->loops, it);
-    encodeAttrVector(obj->polys, it);
-    encodeAttrVector(obj->edges, it);
-    encodeAttrVector(obj->uvs, it);
+bool encodePrimitiveObject(PrimitiveObject const *obj, ObjectWriter &writer);
+bool encodePrimitiveObject(PrimitiveObject const *obj, ObjectWriter &writer) {
+    encodeAttrVector(obj->verts, writer);
+    encodeAttrVector(obj->points, writer);
+    encodeAttrVector(obj->lines, writer);
+    encodeAttrVector(obj->tris, writer);
+    encodeAttrVector(obj->quads, writer);
+    encodeAttrVector(obj->loops, writer);
+    encodeAttrVector(obj->polys, writer);
+    encodeAttrVector(obj->edges, writer);
+    encodeAttrVector(obj->uvs, writer);
     if (obj->mtl) {
-        *it++ = '1';
-        for (char c: obj->mtl->serialize())
-            *it++ = c;
+        writer.writeValue('1');
+        encodeMaterialObject(obj->mtl.get(), writer);
     } else {
-        *it++ = '0';
+        writer.writeValue('0');
     }
     return true;
 }
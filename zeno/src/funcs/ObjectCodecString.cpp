@@ -16,10 +16,14 @@ std::shared_ptr<MaterialObject> decodeMaterialObject(const char *it) {
     return mtl;
 }
 
-bool encodeMaterialObject(MaterialObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeMaterialObject(MaterialObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    auto v = obj->serialize();
-    std::copy(v.begin(), v.end(), it);
+bool encodeMaterialObject(MaterialObject const *obj, ObjectWriter &writer);
+bool encodeMaterialObject(MaterialObject const *obj, ObjectWriter &writer) {
+    if (writer.m_sink) {
+        auto v = obj->serialize();
+        writer.write(v.data(), v.size());
+    } else if (auto p = writer.claim(obj->serializeSize())) {
+        obj->serialize(p);  // in place, no temporary
+    }
     return true;
 }
 
@@ -28,8 +32,8 @@ std::shared_ptr<DummyObject> decodeDummyObject(const char *it) {
     return std::make_shared<DummyObject>();
 }
 
-bool encodeDummyObject(DummyObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeDummyObject(DummyObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeDummyObject(DummyObject const *obj, ObjectWriter &writer);
+bool encodeDummyObject(DummyObject const *obj, ObjectWriter &writer) {
     return true;
 }
 
@@ -0,0 +1,138 @@
+#include <zeno/funcs/ObjectMemory.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/InstancingObject.h>
+#include <zeno/types/MaterialObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/types/ListObject.h>
+#include <zeno/types/DictObject.h>
+#include <zeno/types/UserData.h>
+#include <zeno/extra/SubnetNode.h>
+#include <zeno/core/INode.h>
+#include <zeno/core/Graph.h>
+
+namespace zeno {
+
+namespace {
+
+template <class T>
+size_t vectorBytes(std::vector<T> const &arr, std::unordered_set<void const *> &visited) {
+    if (!arr.capacity() || !visited.insert(arr.data()).second)
+        return 0;
+    return arr.capacity() * sizeof(T);
+}
+
+// copies sharing the elements have the same data()
+template <class T>
+size_t vectorBytes(CowVector<T> const &arr, std::unordered_set<void const *> &visited) {
+    return vectorBytes(arr.get(), visited);
+}
+
+size_t stringBytes(std::string const &str) {
+    // short strings live inside the object
+    return str.capacity() > sizeof(std::string) ? str.capacity() : 0;
+}
+
+template <class T>
+size_t attrVectorBytes(AttrVector<T> const &attr, std::unordered_set<void const *> &visited) {
+    size_t bytes = vectorBytes(attr.values, visited);
+    for (auto const &[key, arr]: attr.attrs) {
+        bytes += stringBytes(key);
+        std::visit([&] (auto const &arr) {
+            bytes += vectorBytes(arr, visited);
+        }, arr);
+    }
+    return bytes;
+}
+
+size_t primitiveBytes(PrimitiveObject const *prim, std::unordered_set<void const *> &visited) {
+    size_t bytes = sizeof(PrimitiveObject);
+    bytes += attrVectorBytes(prim->verts, visited);
+    bytes += attrVectorBytes(prim->points, visited);
+    bytes += attrVectorBytes(prim->lines, visited);
+    bytes += attrVectorBytes(prim->tris, visited);
+    bytes += attrVectorBytes(prim->quads, visited);
+    bytes += attrVectorBytes(prim->loops, visited);
+    bytes += attrVectorBytes(prim->polys, visited);
+    bytes += attrVectorBytes(prim->edges, visited);
+    bytes += attrVectorBytes(prim->uvs, visited);
+    bytes += objectMemoryBytes(prim->mtl.get(), visited);
+    if (prim->inst && visited.insert(prim->inst.get()).second) {
+        bytes += sizeof(InstancingObject);
+        bytes += vectorBytes(prim->inst->modelMatrices, visited);
+        bytes += vectorBytes(prim->inst->timeList, visited);
+        bytes += vectorBytes(prim->inst->vertexFrameBuffer, visited);
+        for (auto const &frame: prim->inst->vertexFrameBuffer)
+            bytes += vectorBytes(frame, visited);
+    }
+    return bytes;
+}
+
+size_t materialBytes(MaterialObject const *mtl, std::unordered_set<void const *> &visited) {
+    size_t bytes = sizeof(MaterialObject);
+    for (auto const *str: {&mtl->vert, &mtl->frag, &mtl->common, &mtl->extensions, &mtl->parameters, &mtl->mtlidkey})
+        bytes += stringBytes(*str);
+    bytes += vectorBytes(mtl->tex2Ds, visited);
+    bytes += vectorBytes(mtl->tex3Ds, visited);
+    return bytes;
+}
+
+}
+
+ZENO_API size_t objectMemoryBytes(IObject const *object) {
+    std::unordered_set<void const *> visited;
+    return objectMemoryBytes(object, visited);
+}
+
+ZENO_API size_t objectMemoryBytes(IObject const *object, std::unordered_set<void const *> &visited) {
+    if (!object || !visited.insert(object).second)
+        return 0;
+
+    size_t bytes = 0;
+    if (auto prim = dynamic_cast<PrimitiveObject const *>(object)) {
+        bytes = primitiveBytes(prim, visited);
+    } else if (auto list = dynamic_cast<ListObject const *>(object)) {
+        bytes = sizeof(ListObject) + vectorBytes(list->arr, visited);
+        for (auto const &child: list->arr)
+            bytes += objectMemoryBytes(child.get(), visited);
+    } else if (auto dict = dynamic_cast<DictObject const *>(object)) {
+        bytes = sizeof(DictObject);
+        for (auto const &[key, child]: dict->lut)
+            bytes += stringBytes(key) + objectMemoryBytes(child.get(), visited);
+    } else if (auto str = dynamic_cast<StringObject const *>(object)) {
+        bytes = sizeof(StringObject) + stringBytes(str->value);
+    } else if (auto mtl = dynamic_cast<MaterialObject const *>(object)) {
+        bytes = materialBytes(mtl, visited);
+    } else {
+        // the small fixed size objects, numerics, cameras, lights...
+        bytes = sizeof(IObject);
+    }
+
+    // not through userData(), which would create it
+    if (auto ud = std::any_cast<UserData>(&object->m_userData)) {
+        for (auto const &[key, child]: ud->m_data)
+            bytes += stringBytes(key) + objectMemoryBytes(child.get(), visited);
+    }
+    return bytes;
+}
+
+ZENO_API size_t graphMemoryBytes(Graph const *graph, std::unordered_set<void const *> &visited,
+                                 std::vector<std::pair<std::string, size_t>> *perNode) {
+    size_t total = 0;
+    for (auto const &[ident, node]: graph->nodes) {
+        size_t bytes = 0;
+        for (auto const &[key, obj]: node->outputs)
+            bytes += objectMemoryBytes(obj.get(), visited);
+        if (auto subnet = dynamic_cast<SubnetNode const *>(node.get())) {
+            std::vector<std::pair<std::string, size_t>> subNodes;
+            bytes += graphMemoryBytes(subnet->subgraph.get(), visited, perNode ? &subNodes : nullptr);
+            for (auto &[subIdent, subBytes]: subNodes)
+                perNode->emplace_back(ident + "/" + subIdent, subBytes);
+        }
+        if (perNode && bytes)
+            perNode->emplace_back(ident, bytes);
+        total += bytes;
+    }
+    return total;
+}
+
+}
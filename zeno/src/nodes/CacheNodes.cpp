@@ -12,6 +12,14 @@ namespace zeno {
 struct CachedByKey : zeno::INode {
     std::map<std::string, std::shared_ptr<IObject>> cache;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        cache.clear();
+    }
+
     virtual void preApply() override {
         requireInput("key");
         auto key = get_input<zeno::StringObject>("key")->get();
@@ -26,6 +34,10 @@ struct CachedByKey : zeno::INode {
         }
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {}
 };
 
@@ -40,6 +52,14 @@ ZENDEFNODE(CachedByKey, {
 struct CachedIf : zeno::INode {
     bool m_done = false;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        m_done = false;
+    }
+
     virtual void preApply() override {
         if (has_input("keepCache")) {
             requireInput("keepCache");
@@ -54,6 +74,10 @@ struct CachedIf : zeno::INode {
         }
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto ptr = get_input("input");
         set_output("output", std::move(ptr));
@@ -70,6 +94,20 @@ ZENDEFNODE(CachedIf, {
 
 struct CachedOnce : zeno::INode {
     bool m_done = false;
+    zany m_first;  // the input as computed, for the next run to start from
+
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        // the frames may have changed the output in place, as solvers do with their state,
+        // so a run starts from a copy of the input instead of computing it again
+        if (auto obj = m_first ? m_first->clone() : nullptr)
+            set_output("output", std::move(obj));
+        else
+            m_done = false;
+    }
 
     virtual void preApply() override {
         if (!m_done) {
@@ -78,8 +116,13 @@ struct CachedOnce : zeno::INode {
         }
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto ptr = get_input("input");
+        m_first = ptr->clone();
         set_output("output", std::move(ptr));
     }
 };
@@ -94,6 +137,14 @@ ZENDEFNODE(CachedOnce, {
 struct CacheLastFrameBegin : zeno::INode {
     std::shared_ptr<IObject> m_lastFrameCache = nullptr;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        m_lastFrameCache = nullptr;
+    }
+
     virtual void apply() override { 
         if (m_lastFrameCache == nullptr) {
             m_lastFrameCache = (*get_input("input")).clone();            
@@ -120,6 +171,10 @@ ZENO_DEFNODE(CacheLastFrameBegin)(
 struct CacheLastFrameEnd : zeno::INode {
     CacheLastFrameBegin* m_CacheLastFrameBegin;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
     virtual void apply() override {
         if (auto it = inputBounds.find("linkTo"); it != inputBounds.end()) {
             auto [sn, ss] = it->second;
@@ -124,6 +124,10 @@ struct BreakFor : zeno::INode {
         }
     }
 
+    virtual bool isThreadSafe() const override {
+        return false;
+    }
+
     //virtual void apply() override {}
 };
 
@@ -310,6 +314,10 @@ struct SubstepDt : zeno::INode {
         ret_portion->set(portion);
         set_output("portion", std::move(ret_portion));
     }
+
+    virtual bool isThreadSafe() const override {
+        return false;
+    }
 };
 
 ZENDEFNODE(SubstepDt, {
@@ -345,6 +353,10 @@ struct IfElse : zeno::INode {
         apply();
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {}
 };
 
@@ -35,17 +35,20 @@ struct CacheToDisk : zeno::INode {
         INode::preApply();
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto obj = get_input("object");
         if (obj) {
-            std::vector<char> out;
-            encodeObject(obj.get(), out);
             auto cachefile = getCachePath();
-            if (std::ofstream ofs(cachefile); !ofs) {
+            if (std::ofstream ofs(cachefile, std::ios::binary); !ofs) {
                 log_error("failed to open file for write: {}", cachefile);
             } else {
-                std::ostreambuf_iterator<char> oit(ofs);
-                std::copy(out.begin(), out.end(), oit);
+                encodeObject(obj.get(), [&] (const char *data, size_t size) {
+                    ofs.write(data, size);
+                });
             }
         }
         set_output("object", std::move(obj));
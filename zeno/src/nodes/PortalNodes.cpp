@@ -14,6 +14,10 @@ struct PortalIn : zeno::INode {
         graph->portalIns[name] = this->myname;
     }
 
+    virtual bool isThreadSafe() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto name = get_param<std::string>("name");
         auto obj = get_input("port");
@@ -29,6 +33,10 @@ ZENDEFNODE(PortalIn, {
 });
 
 struct PortalOut : zeno::INode {
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto name = get_param<std::string>("name");
         auto depnode = zeno::safe_at(graph->portalIns, name, "PortalIn");
@@ -207,6 +207,11 @@ namespace zeno {
         static int defFunctionObjectDefactory = capiRegisterObjectDefactory("FunctionObject", defactoryFunctionObject);
 
         struct PythonNode : zeno::INode {
+            // the interpreter is global and not reentrant
+            virtual bool isThreadSafe() const override {
+                return false;
+            }
+
             void apply() override {
                 bool onlyui_gen = get_param<bool>("onlyui");
                 if (onlyui_gen)
@@ -45,6 +45,10 @@ ZENDEFNODE(MakeReadPath, {
 });
 
 struct MakeString : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto obj = std::make_unique<zeno::StringObject>();
         obj->set(get_param<std::string>("value"));
@@ -70,6 +74,10 @@ ZENDEFNODE(MakeMultilineString, {
 });
 
 struct StringEqual : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto lhs = get_input2<std::string>("lhs");
         auto rhs = get_input2<std::string>("rhs");
@@ -652,6 +660,10 @@ ZENDEFNODE(StringReplace, {
 });
 
 struct StringFind : zeno::INode {//return -1 if not found
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto string = get_input2<std::string>("string");
         auto substring = get_input2<std::string>("substring");
@@ -675,6 +687,10 @@ ZENDEFNODE(StringFind, {
 });
 
 struct SubString : zeno::INode {//slice...
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto string = get_input2<std::string>("string");
         auto start = get_input2<int>("start");
@@ -703,6 +719,10 @@ ZENDEFNODE(SubString, {
 });
 
 struct StringtoLower : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto string = get_input2<std::string>("string");
         std::string output = string;
@@ -723,6 +743,10 @@ ZENDEFNODE(StringtoLower, {
 });
 
 struct StringtoUpper : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto string = get_input2<std::string>("string");
         std::string output = string;
@@ -743,6 +767,10 @@ ZENDEFNODE(StringtoUpper, {
 });
 
 struct StringLength : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto string = get_input2<std::string>("string");
         int output = string.length();
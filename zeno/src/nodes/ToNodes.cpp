@@ -95,6 +95,14 @@ ZENDEFNODE(HelperMute, {
 struct HelperOnce : zeno::INode {
     bool m_done = false;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        m_done = false;
+    }
+
     virtual void preApply() override {
         if (!m_done) {
             INode::preApply();
@@ -102,6 +110,10 @@ struct HelperOnce : zeno::INode {
         }
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
         for (auto const &[name, _]: this->inputs) {
             if (name == "SRC") continue;//sk
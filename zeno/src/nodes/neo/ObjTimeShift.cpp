@@ -7,6 +7,14 @@ namespace {
 struct ObjTimeShift : INode {
     std::vector<std::shared_ptr<IObject>> m_objseq;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        m_objseq.clear();
+    }
+
     virtual void apply() override {
         auto obj = get_input<IObject>("obj");
         auto offset = get_input2<int>("offset");
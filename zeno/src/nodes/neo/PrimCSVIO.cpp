@@ -10,19 +10,17 @@
 namespace zeno {
 namespace {
 
-static void dump(int const &v, std::ostream &fout) {
-    fout << v;
-}
-
-static void dump(float const &v, std::ostream &fout) {
-    fout << v;
+// + so that uint8_t is written as a number and half as a float
+template <class T, std::enable_if_t<!is_vec_v<T>, int> = 0>
+static void dump(T const &v, std::ostream &fout) {
+    fout << +v;
 }
 
 template <size_t N, class T>
 static void dump(vec<N, T> const &v, std::ostream &fout) {
-    fout << v[0];
+    fout << +v[0];
     for (int i = 1; i < N; i++)
-        fout << ' ' << v[i];
+        fout << ' ' << +v[i];
 }
 
 template <class T>
@@ -24,8 +24,8 @@ struct PrimMatchUVLine : INode {
         auto const &uv = prim->verts.attr<float>(uvAttr);
         auto const &uv2 = prim2->verts.attr<float>(uvAttr2);
 
-        auto &pos = prim->verts.values;
-        auto &pos2 = prim2->verts.values;
+        auto &pos = prim->verts.values.mut();
+        auto const &pos2 = prim2->verts.values.get();
 
         std::vector<std::vector<int>> neigh(prim2->verts.size());
         for (auto ind: prim2->lines) {
@@ -59,14 +59,23 @@ static void set_special_attr_remap(PrimitiveObject *p, std::string attr_name, st
             cur_faceset_index_map[i] = facesetNameMap[path];
         }
 
-        for (int i = 0; i < p->tris.size(); i++) {
-            p->tris.attr<int>(attr_name)[i] = cur_faceset_index_map[p->tris.attr<int>(attr_name)[i]];
+        if (p->tris.size() > 0) {
+            auto &tris_faceset = p->tris.attr<int>(attr_name);
+            for (int i = 0; i < p->tris.size(); i++) {
+                tris_faceset[i] = cur_faceset_index_map[tris_faceset[i]];
+            }
         }
-        for (int i = 0; i < p->quads.size(); i++) {
-            p->quads.attr<int>(attr_name)[i] = cur_faceset_index_map[p->quads.attr<int>(attr_name)[i]];
+        if (p->quads.size() > 0) {
+            auto &quads_faceset = p->quads.attr<int>(attr_name);
+            for (int i = 0; i < p->quads.size(); i++) {
+                quads_faceset[i] = cur_faceset_index_map[quads_faceset[i]];
+            }
         }
-        for (int i = 0; i < p->polys.size(); i++) {
-            p->polys.attr<int>(attr_name)[i] = cur_faceset_index_map[p->polys.attr<int>(attr_name)[i]];
+        if (p->polys.size() > 0) {
+            auto &polys_faceset = p->polys.attr<int>(attr_name);
+            for (int i = 0; i < p->polys.size(); i++) {
+                polys_faceset[i] = cur_faceset_index_map[polys_faceset[i]];
+            }
         }
     }
 }
@@ -81,19 +90,28 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMergeWithFacesetMatid(std::v
         if (matNum > 0) {
             //for p's tris, quads...
             //    tris("matid")[i] += matNameList.size();
-            for (int i = 0; i < p->tris.size(); i++) {
-                if (p->tris.attr<int>("matid")[i] != -1) {
-                    p->tris.attr<int>("matid")[i] += matNameList.size();
+            if (p->tris.size() > 0) {
+                auto &tris_matid = p->tris.attr<int>("matid");
+                for (int i = 0; i < p->tris.size(); i++) {
+                    if (tris_matid[i] != -1) {
+                        tris_matid[i] += matNameList.size();
+                    }
                 }
             }
-            for (int i = 0; i < p->quads.size(); i++) {
-                if (p->quads.attr<int>("matid")[i] != -1) {
-                    p->quads.attr<int>("matid")[i] += matNameList.size();
+            if (p->quads.size() > 0) {
+                auto &quads_matid = p->quads.attr<int>("matid");
+                for (int i = 0; i < p->quads.size(); i++) {
+                    if (quads_matid[i] != -1) {
+                        quads_matid[i] += matNameList.size();
+                    }
                 }
             }
-            for (int i = 0; i < p->polys.size(); i++) {
-                if (p->polys.attr<int>("matid")[i] != -1) {
-                    p->polys.attr<int>("matid")[i] += matNameList.size();
+            if (p->polys.size() > 0) {
+                auto &polys_matid = p->polys.attr<int>("matid");
+                for (int i = 0; i < p->polys.size(); i++) {
+                    if (polys_matid[i] != -1) {
+                        polys_matid[i] += matNameList.size();
+                    }
                 }
             }
             //for p's materials
@@ -210,7 +228,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                   prim->polys.size())) {
                 auto nverts = prim->verts.size();
                 prim->points.resize(nverts);
-                parallel_for(nverts, [&points = prim->points.values](size_t i) { points[i] = i; });
+                parallel_for(nverts, [&points = prim->points.values.mut()](size_t i) { points[i] = i; });
             }
             ///
             total += prim->verts.size();
@@ -303,7 +321,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->verts.values;
+                    auto &outarr = outprim->verts.values.mut();
                     size_t n = std::min(arr.size(), prim->verts.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = arr[i];
@@ -351,7 +369,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->points.values;
+                    auto &outarr = outprim->points.values.mut();
                     size_t n = std::min(arr.size(), prim->points.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -399,7 +417,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->lines.values;
+                    auto &outarr = outprim->lines.values.mut();
                     size_t n = std::min(arr.size(), prim->lines.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -447,7 +465,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->tris.values;
+                    auto &outarr = outprim->tris.values.mut();
                     size_t n = std::min(arr.size(), prim->tris.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -495,7 +513,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->quads.values;
+                    auto &outarr = outprim->quads.values.mut();
                     size_t n = std::min(arr.size(), prim->quads.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -543,7 +561,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->loops.values;
+                    auto &outarr = outprim->loops.values.mut();
                     size_t n = std::min(arr.size(), prim->loops.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = vbase + arr[i];
@@ -585,7 +603,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
             auto core = [&](auto key, auto const &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->uvs.values;
+                    auto &outarr = outprim->uvs.values.mut();
                     size_t n = std::min(arr.size(), prim->uvs.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = arr[i];
@@ -632,7 +650,7 @@ ZENO_API std::shared_ptr<zeno::PrimitiveObject> primMerge(std::vector<zeno::Prim
                 }
 #else
                 if constexpr (std::is_same_v<decltype(key), std::true_type>) {
-                    auto &outarr = outprim->polys.values;
+                    auto &outarr = outprim->polys.values.mut();
                     size_t n = std::min(arr.size(), prim->polys.size());
                     for (size_t i = 0; i < n; i++) {
                         outarr[base + i] = {arr[i][0] + (int)lbase, arr[i][1]};
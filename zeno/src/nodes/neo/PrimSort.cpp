@@ -31,17 +31,19 @@ struct PrimSort : INode {
         std::vector<size_t> indices(prim->verts.size());
         std::iota(indices.begin(), indices.end(), 0);
         
+        auto sortBy = [&] (auto const &tag) {
+            // ties keep their vertex order, so the result is reproducible
+            auto key = [&tag] (size_t i) { return tag[i]; };
+            if (reverse)
+                zeno::parallel_sort_by_key(indices.begin(), indices.end(), key, std::greater<>{});
+            else
+                zeno::parallel_sort_by_key(indices.begin(), indices.end(), key);
+        };
         if (prim->attr_is<float>(attr)){
-            auto &tag = prim->verts.attr<float>(attr);
-            zeno::parallel_stable_sort(indices.begin(), indices.end(), [&tag, reverse] (size_t a, size_t b) {// or std::stable_sort
-                return reverse ? tag[a] > tag[b] : tag[a] < tag[b];
-            });
+            sortBy(prim->verts.attr<float>(attr));
         }
         else if (prim->attr_is<int>(attr)){
-            auto &tag = prim->verts.attr<int>(attr);
-            zeno::parallel_stable_sort(indices.begin(), indices.end(), [&tag, reverse] (size_t a, size_t b) {
-                return reverse ? tag[a] > tag[b] : tag[a] < tag[b];
-            });
+            sortBy(prim->verts.attr<int>(attr));
         }
         else{
             throw std::runtime_error("Attribute type not supported");
@@ -57,14 +59,14 @@ struct PrimSort : INode {
 
         // inverse mapping
         std::vector<size_t> reverse_indices(indices.size());
-        for (size_t i = 0; i < indices.size(); ++i) {
+        parallel_for(indices.size(), [&] (size_t i) {
             reverse_indices[indices[i]] = i;
-        }
-        for (auto& tri : tris) {
-            for (auto& idx : tri) {
+        });
+        parallel_for(tris.size(), [&] (size_t i) {
+            for (auto& idx : tris[i]) {
                 idx = reverse_indices[idx];
             }
-        }
+        });
         set_output("prim", std::move(prim));
     }
   }
@@ -7,6 +7,7 @@
 #include <zeno/para/parallel_for.h>
 #include <zeno/types/UserData.h>
 #include "zeno/utils/log.h"
+#include <utility>
 
 namespace zeno {
 
@@ -223,7 +224,8 @@ ZENO_API std::vector<std::shared_ptr<PrimitiveObject>> primUnmergeFaces(Primitiv
             }
             new_prim->tris.foreach_attr<AttrAcceptAll>([&](auto const &key, auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
-                auto &attr = prim->tris.attr<T>(key);
+                // only read, and shared with new_prim, mutable access would copy it
+                auto const &attr = std::as_const(prim->tris).attr<T>(key);
                 for (auto i = 0; i < arr.size(); i++) {
                     arr[i] = attr[val[i]];
                 }
@@ -247,7 +249,8 @@ ZENO_API std::vector<std::shared_ptr<PrimitiveObject>> primUnmergeFaces(Primitiv
             }
             new_prim->polys.foreach_attr<AttrAcceptAll>([&](auto const &key, auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
-                auto &attr = prim->polys.attr<T>(key);
+                // only read, and shared with new_prim, mutable access would copy it
+                auto const &attr = std::as_const(prim->polys).attr<T>(key);
                 for (auto i = 0; i < arr.size(); i++) {
                     arr[i] = attr[val[i]];
                 }
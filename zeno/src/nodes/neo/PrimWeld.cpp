@@ -62,7 +62,7 @@ struct PrimWeld : INode {
         revamp.resize(nrevamp);
         //primRevampVerts(prim.get(), revamp, &unrevamp);
 
-        revamp_vector(prim->verts.values, revamp);
+        revamp_vector(prim->verts.values.mut(), revamp);
         if (isAverage) {
             prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
@@ -119,6 +119,14 @@ ZENDEFNODE(SetRandomSeed, {
 struct NumericCounter : INode {
     int counter = 0;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        counter = 0;
+    }
+
     virtual void apply() override {
         auto count = std::make_shared<NumericObject>();
         count->value = counter++;
@@ -10,6 +10,14 @@ namespace zeno {
 struct CachePrimitive : zeno::INode {
     int m_framecounter = 0;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        m_framecounter = 0;
+    }
+
     virtual void preApply() override {
         /*if (has_option("MUTE")) {
             requireInput("inPrim");
@@ -44,6 +52,10 @@ struct CachePrimitive : zeno::INode {
         }
     }
 
+    virtual bool hasLazyInputs() const override {
+        return true;
+    }
+
     virtual void apply() override {
     }
 };
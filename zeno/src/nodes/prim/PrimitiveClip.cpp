@@ -42,7 +42,7 @@ namespace zeno {
             {
                 if (key != "pos") {
                     src->attr_visit(key, [&] (auto &&src) {
-                    dst->attr_visit(key, [&] (auto &&dst) {
+                    dst->attr_visit(key, [&] (auto &dst) {
                 //std::visit([i, j, c](auto &&dst, auto &&src) {
                     using DstT = std::remove_cv_t<std::remove_reference_t<decltype(dst)>>;
                     using SrcT = std::remove_cv_t<std::remove_reference_t<decltype(src)>>;
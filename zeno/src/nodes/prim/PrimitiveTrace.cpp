@@ -12,6 +12,14 @@ namespace zeno {
 struct PrimitiveTraceTrail : zeno::INode {
     std::shared_ptr<PrimitiveObject> trailPrim = std::make_shared<PrimitiveObject>();
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        trailPrim = std::make_shared<PrimitiveObject>();
+    }
+
     virtual void apply() override {
         auto parsPrim = get_input<PrimitiveObject>("parsPrim");
 
@@ -53,6 +61,15 @@ struct PrimitiveCalcVelocity : zeno::INode {
     std::vector<vec3f> last_pos;
     bool no_last_pos = true;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        last_pos.clear();
+        no_last_pos = true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
         auto dt = has_input("dt") ? get_input<NumericObject>("dt")->get<float>() : 0.04f;
@@ -89,6 +106,15 @@ struct PrimitiveInterpSubframe : zeno::INode {
     std::vector<vec3f> base_pos;
     std::vector<vec3f> curr_pos;
 
+    virtual bool isFrameIndependent() const override {
+        return false;
+    }
+
+    virtual void resetFrameState() override {
+        base_pos.clear();
+        curr_pos.clear();
+    }
+
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
         auto portion = get_input<NumericObject>("portion")->get<float>();
@@ -27,17 +27,19 @@ ZENO_API void primTriangulateQuads(PrimitiveObject *prim) {
     }
 
 
+    auto &tris_matid = prim->tris.attr<int>("matid");
+    auto const &quads_matid = std::as_const(prim->quads).attr<int>("matid");
     for (size_t i = 0; i < prim->quads.size(); i++) {
         auto quad = prim->quads[i];
         prim->tris[base+i*2+0] = vec3f(quad[0], quad[1], quad[2]);
         prim->tris[base+i*2+1] = vec3f(quad[0], quad[2], quad[3]);
         if(hasmat) {
-            prim->tris.attr<int>("matid")[base + i * 2 + 0] = prim->quads.attr<int>("matid")[i];
-            prim->tris.attr<int>("matid")[base + i * 2 + 1] = prim->quads.attr<int>("matid")[i];
+            tris_matid[base + i * 2 + 0] = quads_matid[i];
+            tris_matid[base + i * 2 + 1] = quads_matid[i];
         } else
         {
-            prim->tris.attr<int>("matid")[base + i * 2 + 0] = -1;
-            prim->tris.attr<int>("matid")[base + i * 2 + 1] = -1;
+            tris_matid[base + i * 2 + 0] = -1;
+            tris_matid[base + i * 2 + 1] = -1;
         }
     }
     prim->quads.clear();
@@ -69,6 +69,10 @@ namespace zeno {
 namespace {
 
 struct CreateCube : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto size = get_input2<float>("size");
@@ -477,6 +481,10 @@ ZENDEFNODE(CreateCube, {
 });
 
 struct CreateDisk : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto position = get_input2<zeno::vec3f>("position");
@@ -541,6 +549,10 @@ ZENDEFNODE(CreateDisk, {
 });
 
 struct CreatePlane : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto position = get_input2<zeno::vec3f>("position");
@@ -705,6 +717,10 @@ ZENDEFNODE(CreatePlane, {
 });
 
 struct CreateTube : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto position = get_input2<zeno::vec3f>("position");
@@ -948,6 +964,10 @@ ZENDEFNODE(CreateTube, {
 });
 
 struct CreateTorus : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto majorSegment = get_input2<int>("MajorSegment");
         auto minorSegment = get_input2<int>("MinorSegment");
@@ -1069,6 +1089,10 @@ ZENDEFNODE(CreateTorus, {
 });
 
 struct CreateSphere : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto position = get_input2<zeno::vec3f>("position");
@@ -1316,6 +1340,10 @@ ZENDEFNODE(CreateSphere, {
 });
 
 struct CreateCone : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
         auto position = get_input2<zeno::vec3f>("position");
@@ -1357,6 +1385,10 @@ ZENDEFNODE(CreateCone, {
 });
 
 struct CreateCylinder : zeno::INode {
+    virtual bool isPure() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = std::make_shared<zeno::PrimitiveObject>();
 
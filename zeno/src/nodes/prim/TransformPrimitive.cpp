@@ -67,6 +67,10 @@ ZENDEFNODE(MakeLocalSys, {
 });
 
 struct TransformPrimitive : zeno::INode {//zhxx happy node
+    virtual bool isPure() const override {
+        return true;
+    }
+
     static glm::vec3 mapplypos(glm::mat4 const &matrix, glm::vec3 const &vector) {
         auto vector4 = matrix * glm::vec4(vector, 1.0f);
         return glm::vec3(vector4) / vector4.w;
@@ -0,0 +1,48 @@
+#include <zeno/types/AttrName.h>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <deque>
+
+namespace zeno {
+
+namespace {
+
+struct AttrNameTable {
+    std::shared_mutex mtx;
+    std::deque<std::string> names;  // deque, as the AttrName::str point into it
+    std::unordered_map<std::string_view, AttrName> lut;
+
+    AttrNameTable() {
+        intern("pos");
+    }
+
+    AttrName intern(std::string_view name) {
+        {
+            std::shared_lock lck(mtx);
+            auto it = lut.find(name);
+            if (it != lut.end())
+                return it->second;
+        }
+        std::unique_lock lck(mtx);
+        auto it = lut.find(name);
+        if (it != lut.end())
+            return it->second;
+        auto const &str = names.emplace_back(name);
+        AttrName ret;
+        ret.id = static_cast<std::uint32_t>(names.size());
+        ret.hash = AttrName::hash_of(str);
+        ret.str = &str;
+        lut.emplace(str, ret);
+        return ret;
+    }
+};
+
+}
+
+ZENO_API AttrName internAttrName(std::string_view name) {
+    static AttrNameTable table;
+    return table.intern(name);
+}
+
+}
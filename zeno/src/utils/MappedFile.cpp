@@ -0,0 +1,74 @@
+#include <zeno/utils/MappedFile.h>
+#include <zeno/utils/log.h>
+#include <system_error>
+#include <fstream>
+#ifdef _WIN32
+#include <zeno/utils/fuck_win.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace zeno {
+
+ZENO_API MappedFile::MappedFile(std::filesystem::path const &path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec || !size)
+        return;
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping) {
+            if (auto p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) {
+                m_data = static_cast<char const *>(p);
+                m_size = size;
+                m_handle = mapping;
+                return;
+            }
+            CloseHandle(mapping);
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd != -1) {
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // the mapping keeps the file alive
+        if (p != MAP_FAILED) {
+            // we are going to decode it front to back right away
+            ::madvise(p, size, MADV_SEQUENTIAL);
+            ::madvise(p, size, MADV_WILLNEED);
+            m_data = static_cast<char const *>(p);
+            m_size = size;
+            return;
+        }
+    }
+#endif
+    log_debug("failed to map {}, reading it instead", path.string());
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin)
+        return;
+    m_fallback.resize(size);
+    if (!fin.read(m_fallback.data(), size))
+        return;
+    m_data = m_fallback.data();
+    m_size = size;
+}
+
+ZENO_API MappedFile::~MappedFile() {
+    if (!m_data || !m_fallback.empty())
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_handle);
+#else
+    ::munmap(const_cast<char *>(m_data), m_size);
+#endif
+}
+
+}
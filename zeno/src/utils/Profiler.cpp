@@ -0,0 +1,189 @@
+#include <zeno/utils/Profiler.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <map>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace zeno {
+
+namespace {
+
+struct Span {
+    const char *category;
+    char name[48];
+    std::int64_t beginNs;
+    std::int64_t endNs;
+};
+
+// written by its thread only, the mutex is for the readers and thus hardly ever contended
+struct ThreadSpans {
+    std::mutex mtx;
+    std::vector<Span> spans;
+    std::size_t next = 0;  // oldest span once the ring is full
+    int tid = 0;
+};
+
+struct Registry {
+    std::mutex mtx;
+    std::vector<std::shared_ptr<ThreadSpans>> threads;
+    std::size_t capacity = std::max(1, envconfig::getInt("PROFILE_SPANS", 1 << 16));
+
+    static Registry &get() {
+        // never destroyed, threads and TraceAtExit may still record or export during exit
+        static Registry *registry = new Registry;
+        return *registry;
+    }
+
+    ThreadSpans &local() {
+        thread_local std::shared_ptr<ThreadSpans> spans = [this] {
+            auto spans = std::make_shared<ThreadSpans>();
+            std::lock_guard lck(mtx);
+            spans->tid = (int)threads.size();
+            threads.push_back(spans);
+            return spans;
+        }();
+        return *spans;
+    }
+
+    template <class F>
+    void forEachSpan(F const &func) {
+        std::lock_guard lck(mtx);
+        for (auto const &thread: threads) {
+            std::lock_guard lck(thread->mtx);
+            for (auto const &span: thread->spans)
+                func(thread->tid, span);
+        }
+    }
+};
+
+// written at exit when ZENO_PROFILE_OUTPUT is set
+static struct TraceAtExit {
+    ~TraceAtExit() {
+        if (auto path = envconfig::getCStr("PROFILE_OUTPUT"))
+            Profiler::saveChromeTrace(path);
+    }
+} traceAtExit;
+
+}
+
+ZENO_API std::atomic<bool> Profiler::s_enabled{envconfig::getInt("PROFILE") != 0};
+
+ZENO_API void Profiler::setEnabled(bool on) {
+    s_enabled.store(on, std::memory_order_relaxed);
+}
+
+ZENO_API std::int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ZENO_API void Profiler::record(const char *category, std::string_view name, std::int64_t beginNs, std::int64_t endNs) {
+    auto &registry = Registry::get();
+    auto &local = registry.local();
+    Span span;
+    span.category = category;
+    auto len = std::min(name.size(), sizeof(span.name) - 1);
+    std::copy_n(name.data(), len, span.name);
+    span.name[len] = 0;
+    span.beginNs = beginNs;
+    span.endNs = endNs;
+    std::lock_guard lck(local.mtx);
+    if (local.spans.size() < registry.capacity) {
+        local.spans.push_back(span);
+    } else {
+        local.spans[local.next] = span;
+        local.next = (local.next + 1) % local.spans.size();
+    }
+}
+
+ZENO_API void Profiler::clear() {
+    auto &registry = Registry::get();
+    std::lock_guard lck(registry.mtx);
+    for (auto const &thread: registry.threads) {
+        std::lock_guard lck(thread->mtx);
+        thread->spans.clear();
+        thread->next = 0;
+    }
+}
+
+ZENO_API std::string Profiler::exportChromeTrace() {
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    int pid = getpid();
+#endif
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer writer(buf);
+    writer.StartObject();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.Key("traceEvents");
+    writer.StartArray();
+    Registry::get().forEachSpan([&] (int tid, Span const &span) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(span.name);
+        writer.Key("cat");
+        writer.String(span.category);
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Double(span.beginNs * 1e-3);
+        writer.Key("dur");
+        writer.Double((span.endNs - span.beginNs) * 1e-3);
+        writer.Key("pid");
+        writer.Int(pid);
+        writer.Key("tid");
+        writer.Int(tid);
+        writer.EndObject();
+    });
+    writer.EndArray();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetSize()};
+}
+
+ZENO_API bool Profiler::saveChromeTrace(std::string const &path) {
+    std::ofstream fout(path, std::ios::binary);
+    if (!fout) {
+        log_error("cannot open {} to write the profile", path);
+        return false;
+    }
+    auto json = exportChromeTrace();
+    fout.write(json.data(), json.size());
+    log_info("profile written to {}", path);
+    return !!fout;
+}
+
+ZENO_API std::vector<Profiler::Stat> Profiler::summarize(std::int64_t sinceNs, const char *category) {
+    std::map<std::pair<std::string, std::string>, Stat> stats;
+    std::vector<Stat> res;
+    Registry::get().forEachSpan([&] (int tid, Span const &span) {
+        if (span.beginNs < sinceNs || (category && std::string_view(category) != span.category))
+            return;
+        auto &stat = stats[{span.category, span.name}];
+        stat.totalNs += span.endNs - span.beginNs;
+        stat.count++;
+    });
+    for (auto &[key, stat]: stats) {
+        stat.category = key.first;
+        stat.name = key.second;
+        res.push_back(std::move(stat));
+    }
+    std::sort(res.begin(), res.end(), [] (Stat const &lhs, Stat const &rhs) {
+        return lhs.totalNs > rhs.totalNs;
+    });
+    return res;
+}
+
+}
@@ -0,0 +1,80 @@
+#include <zeno/utils/SharedSegment.h>
+#include <zeno/utils/log.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+#endif
+
+namespace zeno {
+
+ZENO_API SharedSegment::SharedSegment(std::string const &name, std::size_t size, bool create) {
+#ifndef _WIN32
+    if (!size)
+        return;
+    int fd = create ? ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                    : ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+        log_warn("failed to open shared memory {}: {}", name, std::strerror(errno));
+        return;
+    }
+    if (!create) {
+        ::shm_unlink(name.c_str());  // the mapping keeps it alive
+        struct stat st;
+        if (::fstat(fd, &st) == -1 || (std::size_t)st.st_size < size) {
+            log_warn("shared memory {} is smaller than expected", name);
+            ::close(fd);
+            return;
+        }
+    } else if (::ftruncate(fd, size) == -1) {
+        log_warn("failed to allocate {} bytes of shared memory: {}", size, std::strerror(errno));
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return;
+    }
+    void *p = ::mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        log_warn("failed to map shared memory {}: {}", name, std::strerror(errno));
+        if (create)
+            ::shm_unlink(name.c_str());
+        return;
+    }
+    m_data = static_cast<char *>(p);
+    m_size = size;
+#endif
+}
+
+ZENO_API SharedSegment::~SharedSegment() {
+#ifndef _WIN32
+    if (m_data)
+        ::munmap(m_data, m_size);
+#endif
+}
+
+ZENO_API bool SharedSegment::supported() {
+#ifndef _WIN32
+    return true;
+#else
+    return false;
+#endif
+}
+
+ZENO_API void SharedSegment::removeAll(std::string const &prefix) {
+#ifdef __linux__
+    // that's where glibc keeps them, named without the leading slash
+    std::error_code ec;
+    auto stem = prefix.substr(prefix.find_first_not_of('/'));
+    for (auto const &entry: std::filesystem::directory_iterator("/dev/shm", ec)) {
+        auto name = entry.path().filename().string();
+        if (name.compare(0, stem.size(), stem) == 0)
+            ::shm_unlink(("/" + name).c_str());
+    }
+#endif
+}
+
+}
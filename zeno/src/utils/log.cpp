@@ -6,47 +6,262 @@
 #include <zeno/utils/envconfig.h>
 //#include <zeno/utils/ansiclr.h>
 #include <zeno/utils/arrayindex.h>
+#include <condition_variable>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
 
 namespace zeno {
 
-static log_level_t curr_level = log_level_t::info;
+static std::atomic<log_level_t> curr_level{log_level_t::info};
 static std::ostream *os = &std::clog;
+static std::mutex os_mtx;
 
-ZENO_API void set_log_level(log_level_t level) {
-    curr_level = level;
-}
+namespace {
 
-ZENO_API bool __check_log_level(log_level_t level) {
-    return level >= curr_level;
-}
+thread_local std::string_view tls_node;
+thread_local int tls_frame = -1;
 
-ZENO_API void set_log_stream(std::ostream &osin) {
-    os = &osin;
-}
+struct LogRecord {
+    log_level_t level = log_level_t::info;
+    source_location loc;
+    std::chrono::steady_clock::time_point time;
+    std::string node;
+    int frame = -1;
+    std::string msg;
+};
 
-ZENO_API void __impl_log_print(log_level_t level, source_location const &loc, std::string_view msg) {
-    auto now = std::chrono::steady_clock::now();
-    auto sod = std::chrono::floor<std::chrono::duration<int, std::ratio<24 * 60 * 60, 1>>>(now);
-    auto mss = std::chrono::floor<std::chrono::milliseconds>(now - sod).count();
-    int linlev = (int)level - (int)log_level_t::trace;
+std::string formatLogLine(LogRecord const &rec) {
+    auto sod = std::chrono::floor<std::chrono::duration<int, std::ratio<24 * 60 * 60, 1>>>(rec.time);
+    auto mss = std::chrono::floor<std::chrono::milliseconds>(rec.time - sod).count();
+    int linlev = (int)rec.level - (int)log_level_t::trace;
     //*os << ansiclr::fg[make_array(ansiclr::white, ansiclr::cyan, ansiclr::green,
                                   //ansiclr::cyan | ansiclr::light, ansiclr::yellow | ansiclr::light,
                                   //ansiclr::red | ansiclr::light)[linlev]];
-    auto content = format("[{} {02d}:{02d}:{02d}.{03d}] ({}:{}) {}\n",
+    auto content = format("[{} {02d}:{02d}:{02d}.{03d}] ({}:{}) ",
                   "TDICWE"[linlev],
                   mss / 1000 / 60 / 60 % 24, mss / 1000 / 60 % 60,
                   mss / 1000 % 60, mss % 1000,
-                  loc.file_name(), loc.line(),
-                  msg);
+                  rec.loc.file_name(), rec.loc.line());
+    if (!rec.node.empty())
+        content += format("[node={} frame={}] ", rec.node, rec.frame);
+    content += rec.msg;
+    content += '\n';
     //*os << ansiclr::reset;
+    return content;
+}
+
+// caller holds os_mtx
+void writeLogLine(LogRecord const &rec) {
+    auto content = formatLogLine(rec);
     *os << content;
-    os->flush();
-    if (level == log_level_t::error)
+    if (rec.level == log_level_t::error)
         std::cerr << content;
 }
 
+// records of one thread, pushed by it and popped by whoever holds AsyncLogSink::drain_mtx
+struct LogQueue {
+    static constexpr size_t kCapacity = 512;
+
+    LogRecord ring[kCapacity];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<bool> orphaned{false};  // the thread has exited
+
+    bool push(LogRecord &rec) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == kCapacity)
+            return false;
+        ring[t % kCapacity] = std::move(rec);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    void popAll(std::vector<LogRecord> &out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        for (; h != t; h++)
+            out.push_back(std::move(ring[h % kCapacity]));
+        head.store(t, std::memory_order_release);
+    }
+};
+
+struct AsyncLogSink {
+    std::mutex mtx;  // guards queues, stopping and the wakeup
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<LogQueue>> queues;
+    std::thread flusher;
+    bool stopping = false;
+    bool wakeup = false;
+    std::atomic<bool> stopped{false};  // producers drain themselves from now on
+
+    std::mutex drain_mtx;  // one consumer at a time for the queues
+    std::vector<LogRecord> batch;
+
+    AsyncLogSink() {
+        flusher = std::thread([this] {
+            std::unique_lock lck(mtx);
+            while (!stopping) {
+                cv.wait_for(lck, std::chrono::milliseconds(20), [&] { return stopping || wakeup; });
+                wakeup = false;
+                lck.unlock();
+                drain();
+                lck.lock();
+            }
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard lck(mtx);
+            stopping = true;
+        }
+        cv.notify_one();
+#ifdef _WIN32
+        flusher.detach();  // may be called at DLL unload, where joining hangs
+#else
+        flusher.join();
+#endif
+        stopped = true;
+        drain();
+    }
+
+    std::shared_ptr<LogQueue> addQueue() {
+        auto q = std::make_shared<LogQueue>();
+        std::lock_guard lck(mtx);
+        queues.push_back(q);
+        return q;
+    }
+
+    void drain() {
+        std::lock_guard dlck(drain_mtx);
+        std::vector<std::shared_ptr<LogQueue>> qs;
+        {
+            std::lock_guard lck(mtx);
+            qs = queues;
+        }
+        for (auto const &q: qs)
+            q->popAll(batch);
+        {
+            std::lock_guard lck(mtx);
+            queues.erase(std::remove_if(queues.begin(), queues.end(), [] (auto const &q) {
+                return q->orphaned && q->head == q->tail;
+            }), queues.end());
+        }
+        if (batch.empty())
+            return;
+        // each queue is in order already, this interleaves the threads
+        std::stable_sort(batch.begin(), batch.end(), [] (auto const &a, auto const &b) {
+            return a.time < b.time;
+        });
+        {
+            std::lock_guard lck(os_mtx);
+            for (auto const &rec: batch)
+                writeLogLine(rec);
+            os->flush();
+        }
+        batch.clear();
+    }
+};
+
+// leaked, threads that logged through it still point to it
+std::atomic<AsyncLogSink *> g_async_sink{nullptr};
+std::mutex g_async_mtx;
+
+struct ThreadLogQueue {
+    AsyncLogSink *sink = nullptr;
+    std::shared_ptr<LogQueue> q;
+
+    ~ThreadLogQueue() {
+        if (q)
+            q->orphaned = true;
+    }
+};
+
+thread_local ThreadLogQueue tls_queue;
+
+void pushAsync(AsyncLogSink *sink, LogRecord &rec) {
+    if (tls_queue.sink != sink) {
+        if (tls_queue.q)
+            tls_queue.q->orphaned = true;
+        tls_queue.sink = sink;
+        tls_queue.q = sink->addQueue();
+    }
+    bool urgent = rec.level == log_level_t::error;
+    while (!tls_queue.q->push(rec))
+        sink->drain();  // full, the flusher can't keep up
+    if (urgent || sink->stopped)
+        sink->drain();
+}
+
+}
+
+ZENO_API void set_log_level(log_level_t level) {
+    curr_level.store(level, std::memory_order_relaxed);
+}
+
+ZENO_API bool __check_log_level(log_level_t level) {
+    return level >= curr_level.load(std::memory_order_relaxed);
+}
+
+ZENO_API void set_log_stream(std::ostream &osin) {
+    log_flush();
+    std::lock_guard lck(os_mtx);
+    os = &osin;
+}
+
+ZENO_API std::unique_lock<std::mutex> lock_log_stream() {
+    return std::unique_lock(os_mtx);
+}
+
+ZENO_API void set_log_async(bool async) {
+    std::lock_guard lck(g_async_mtx);
+    auto sink = g_async_sink.load();
+    if (async && !sink) {
+        g_async_sink = new AsyncLogSink;
+    } else if (!async && sink) {
+        g_async_sink = nullptr;
+        sink->stop();
+    }
+}
+
+ZENO_API void log_flush() {
+    if (auto sink = g_async_sink.load())
+        sink->drain();
+}
+
+ZENO_API log_scope::log_scope(std::string_view node, int frame)
+    : m_oldNode(tls_node), m_oldFrame(tls_frame) {
+    tls_node = node;
+    tls_frame = frame;
+}
+
+ZENO_API log_scope::~log_scope() {
+    tls_node = m_oldNode;
+    tls_frame = m_oldFrame;
+}
+
+ZENO_API void __impl_log_print(log_level_t level, source_location const &loc, std::string_view msg) {
+    LogRecord rec;
+    rec.level = level;
+    rec.loc = loc;
+    rec.time = std::chrono::steady_clock::now();
+    rec.node = tls_node;
+    rec.frame = tls_frame;
+    rec.msg = msg;
+    if (auto sink = g_async_sink.load(std::memory_order_acquire)) {
+        pushAsync(sink, rec);
+        return;
+    }
+    std::lock_guard lck(os_mtx);
+    writeLogLine(rec);
+    os->flush();
+}
+
 namespace {
 struct LogInitializer {
     LogInitializer() {
@@ -62,6 +277,13 @@ _ZENO_PER_LOG_LEVEL(error)
 #undef _ZENO_PER_LOG_LEVEL
             }
         }
+        if (zeno::envconfig::getInt("LOGASYNC"))
+            set_log_async(true);
+    }
+
+    // writes out what is still queued, later messages are written directly
+    ~LogInitializer() {
+        set_log_async(false);
     }
 };
 static LogInitializer g_log_init;
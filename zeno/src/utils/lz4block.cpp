@@ -0,0 +1,143 @@
+#include <zeno/utils/lz4block.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace zeno {
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5;  // the block always ends with literals
+constexpr std::size_t kMatchLimit = 12;   // no match may start in the last 12 bytes
+constexpr std::size_t kMaxOffset = 65535;
+constexpr int kHashLog = 16;
+
+uint32_t read32(char const *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash32(uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashLog);
+}
+
+char *writeLength(char *op, std::size_t len) {
+    for (; len >= 255; len -= 255)
+        *op++ = (char)255;
+    *op++ = (char)len;
+    return op;
+}
+
+}
+
+ZENO_API std::vector<char> lz4_compress_block(char const *src, std::size_t size) {
+    std::vector<char> out(size + size / 255 + 16);
+    char *op = out.data();
+    char *oend = op + size;  // give up once we are not smaller than the input
+    std::size_t anchor = 0;
+
+    auto emit = [&] (std::size_t litEnd, std::size_t offset, std::size_t matchLen) {
+        std::size_t litLen = litEnd - anchor;
+        std::size_t maxSize = 1 + litLen / 255 + 1 + litLen + 2 + matchLen / 255 + 1;
+        if (op + maxSize > oend)
+            return false;
+        char *token = op++;
+        *token = (char)((litLen >= 15 ? 15 : litLen) << 4);
+        if (litLen >= 15)
+            op = writeLength(op, litLen - 15);
+        std::memcpy(op, src + anchor, litLen);
+        op += litLen;
+        if (!matchLen)
+            return true;
+        *op++ = (char)(offset & 0xff);
+        *op++ = (char)(offset >> 8);
+        std::size_t ml = matchLen - kMinMatch;
+        *token |= (char)(ml >= 15 ? 15 : ml);
+        if (ml >= 15)
+            op = writeLength(op, ml - 15);
+        return true;
+    };
+
+    if (size > kMatchLimit) {
+        auto table = std::make_unique<uint32_t[]>(1 << kHashLog);  // positions + 1, 0 = empty
+        std::size_t ip = 0, limit = size - kMatchLimit;
+        while (ip < limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t &slot = table[hash32(seq)];
+            std::size_t ref = slot;
+            slot = (uint32_t)(ip + 1);
+            if (!ref || ip + 1 - ref > kMaxOffset || read32(src + ref - 1) != seq) {
+                ip++;
+                continue;
+            }
+            ref--;
+            std::size_t len = kMinMatch;
+            while (ip + len < size - kLastLiterals && src[ref + len] == src[ip + len])
+                len++;
+            if (!emit(ip, ip - ref, len))
+                return {};
+            ip += len;
+            anchor = ip;
+        }
+    }
+    if (!emit(size, 0, 0))
+        return {};
+    out.resize(op - out.data());
+    return out;
+}
+
+ZENO_API bool lz4_decompress_block(char const *src, std::size_t size, char *dst, std::size_t dstSize) {
+    auto ip = reinterpret_cast<unsigned char const *>(src), iend = ip + size;
+    char *op = dst, *oend = dst + dstSize;
+
+    auto readLength = [&] (std::size_t &len) {
+        unsigned char b;
+        do {
+            if (ip >= iend)
+                return false;
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip < iend) {
+        unsigned token = *ip++;
+        std::size_t litLen = token >> 4;
+        if (litLen == 15 && !readLength(litLen))
+            return false;
+        if (litLen > (std::size_t)(iend - ip) || litLen > (std::size_t)(oend - op))
+            return false;
+        std::memcpy(op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+        if (ip == iend)
+            break;  // the last sequence has no match part
+
+        if (iend - ip < 2)
+            return false;
+        std::size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (!offset || offset > (std::size_t)(op - dst))
+            return false;
+        std::size_t matchLen = token & 15;
+        if (matchLen == 15 && !readLength(matchLen))
+            return false;
+        matchLen += kMinMatch;
+        if (matchLen > (std::size_t)(oend - op))
+            return false;
+        char const *match = op - offset;
+        if (offset >= matchLen) {
+            std::memcpy(op, match, matchLen);
+            op += matchLen;
+        } else {
+            for (std::size_t i = 0; i < matchLen; i++)  // overlapping, repeats the pattern
+                *op++ = match[i];
+        }
+    }
+    return op == oend;
+}
+
+}
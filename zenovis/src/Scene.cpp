@@ -104,8 +104,12 @@ bool Scene::loadFrameObjects(int frameid) {
     const auto& cbLoadObjs = [this](std::map<std::string, std::shared_ptr<zeno::IObject>> const& objs) -> bool {
         return this->objectsMan->load_objects(objs);
     };
+    // objects we already have (e.g. static ones) are kept by key, no need to decode them again
+    const auto& needObject = [this](std::string const &key) -> bool {
+        return this->objectsMan->objects.find(key) == this->objectsMan->objects.end();
+    };
     bool isFrameValid = false;
-    bool inserted = zeno::getSession().globalComm->load_objects(frameid, cbLoadObjs, isFrameValid);
+    bool inserted = zeno::getSession().globalComm->load_objects(frameid, needObject, cbLoadObjs, isFrameValid);
     if (!isFrameValid)
         return false;
 
@@ -24,6 +24,31 @@ namespace {
 
 using namespace opengl;
 
+// the shaders read these as vec3f, convert them when stored in a compact type: gray for
+// scalars, rgb of vec4C colors
+void widen_to_vec3f(zeno::AttrVector<zeno::vec3f> &verts, std::string_view name) {
+    if (!verts.has_attr(name) || verts.attr_is<zeno::vec3f>(name))
+        return;
+    std::vector<zeno::vec3f> wide;
+    bool widened = false;
+    std::visit([&] (auto const &arr) {
+        using T = std::decay_t<decltype(arr[0])>;
+        using Compact = std::variant<zeno::half, uint8_t, zeno::vec4C, double, zeno::vec3d>;
+        if constexpr (zeno::variant_contains<T, Compact>::value) {
+            wide.resize(arr.size());
+            for (size_t i = 0; i < arr.size(); i++) {
+                for (size_t c = 0; c < 3; c++)
+                    wide[i][c] = zeno::attr_get_float(arr[i], zeno::is_vec_n<T> == 1 ? 0 : c);
+            }
+            widened = true;
+        }
+    }, std::as_const(verts).attr(name));
+    if (!widened)
+        return;
+    verts.erase_attr(name);
+    verts.add_attr<zeno::vec3f>(name) = std::move(wide);
+}
+
 struct ZhxxDrawObject {
     std::vector<std::unique_ptr<Buffer>> vbos;
     std::unique_ptr<Buffer> ebo;
@@ -431,6 +456,8 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
             }
         }
 
+        for (auto name: {"clr", "nrm", "uv", "tang"})
+            widen_to_vec3f(prim->verts, name);
         if (!prim->attr_is<zeno::vec3f>("pos")) {
             auto &pos = prim->add_attr<zeno::vec3f>("pos");
             for (size_t i = 0; i < pos.size(); i++) {